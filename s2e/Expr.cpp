@@ -34,6 +34,11 @@ namespace {
 /***/
 
 unsigned Expr::count = 0;
+// <M>
+Expr::ExprCache Expr::s_cache;
+uint64_t Expr::cacheHits = 0;
+uint64_t Expr::cacheMisses = 0;
+// <M>
 
 ref<Expr> Expr::createTempRead(const Array *array, Expr::Width w) {
   UpdateList ul(array, 0);
@@ -189,7 +194,7 @@ unsigned ReadExpr::computeHash() {
 }
 
 unsigned NotExpr::computeHash() {
-  unsigned hashValue = expr->hash() * Expr::MAGIC_HASH_CONSTANT * Expr::Not;
+  hashValue = expr->hash() * Expr::MAGIC_HASH_CONSTANT * Expr::Not;
   return hashValue;
 }
 
@@ -988,9 +993,46 @@ ref<Expr>  _e_op ::create(const ref<Expr> &l, const ref<Expr> &r) {    \
 }
   
 
+// <M>
+/// Tries to write l and r as c1 + x and c2 + x, x being the same
+/// non-constant term, as the timestamps made of a symbolic delay and
+/// constant offsets. On success, diff is c1 - c2.
+static bool getOffsetDifference(const ref<Expr> &l, const ref<Expr> &r,
+                                ref<ConstantExpr> &diff) {
+  if (l->getWidth() == Expr::Bool || isa<ConstantExpr>(l) || isa<ConstantExpr>(r))
+    return false;
+
+  ref<Expr> lt = l, rt = r;
+  ref<ConstantExpr> lc = ConstantExpr::alloc(0, l->getWidth());
+  ref<ConstantExpr> rc = lc;
+  if (l->getKind() == Expr::Add && isa<ConstantExpr>(l->getKid(0))) {
+    lc = cast<ConstantExpr>(l->getKid(0));
+    lt = l->getKid(1);
+  }
+  if (r->getKind() == Expr::Add && isa<ConstantExpr>(r->getKid(0))) {
+    rc = cast<ConstantExpr>(r->getKid(0));
+    rt = r->getKid(1);
+  }
+  // Shared nodes make this a pointer comparison
+  if (lt != rt)
+    return false;
+
+  diff = lc->Sub(rc);
+  return true;
+}
+// <M>
+
 static ref<Expr> EqExpr_create(const ref<Expr> &l, const ref<Expr> &r) {
+  // <M>
+  ref<ConstantExpr> diff;
+  // <M>
   if (l == r) {
     return ConstantExpr::alloc(1, Expr::Bool);
+  // <M>
+  } else if (getOffsetDifference(l, r, diff)) {
+    // c1 + x == c2 + x => c1 == c2
+    return ConstantExpr::alloc(diff->isZero(), Expr::Bool);
+  // <M>
   } else {
     return EqExpr::alloc(l, r);
   }
@@ -1130,16 +1172,37 @@ ref<Expr> SgeExpr::create(const ref<Expr> &l, const ref<Expr> &r) {
 
 static ref<Expr> UltExpr_create(const ref<Expr> &l, const ref<Expr> &r) {
   Expr::Width t = l->getWidth();
+  // <M>
+  ref<ConstantExpr> diff;
+  // <M>
   if (t == Expr::Bool) { // !l && r
     return AndExpr::create(Expr::createIsZero(l), r);
+  // <M>
+  } else if (getOffsetDifference(l, r, diff)) {
+    // y < y + d holds iff y + d does not wrap around, y < -d, with
+    // y = c1 + x and d = c2 - c1
+    if (diff->isZero())
+      return ConstantExpr::alloc(0, Expr::Bool);
+    return UltExpr::create(l, diff);
+  // <M>
   } else {
     return UltExpr::alloc(l, r);
   }
 }
 
 static ref<Expr> UleExpr_create(const ref<Expr> &l, const ref<Expr> &r) {
+  // <M>
+  ref<ConstantExpr> diff;
+  // <M>
   if (l->getWidth() == Expr::Bool) { // !(l && !r)
     return OrExpr::create(Expr::createIsZero(l), r);
+  // <M>
+  } else if (getOffsetDifference(l, r, diff)) {
+    // y <= y + d holds iff d is 0 or y <= -d - 1
+    if (diff->isZero())
+      return ConstantExpr::alloc(1, Expr::Bool);
+    return UleExpr::create(l, diff->Sub(ConstantExpr::alloc(1, diff->getWidth())));
+  // <M>
   } else {
     return UleExpr::alloc(l, r);
   }
@@ -20,6 +20,7 @@
 
 #include <set>
 #include <vector>
+#include <tr1/unordered_set> // <M>
 #include <sstream>
 #include <iosfwd> // FIXME: Remove this!!!
 
@@ -84,6 +85,16 @@ Todo: Shouldn't bool \c Xor just be written as not equal?
 
 */
 
+// <M>
+template <typename T> struct hash_ptr_t {
+  unsigned operator()(const T *expr) const { return expr->hash(); }
+};
+
+template <typename T> struct equal_ptr_t {
+  bool operator()(const T *a, const T *b) const { return *a == *b; }
+};
+// <M>
+
 class Expr {
 public:
   static unsigned count;
@@ -168,12 +179,25 @@ public:
   };
 
   unsigned refCount;
+  // <M>
+  /// false once the expression is the shared node of the cache
+  bool temporary;
+
+  /// Every allocated expression, identical expressions sharing one node
+  typedef std::tr1::unordered_set<Expr *, hash_ptr_t<Expr>, equal_ptr_t<Expr> > ExprCache;
+  static ExprCache s_cache;
+  static uint64_t cacheHits;
+  static uint64_t cacheMisses;
+  // <M>
 
 protected:  
   unsigned hashValue;
   
 public:
-  Expr() : refCount(0) { Expr::count++; }
+  Expr() : refCount(0), temporary(true) { Expr::count++; }
+  // <M>
+  Expr(const Expr &b) : refCount(0), temporary(true), hashValue(b.hashValue) { Expr::count++; }
+  // <M>
   virtual ~Expr() { Expr::count--; } 
 
   virtual Kind getKind() const = 0;
@@ -243,6 +267,36 @@ public:
   static bool needsResultType() { return false; }
 
   static bool classof(const Expr *) { return true; }
+
+  // <M>
+  /// Returns the cached node equal to temp, or a copy of temp added to
+  /// the cache. Expressions are immutable, so the simulator rebuilding
+  /// the same expressions around symbolic timestamps gets the same nodes.
+  template <typename C> static ref<C> exprCachedAlloc(C &temp) {
+    temp.computeHash();
+
+    ExprCache::iterator it = s_cache.find(&temp);
+    C *ptr;
+    if (it != s_cache.end()) {
+      ptr = static_cast<C *>(*it);
+      cacheHits++;
+    } else {
+      ptr = new C(temp);
+      ptr->temporary = false;
+      s_cache.insert(ptr);
+      cacheMisses++;
+    }
+    return ref<C>(ptr);
+  }
+
+protected:
+  /// Removes a cached node, called by the destructors of the concrete
+  /// classes while the node can still be compared.
+  void exprCacheClean() {
+    if (!temporary)
+      s_cache.erase(this);
+  }
+  // <M>
 };
 
 struct Expr::CreateArg {
@@ -330,7 +384,7 @@ private:
   ConstantExpr(const llvm::APInt &v) : value(v) {}
 
 public:
-  ~ConstantExpr() {};
+  ~ConstantExpr() { exprCacheClean(); } // <M>
   
   Width getWidth() const { return value.getBitWidth(); }
   Kind getKind() const { return Constant; }
@@ -382,9 +436,8 @@ public:
   void toMemory(void *address);
 
   static ref<ConstantExpr> alloc(const llvm::APInt &v) {
-    ref<ConstantExpr> r(new ConstantExpr(v));
-    r->computeHash();
-    return r;
+    ConstantExpr temp(v); // <M>
+    return exprCachedAlloc(temp);
   }
   
   // <M>
@@ -528,11 +581,14 @@ public:
   static const unsigned numKids = 1;
   ref<Expr> src;
 
+  // <M>
+  virtual ~NotOptimizedExpr() { exprCacheClean(); }
+
   static ref<Expr> alloc(const ref<Expr> &src) {
-    ref<Expr> r(new NotOptimizedExpr(src));
-    r->computeHash();
-    return r;
+    NotOptimizedExpr temp(src);
+    return exprCachedAlloc(temp);
   }
+  // <M>
   
   static ref<Expr> create(ref<Expr> src);
   
@@ -674,11 +730,14 @@ public:
   ref<Expr> index;
 
 public:
+  // <M>
+  virtual ~ReadExpr() { exprCacheClean(); }
+
   static ref<Expr> alloc(const UpdateList &updates, const ref<Expr> &index) {
-    ref<Expr> r(new ReadExpr(updates, index));
-    r->computeHash();
-    return r;
+    ReadExpr temp(updates, index);
+    return exprCachedAlloc(temp);
   }
+  // <M>
   
   static ref<Expr> create(const UpdateList &updates, ref<Expr> i);
   
@@ -718,12 +777,15 @@ public:
   ref<Expr> cond, trueExpr, falseExpr;
 
 public:
+  // <M>
+  virtual ~SelectExpr() { exprCacheClean(); }
+
   static ref<Expr> alloc(const ref<Expr> &c, const ref<Expr> &t, 
                          const ref<Expr> &f) {
-    ref<Expr> r(new SelectExpr(c, t, f));
-    r->computeHash();
-    return r;
+    SelectExpr temp(c, t, f);
+    return exprCachedAlloc(temp);
   }
+  // <M>
   
   static ref<Expr> create(ref<Expr> c, ref<Expr> t, ref<Expr> f);
 
@@ -776,11 +838,14 @@ private:
   ref<Expr> left, right;  
 
 public:
+  // <M>
+  virtual ~ConcatExpr() { exprCacheClean(); }
+
   static ref<Expr> alloc(const ref<Expr> &l, const ref<Expr> &r) {
-    ref<Expr> c(new ConcatExpr(l, r));
-    c->computeHash();
-    return c;
+    ConcatExpr temp(l, r);
+    return exprCachedAlloc(temp);
   }
+  // <M>
   
   static ref<Expr> create(const ref<Expr> &l, const ref<Expr> &r);
 
@@ -835,11 +900,14 @@ public:
   Width width;
 
 public:  
+  // <M>
+  virtual ~ExtractExpr() { exprCacheClean(); }
+
   static ref<Expr> alloc(const ref<Expr> &e, unsigned o, Width w) {
-    ref<Expr> r(new ExtractExpr(e, o, w));
-    r->computeHash();
-    return r;
+    ExtractExpr temp(e, o, w);
+    return exprCachedAlloc(temp);
   }
+  // <M>
   
   /// Creates an ExtractExpr with the given bit offset and width
   static ref<Expr> create(ref<Expr> e, unsigned bitOff, Width w);
@@ -886,11 +954,14 @@ public:
   ref<Expr> expr;
 
 public:  
+  // <M>
+  virtual ~NotExpr() { exprCacheClean(); }
+
   static ref<Expr> alloc(const ref<Expr> &e) {
-    ref<Expr> r(new NotExpr(e));
-    r->computeHash();
-    return r;
+    NotExpr temp(e);
+    return exprCachedAlloc(temp);
   }
+  // <M>
   
   static ref<Expr> create(const ref<Expr> &e);
 
@@ -963,10 +1034,10 @@ public:                                                          \
   static const unsigned numKids = 1;                             \
 public:                                                          \
     _class_kind ## Expr(ref<Expr> e, Width w) : CastExpr(e,w) {} \
+    virtual ~_class_kind ## Expr() { exprCacheClean(); }         \
     static ref<Expr> alloc(const ref<Expr> &e, Width w) {        \
-      ref<Expr> r(new _class_kind ## Expr(e, w));                \
-      r->computeHash();                                          \
-      return r;                                                  \
+      _class_kind ## Expr temp(e, w);                            \
+      return exprCachedAlloc(temp);                              \
     }                                                            \
     static ref<Expr> create(const ref<Expr> &e, Width w);        \
     Kind getKind() const { return _class_kind; }                 \
@@ -995,10 +1066,10 @@ public:                                                              \
 public:                                                              \
     _class_kind ## Expr(const ref<Expr> &l,                          \
                         const ref<Expr> &r) : BinaryExpr(l,r) {}     \
+    virtual ~_class_kind ## Expr() { exprCacheClean(); }             \
     static ref<Expr> alloc(const ref<Expr> &l, const ref<Expr> &r) { \
-      ref<Expr> res(new _class_kind ## Expr (l, r));                 \
-      res->computeHash();                                            \
-      return res;                                                    \
+      _class_kind ## Expr temp(l, r);                                \
+      return exprCachedAlloc(temp);                                  \
     }                                                                \
     static ref<Expr> create(const ref<Expr> &l, const ref<Expr> &r); \
     Width getWidth() const { return left->getWidth(); }              \
@@ -1039,10 +1110,10 @@ public:                                                              \
 public:                                                              \
     _class_kind ## Expr(const ref<Expr> &l,                          \
                         const ref<Expr> &r) : CmpExpr(l,r) {}        \
+    virtual ~_class_kind ## Expr() { exprCacheClean(); }             \
     static ref<Expr> alloc(const ref<Expr> &l, const ref<Expr> &r) { \
-      ref<Expr> res(new _class_kind ## Expr (l, r));                 \
-      res->computeHash();                                            \
-      return res;                                                    \
+      _class_kind ## Expr temp(l, r);                                \
+      return exprCachedAlloc(temp);                                  \
     }                                                                \
     static ref<Expr> create(const ref<Expr> &l, const ref<Expr> &r); \
     Kind getKind() const { return _class_kind; }                     \
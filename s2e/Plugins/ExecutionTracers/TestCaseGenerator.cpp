@@ -35,6 +35,10 @@
 
 #include <iomanip>
 #include <cctype>
+// <M>
+#include <string.h>
+#include <cstdlib>
+// <M>
 
 #include <s2e/S2E.h>
 #include <s2e/Utils.h>
@@ -59,36 +63,215 @@ TestCaseGenerator::TestCaseGenerator(S2E* s2e)
 {
     m_testIndex = 0;
     m_pathsExplored = 0;
+    // <M>
+    m_rangeCacheSize = 0;
+    m_rangeQueries = 0;
+    m_rangeHits = 0;
+    m_printConstraints = false;
+    // <M>
+}
 
+// <M>
+TestCaseGenerator::~TestCaseGenerator()
+{
+    m_traceData.close();
+    m_traceIndex.close();
 }
+// <M>
 
 void TestCaseGenerator::initialize()
 {
     s2e()->getCorePlugin()->onTestCaseGeneration.connect(
             sigc::mem_fun(*this, &TestCaseGenerator::onTestCaseGeneration));
+
+// <M>
+    // The constraints of every state are long to print, only on demand
+    m_printConstraints = s2e()->getConfig()->getBool(getConfigKey() + ".printConstraints", false);
+    int64_t rangeCacheSize = s2e()->getConfig()->getInt(getConfigKey() + ".rangeCacheSize", 4096);
+    if (rangeCacheSize < 0) {
+        s2e()->getWarningsStream() << "TestCaseGenerator: rangeCacheSize must be 0 (no cache) or more, not "
+                                   << rangeCacheSize << "\n";
+        exit(-1);
+    }
+    m_rangeCacheSize = rangeCacheSize;
+
+    std::string data = s2e()->getOutputFilename("symbolic-trace.dat");
+    std::string index = s2e()->getOutputFilename("symbolic-trace.idx");
+    m_traceData.open(data.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    m_traceIndex.open(index.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_traceData || !m_traceIndex) {
+        s2e()->getWarningsStream() << "TestCaseGenerator: could not create the symbolic trace\n";
+        return;
+    }
+
+    SymbolicTraceFileHeader header;
+    header.version = SYMBOLIC_TRACE_VERSION;
+    header.size = sizeof(SymbolicTraceRecord);
+    memcpy(header.magic, "NS3SYMTR", sizeof(header.magic));
+    m_traceData.write((const char *) &header, sizeof(header));
+    memcpy(header.magic, "NS3SYMIX", sizeof(header.magic));
+    m_traceIndex.write((const char *) &header, sizeof(header));
+// <M>
 }
 
+// <M>
+void TestCaseGenerator::handleOpcodeInvocation(S2EExecutionState *state,
+                                               uint64_t guestDataPtr,
+                                               uint64_t guestDataSize)
+{
+    SymbolicTraceRecord record;
+    if (guestDataSize != sizeof(record)) {
+        s2e()->getWarningsStream(state)
+            << "TestCaseGenerator: symbolic trace record of " << guestDataSize
+            << " bytes instead of " << sizeof(record) << "\n";
+        return;
+    }
+    if (!state->readMemoryConcrete(guestDataPtr, &record, sizeof(record))) {
+        s2e()->getWarningsStream(state)
+            << "TestCaseGenerator: could not read the symbolic trace record\n";
+        return;
+    }
+
+    DECLARE_PLUGINSTATE(TestCaseGeneratorState, state);
+    plgState->records.push_back(record);
+}
 
-void TestCaseGenerator::onTestCaseGeneration(S2EExecutionState *state, const std::string &message)
+bool TestCaseGenerator::RangeQuery::operator<(const RangeQuery &b) const
 {
-// <M>
-    std::string logString;
-    s2e()->getExecutor()->getConstraintLog(*state, logString, false);
-    s2e()->getMessagesStream()
-                << "Constraints: " << logString << "\n";   
-                
-    for (int i = 0; i < state->swtc.size (); i++) {
-        klee::ref<klee::Expr> address =state->swtc.at(i); 
+    if (hash != b.hash) {
+        return hash < b.hash;
+    }
+    if (constraints.size() != b.constraints.size()) {
+        return constraints.size() < b.constraints.size();
+    }
+    int c = expr->compare(*b.expr);
+    if (c != 0) {
+        return c < 0;
+    }
+    for (unsigned i = 0; i < constraints.size(); i++) {
+        c = constraints[i]->compare(*b.constraints[i]);
+        if (c != 0) {
+            return c < 0;
+        }
+    }
+    return false;
+}
 
-        klee::Solver *solver = s2e()->getExecutor()->getSolver();
+void TestCaseGenerator::getRanges(S2EExecutionState *state, std::vector<SymbolicTraceRange> &ranges)
+{
+    klee::Solver *solver = s2e()->getExecutor()->getSolver();
+
+    // One key for every query of the state, only the expression changes
+    bool useCache = m_rangeCacheSize > 0;
+    RangeQuery query;
+    unsigned constraintsHash = 0;
+    for (klee::ConstraintManager::const_iterator it = state->constraints.begin();
+         useCache && it != state->constraints.end(); ++it) {
+        query.constraints.push_back(*it);
+        constraintsHash = constraintsHash * 31 + (*it)->hash();
+    }
+
+    unsigned hits = 0;
+    ranges.resize(state->swtc.size());
+    for (unsigned i = 0; i < state->swtc.size(); i++) {
+        klee::ref<klee::Expr> expr = state->swtc.at(i);
+        SymbolicTraceRange &r = ranges[i];
+
+        // A concrete value needs no solver
+        if (klee::ConstantExpr *ce = klee::dyn_cast<klee::ConstantExpr>(expr)) {
+            r.lo = r.hi = ce->getZExtValue();
+            continue;
+        }
+
+        m_rangeQueries++;
+        if (useCache) {
+            query.hash = constraintsHash * 31 + expr->hash();
+            query.expr = expr;
+            RangeCache::const_iterator cached = m_rangeCache.find(query);
+            if (cached != m_rangeCache.end()) {
+                r = cached->second;
+                hits++;
+                continue;
+            }
+        }
 
         std::pair<klee::ref<klee::Expr>,klee::ref<klee::Expr> > range =
-                solver->getRange(klee::Query(state->constraints,address));       
+                solver->getRange(klee::Query(state->constraints, expr));
+        r.lo = klee::cast<klee::ConstantExpr>(range.first)->getZExtValue();
+        r.hi = klee::cast<klee::ConstantExpr>(range.second)->getZExtValue();
+
+        if (useCache) {
+            if (m_rangeCache.size() >= m_rangeCacheSize) {
+                m_rangeCache.clear();
+            }
+            m_rangeCache[query] = r;
+        }
+    }
+    m_rangeHits += hits;
+
+    // One line per state, the ranges themselves are in the symbolic trace
+    s2e()->getMessagesStream()
+            << "State : " << state->getID()
+            << "\tranges: " << ranges.size()
+            << ", cached: " << hits
+            << " (" << m_rangeHits << " of " << m_rangeQueries << " overall)\n";
+}
+
+void TestCaseGenerator::writeSymbolicTrace(S2EExecutionState *state,
+                                           const std::vector<SymbolicTraceRange> &ranges)
+{
+    if (!m_traceData || !m_traceIndex) {
+        return;
+    }
+
+    DECLARE_PLUGINSTATE(TestCaseGeneratorState, state);
+    const std::vector<SymbolicTraceRecord> &records = plgState->records;
+
+    // The path ends with the last outcome sent by the guest, if any
+    SymbolicTracePathHeader path;
+    path.state = state->getID();
+    path.outcome = SYMBOLIC_TRACE_UNFINISHED;
+    for (unsigned i = 0; i < records.size(); i++) {
+        if (records[i].kind == SYMBOLIC_TRACE_OUTCOME) {
+            path.outcome = records[i].value;
+        }
+    }
+    path.records = records.size();
+    path.ranges = ranges.size();
+
+    SymbolicTraceIndexEntry entry;
+    entry.state = path.state;
+    entry.outcome = path.outcome;
+    entry.offset = m_traceData.tellp();
+
+    m_traceData.write((const char *) &path, sizeof(path));
+    if (!records.empty()) {
+        m_traceData.write((const char *) &records[0], records.size() * sizeof(records[0]));
+    }
+    if (!ranges.empty()) {
+        m_traceData.write((const char *) &ranges[0], ranges.size() * sizeof(ranges[0]));
+    }
+    m_traceIndex.write((const char *) &entry, sizeof(entry));
+    // A state may be the last one before S2E is killed
+    m_traceData.flush();
+    m_traceIndex.flush();
+}
+// <M>
+
+
+void TestCaseGenerator::onTestCaseGeneration(S2EExecutionState *state, const std::string &message)
+{
+// <M>
+    if (m_printConstraints) {
+        std::string logString;
+        s2e()->getExecutor()->getConstraintLog(*state, logString, false);
         s2e()->getMessagesStream()
-                << "State : " << state->getID()
-                << "\trange: " << range.first << ", "
-                << range.second  << "\n";            
-    }        
+                    << "Constraints: " << logString << "\n";   
+    }
+                
+    std::vector<SymbolicTraceRange> ranges;
+    getRanges(state, ranges);
+    writeSymbolicTrace(state, ranges);
 // <M>
 	
     s2e()->getMessagesStream()
@@ -0,0 +1,180 @@
+/*
+ * S2E Selective Symbolic Execution Framework
+ *
+ * Copyright (c) 2010, Dependable Systems Laboratory, EPFL
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Dependable Systems Laboratory, EPFL nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE DEPENDABLE SYSTEMS LABORATORY, EPFL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Currently maintained by:
+ *    Vitaly Chipounov <vitaly.chipounov@epfl.ch>
+ *    Volodymyr Kuznetsov <vova.kuznetsov@epfl.ch>
+ *
+ * All contributors are listed in the S2E-AUTHORS file.
+ */
+
+#ifndef S2E_PLUGINS_TESTCASEGENERATOR_H
+#define S2E_PLUGINS_TESTCASEGENERATOR_H
+
+#include <s2e/Plugin.h>
+#include <s2e/Plugins/CorePlugin.h>
+#include <s2e/S2EExecutionState.h>
+// <M>
+#include <s2e/Plugins/BaseInstructions.h>
+
+#include <fstream>
+#include <vector>
+#include <map>
+#include <stdint.h>
+// <M>
+
+namespace s2e {
+namespace plugins {
+
+// <M>
+/**
+ * The binary trace of the symbolic values of ns-3, see
+ * src/core/model/symbolic-trace.h. These structures mirror the ones of
+ * ns3::SymbolicTrace and must be kept in sync with them.
+ */
+struct SymbolicTraceRecord
+{
+    uint32_t kind;
+    uint32_t uid;
+    uint32_t node;
+    uint32_t constraint;
+    uint32_t flags;
+    uint32_t value;
+};
+
+struct SymbolicTraceFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t size;
+};
+
+struct SymbolicTracePathHeader
+{
+    uint32_t state;
+    uint32_t outcome;
+    uint32_t records;
+    uint32_t ranges;
+};
+
+struct SymbolicTraceRange
+{
+    uint64_t lo;
+    uint64_t hi;
+};
+
+struct SymbolicTraceIndexEntry
+{
+    uint32_t state;
+    uint32_t outcome;
+    uint64_t offset;
+};
+
+static const uint32_t SYMBOLIC_TRACE_VERSION = 1;
+static const uint32_t SYMBOLIC_TRACE_OUTCOME = 4;
+static const uint32_t SYMBOLIC_TRACE_UNFINISHED = 0;
+
+/** The records sent by the guest on the path of a state. */
+class TestCaseGeneratorState : public PluginState
+{
+public:
+    std::vector<SymbolicTraceRecord> records;
+
+    virtual TestCaseGeneratorState *clone() const {
+        return new TestCaseGeneratorState(*this);
+    }
+
+    static PluginState *factory(Plugin *p, S2EExecutionState *s) {
+        return new TestCaseGeneratorState();
+    }
+};
+// <M>
+
+class TestCaseGenerator : public Plugin, public BaseInstructionsPluginInvokerInterface
+{
+    S2E_PLUGIN
+public:
+    TestCaseGenerator(S2E* s2e);
+    // <M>
+    ~TestCaseGenerator();
+    // <M>
+
+    void initialize();
+
+    // <M>
+    /** Receives a SymbolicTraceRecord from the guest. */
+    virtual void handleOpcodeInvocation(S2EExecutionState *state,
+                                        uint64_t guestDataPtr,
+                                        uint64_t guestDataSize);
+    // <M>
+
+private:
+    void onTestCaseGeneration(S2EExecutionState *state, const std::string &message);
+
+    // <M>
+    /** Appends the path of a terminated state to the trace files. */
+    void writeSymbolicTrace(S2EExecutionState *state,
+                            const std::vector<SymbolicTraceRange> &ranges);
+
+    /**
+     * A range query: an expression under the constraints of a path.
+     * Sibling states terminating with the same constraints share the
+     * results. The hash orders the queries before the expressions are
+     * compared.
+     */
+    struct RangeQuery
+    {
+        unsigned hash;
+        std::vector<klee::ref<klee::Expr> > constraints;
+        klee::ref<klee::Expr> expr;
+
+        bool operator<(const RangeQuery &b) const;
+    };
+    typedef std::map<RangeQuery, SymbolicTraceRange> RangeCache;
+
+    /** Solves the ranges of the expressions printed by a state. */
+    void getRanges(S2EExecutionState *state, std::vector<SymbolicTraceRange> &ranges);
+
+    unsigned m_testIndex;
+    unsigned m_pathsExplored;
+
+    RangeCache m_rangeCache;
+    uint64_t m_rangeCacheSize;
+    uint64_t m_rangeQueries;
+    uint64_t m_rangeHits;
+    bool m_printConstraints;
+
+    std::ofstream m_traceData;
+    std::ofstream m_traceIndex;
+    // <M>
+};
+
+}
+}
+
+#endif
@@ -31,7 +31,6 @@
 #include "ns3/flow-monitor-module.h"
 #include <fstream>
 
-#include "s2e.h"
 
 using namespace ns3;
 
@@ -153,6 +152,6 @@ main (int argc, char *argv[])
 
   Simulator::Destroy ();
   
-  s2e_kill_state (0, "End of Simulation");
+  SymbolicTrace::Terminate (SymbolicTrace::END_OF_SIMULATION, "End of Simulation");
   return 0;
 }
@@ -59,7 +59,6 @@
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/ipv4-routing-table-entry.h"
 
-#include "s2e.h"
 
 using namespace ns3;
 
@@ -286,6 +285,6 @@ int main (int argc, char **argv)
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
   
-  s2e_kill_state (0, "End of Simulation");
+  SymbolicTrace::Terminate (SymbolicTrace::END_OF_SIMULATION, "End of Simulation");
 }
 
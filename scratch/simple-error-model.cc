@@ -42,7 +42,6 @@
 #include "ns3/applications-module.h"
 #include "ns3/ipv4-global-routing-helper.h"
 
-#include "s2e.h"
 
 using namespace ns3;
 
@@ -204,5 +203,5 @@ main (int argc, char *argv[])
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
 
-  s2e_kill_state (0, "End of Simulation");
+  SymbolicTrace::Terminate (SymbolicTrace::END_OF_SIMULATION, "End of Simulation");
 }
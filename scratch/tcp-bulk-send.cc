@@ -33,7 +33,6 @@
 #include "ns3/network-module.h"
 #include "ns3/packet-sink.h"
 
-#include "s2e.h"
 
 using namespace ns3;
 
@@ -49,6 +48,9 @@ main (int argc, char *argv[])
   uint32_t numpackets = 1;
   uint64_t interval = 1024;
   uint64_t firstSymPacket = 1;
+  std::string forkReport = "";
+  bool explore = false;
+  uint32_t workers = 1;
 
 //
 // Allow the user to override any of the defaults at
@@ -61,11 +63,22 @@ main (int argc, char *argv[])
   cmd.AddValue ("interval", "Range of the interval", interval);
   cmd.AddValue ("num", "Total number of symbolic packets", numpackets);
   cmd.AddValue ("first", "First packet to be symbolic", firstSymPacket);
+  cmd.AddValue ("forkReport", "Run concretely up to the first symbolic packet, "
+                "then fork the native explorations (with --explore) and "
+                "describe the fork point in this file", forkReport);
+  cmd.AddValue ("explore", "Explore the symbolic delays natively, without S2E", explore);
+  cmd.AddValue ("workers", "Number of paths explored at the same time", workers);
   cmd.Parse (argc, argv);
 
   Simulator::SetInterval (interval);
   Simulator::SetNumberSymPackets (numpackets);
   Simulator::SetFirstSymPacket (firstSymPacket);
+  DelayExplorer::Enable (explore);
+  DelayExplorer::SetWorkers (workers);
+  if (!forkReport.empty ())
+    {
+      Simulator::SetNativeFastForward (forkReport, std::vector<uint64_t> (1, interval));
+    }
   
   std::vector <std::vector<uint32_t> > interfaces;
   interfaces.resize (2);
@@ -155,5 +168,13 @@ main (int argc, char *argv[])
 //  Ptr<PacketSink> sink1 = DynamicCast<PacketSink> (sinkApps.Get (0));
 //  std::cout << "Total Bytes Received: " << sink1->GetTotalRx () << std::endl;
 
-  s2e_kill_state (0, "End of Simulation");
+  bool isFirstPath = DelayExplorer::IsFirstPath ();
+  DelayExplorer::Wait ();
+  if (explore && isFirstPath)
+    {
+      std::cout << DelayExplorer::GetPaths () << " paths explored, "
+                << DelayExplorer::GetMergedPaths () << " merged, "
+                << DelayExplorer::GetFailedPaths () << " failed" << std::endl;
+    }
+  SymbolicTrace::Terminate (SymbolicTrace::END_OF_SIMULATION, "End of Simulation");
 }
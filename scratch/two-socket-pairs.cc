@@ -44,7 +44,6 @@
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
 
-#include "s2e.h"
 
 using namespace ns3;
 
@@ -192,7 +191,7 @@ main (int argc, char *argv[])
 
   Simulator::Destroy ();
   
-  s2e_kill_state (0, "End of Simulation");
+  SymbolicTrace::Terminate (SymbolicTrace::END_OF_SIMULATION, "End of Simulation");
   
   return 0;
 }
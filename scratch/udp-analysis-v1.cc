@@ -29,7 +29,6 @@
 //#include "ns3/csma-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/internet-module.h"
-#include "s2e.h"
 
 using namespace ns3;
 
@@ -169,5 +168,5 @@ main (int argc, char *argv[])
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
   
-  s2e_kill_state (0, "End of Simulation");
+  SymbolicTrace::Terminate (SymbolicTrace::END_OF_SIMULATION, "End of Simulation");
 }
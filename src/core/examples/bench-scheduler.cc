@@ -0,0 +1,643 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the schedulers on synthetic event traces.
+ *
+ * Each scenario runs on the DefaultSimulatorImpl with the HeapScheduler,
+ * the MapScheduler, the CalendarScheduler and the ListScheduler, the
+ * latter with no optimisation, with each of the optimisations selected
+ * by Simulator::SetImplementations, and with the default ones:
+ *
+ *   tcp  pairs of nodes exchanging segments and acknowledgements, each
+ *        segment arming a retransmission timer cancelled by its
+ *        acknowledgement, the receiver a delayed acknowledgement timer
+ *   rip  nodes on a ring sending their table to their neighbours
+ *        every 30 s, with a jitter
+ *   udp  a source sending a packet every 10 us along a line of nodes
+ *
+ * A trace written by --record (one "timestamp node" line per event, in
+ * nanoseconds) is replayed with --scenario=replay --trace=file, all its
+ * events being scheduled before the run.
+ *
+ * Every configuration runs in a child process. The insertion rate is
+ * measured over the calls scheduling events, the dequeue latency from
+ * the end of an event to the start of the next one, and the memory is
+ * the maximum resident size of the child. The calls to the global
+ * operator new during the run are counted per event.
+ */
+
+#include "ns3/core-module.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <queue>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <stdlib.h>
+#include <new>
+
+using namespace ns3;
+
+/** Calls to the global operator new. */
+static uint64_t g_allocations = 0;
+
+void *
+operator new (size_t size)
+{
+  g_allocations++;
+  void *p = malloc (size ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  free (p);
+}
+
+NS_LOG_COMPONENT_DEFINE ("BenchScheduler");
+
+namespace {
+
+/** A scheduler and the implementations it runs with. */
+struct Configuration
+{
+  const char *name;           //!< Name in the results.
+  const char *type;           //!< Scheduler TypeId name.
+  const char *implementations; //!< Flags of Simulator::SetImplementations.
+};
+
+const Configuration g_configurations[] = {
+  { "heap", "ns3::HeapScheduler", "0000000000" },
+  { "map", "ns3::MapScheduler", "0000000000" },
+  { "calendar", "ns3::CalendarScheduler", "0000000000" },
+  { "list", "ns3::ListScheduler", "0000000000" },
+  { "list-path-reduction", "ns3::ListScheduler", "1000000000" },
+  { "list-inactive-removal", "ns3::ListScheduler", "0100000000" },
+  { "list-waiting-list", "ns3::ListScheduler", "0010000000" },
+  { "list-local-lists", "ns3::ListScheduler", "0001000000" },
+  { "list-end-of-sim", "ns3::ListScheduler", "0000100000" },
+  { "list-local-lists-v2", "ns3::ListScheduler", "0001010000" },
+  { "list-default", "ns3::ListScheduler", "1111110001" },
+};
+
+/** Results sent by a child to its parent. */
+struct Results
+{
+  uint64_t events;   //!< Events executed.
+  uint64_t inserts;  //!< Events scheduled.
+  uint64_t insertNs; //!< Time spent scheduling them.
+  uint64_t p50;      //!< Median dequeue latency, ns.
+  uint64_t p90;      //!< 90th percentile.
+  uint64_t p99;      //!< 99th percentile.
+  uint64_t max;      //!< Largest dequeue latency.
+  uint64_t wallNs;   //!< Duration of Simulator::Run.
+  uint64_t allocations; //!< Calls to operator new during the run.
+};
+
+uint64_t
+Clock (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/** Runs one scenario, its handlers measuring the simulator around them. */
+class Bench
+{
+public:
+  Bench (uint32_t nodes, uint64_t events, uint32_t seed);
+
+  /**
+   * Schedule the first events of a scenario.
+   * \param [in] scenario The scenario name.
+   * \param [in] trace The trace replayed by the replay scenario.
+   * \returns \c false if the scenario is unknown.
+   */
+  bool Start (std::string scenario, std::string trace);
+  /**
+   * Write every executed event to a file, to be replayed later.
+   * \param [in] file The file name.
+   */
+  void Record (std::string file);
+  /** \returns The results, once the simulation is over. */
+  Results GetResults (void);
+
+private:
+  /** The ring or line of nodes, with the impact latency between them. */
+  void SetTopology (bool ring, Time linkDelay);
+
+  /** Called at the start of every handler. */
+  void Enter (void);
+  /** Called at the end of every handler. */
+  void Leave (void);
+  /** Schedule a node event, measuring the insertion. */
+  void Send (uint32_t to, Time delay, void (Bench::*f)(uint32_t, uint32_t), uint32_t node, uint32_t arg);
+  /** Schedule a local timer, measuring the insertion. */
+  EventId Arm (Time delay, void (Bench::*f)(uint32_t, uint32_t), uint32_t node, uint32_t arg);
+  /** \returns A pseudo-random number. */
+  uint32_t Random (void);
+
+  // tcp
+  void TcpSegment (uint32_t node, uint32_t seq);
+  void TcpAck (uint32_t node, uint32_t seq);
+  void TcpRetransmit (uint32_t node, uint32_t seq);
+  void TcpDelayedAck (uint32_t node, uint32_t seq);
+  void TcpSend (uint32_t node, uint32_t seq);
+  // rip
+  void RipPeriodic (uint32_t node, uint32_t round);
+  void RipReceive (uint32_t node, uint32_t from);
+  // udp
+  void UdpSend (uint32_t node, uint32_t seq);
+  void UdpForward (uint32_t node, uint32_t seq);
+  // replay
+  void Replayed (uint32_t node, uint32_t unused);
+
+  uint32_t m_nodes;                          //!< Number of nodes.
+  uint64_t m_target;                         //!< Events to execute.
+  uint32_t m_seed;                           //!< State of Random.
+  std::vector<std::vector<uint32_t> > m_neighbours; //!< Topology.
+  Time m_linkDelay;                          //!< Delay of every link.
+  std::vector<EventId> m_rto;                //!< Retransmission timers.
+  std::vector<EventId> m_delayedAck;         //!< Delayed ack timers.
+  uint64_t m_events;                         //!< Events executed.
+  uint64_t m_inserts;                        //!< Events scheduled.
+  uint64_t m_insertNs;                       //!< Time scheduling them.
+  uint64_t m_leave;                          //!< End of the last handler.
+  uint64_t m_runStart;                       //!< Start of the run.
+  std::vector<uint32_t> m_latencies;         //!< Dequeue latencies.
+  std::ofstream m_record;                    //!< Recorded trace.
+};
+
+Bench::Bench (uint32_t nodes, uint64_t events, uint32_t seed)
+  : m_nodes (nodes),
+    m_target (events),
+    m_seed (seed),
+    m_events (0),
+    m_inserts (0),
+    m_insertNs (0),
+    m_leave (0),
+    m_runStart (0)
+{
+  m_latencies.reserve (events);
+}
+
+uint32_t
+Bench::Random (void)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return m_seed >> 8;
+}
+
+void
+Bench::Record (std::string file)
+{
+  m_record.open (file.c_str ());
+  NS_ABORT_MSG_UNLESS (m_record, "Cannot write " << file);
+}
+
+void
+Bench::SetTopology (bool ring, Time linkDelay)
+{
+  m_linkDelay = linkDelay;
+  m_neighbours.assign (m_nodes, std::vector<uint32_t> ());
+  for (uint32_t i = 0; i + 1 < m_nodes; i++)
+    {
+      m_neighbours[i].push_back (i + 1);
+      m_neighbours[i + 1].push_back (i);
+    }
+  if (ring && m_nodes > 2)
+    {
+      m_neighbours[0].push_back (m_nodes - 1);
+      m_neighbours[m_nodes - 1].push_back (0);
+    }
+
+  // hop distances, for the impact latency of the local lists
+  std::vector<std::vector<uint64_t> > latency (m_nodes, std::vector<uint64_t> (m_nodes, 0));
+  for (uint32_t src = 0; src < m_nodes; src++)
+    {
+      std::vector<uint32_t> hops (m_nodes, 0xffffffff);
+      std::queue<uint32_t> queue;
+      hops[src] = 0;
+      queue.push (src);
+      while (!queue.empty ())
+        {
+          uint32_t n = queue.front ();
+          queue.pop ();
+          for (uint32_t k = 0; k < m_neighbours[n].size (); k++)
+            {
+              uint32_t m = m_neighbours[n][k];
+              if (hops[m] == 0xffffffff)
+                {
+                  hops[m] = hops[n] + 1;
+                  queue.push (m);
+                }
+            }
+        }
+      for (uint32_t dst = 0; dst < m_nodes; dst++)
+        {
+          latency[src][dst] = hops[dst] * linkDelay.GetTimeStep ();
+        }
+    }
+  Simulator::SetInterfaceInfo (m_neighbours);
+  Simulator::SetImpactLatency (latency);
+}
+
+bool
+Bench::Start (std::string scenario, std::string trace)
+{
+  if (scenario == "tcp")
+    {
+      SetTopology (false, MicroSeconds (500));
+      m_rto.resize (m_nodes);
+      m_delayedAck.resize (m_nodes);
+      for (uint32_t i = 0; i + 1 < m_nodes; i += 2)
+        {
+          Simulator::ScheduleWithContext (i, MicroSeconds (Random () % 1000),
+                                          &Bench::TcpSend, this, i, 0);
+        }
+    }
+  else if (scenario == "rip")
+    {
+      SetTopology (true, MilliSeconds (2));
+      for (uint32_t i = 0; i < m_nodes; i++)
+        {
+          Simulator::ScheduleWithContext (i, MilliSeconds (Random () % 30000),
+                                          &Bench::RipPeriodic, this, i, 0);
+        }
+    }
+  else if (scenario == "udp")
+    {
+      SetTopology (false, MilliSeconds (1));
+      Simulator::ScheduleWithContext (0, MicroSeconds (1), &Bench::UdpSend, this, 0, 0);
+    }
+  else if (scenario == "replay")
+    {
+      std::ifstream is (trace.c_str ());
+      NS_ABORT_MSG_UNLESS (is, "Cannot read the trace " << trace);
+      SetTopology (false, MicroSeconds (1));
+      uint64_t ts;
+      uint32_t node;
+      while (is >> ts >> node)
+        {
+          uint64_t start = Clock ();
+          Simulator::ScheduleWithContext (node % m_nodes, NanoSeconds (ts), &Bench::Replayed,
+                                          this, node % m_nodes, 0);
+          m_insertNs += Clock () - start;
+          m_inserts++;
+        }
+      m_target = std::min (m_target, m_inserts);
+    }
+  else
+    {
+      return false;
+    }
+  m_runStart = Clock ();
+  return true;
+}
+
+void
+Bench::Enter (void)
+{
+  uint64_t now = Clock ();
+  if (m_leave != 0)
+    {
+      m_latencies.push_back (now - m_leave);
+    }
+  if (m_record.is_open ())
+    {
+      m_record << Simulator::Now ().GetNanoSeconds () << " " << Simulator::GetContext () << "\n";
+    }
+  if (++m_events == m_target)
+    {
+      Simulator::Stop ();
+    }
+}
+
+void
+Bench::Leave (void)
+{
+  m_leave = Clock ();
+}
+
+void
+Bench::Send (uint32_t to, Time delay, void (Bench::*f)(uint32_t, uint32_t), uint32_t node, uint32_t arg)
+{
+  uint64_t start = Clock ();
+  Simulator::ScheduleWithContext (to, delay, f, this, node, arg);
+  m_insertNs += Clock () - start;
+  m_inserts++;
+}
+
+EventId
+Bench::Arm (Time delay, void (Bench::*f)(uint32_t, uint32_t), uint32_t node, uint32_t arg)
+{
+  uint64_t start = Clock ();
+  EventId id = Simulator::Schedule (delay, Scheduler::TIMEOUT, MakeEvent (f, this, node, arg));
+  m_insertNs += Clock () - start;
+  m_inserts++;
+  return id;
+}
+
+void
+Bench::TcpSend (uint32_t node, uint32_t seq)
+{
+  Enter ();
+  Send (node + 1, m_linkDelay, &Bench::TcpSegment, node + 1, seq);
+  Simulator::Cancel (m_rto[node]);
+  m_rto[node] = Arm (MilliSeconds (200), &Bench::TcpRetransmit, node, seq);
+  Leave ();
+}
+
+void
+Bench::TcpSegment (uint32_t node, uint32_t seq)
+{
+  Enter ();
+  // every other segment is acknowledged at once, the others on a timer
+  Simulator::Cancel (m_delayedAck[node]);
+  if (seq % 2 == 1)
+    {
+      Send (node - 1, m_linkDelay, &Bench::TcpAck, node - 1, seq);
+    }
+  else
+    {
+      m_delayedAck[node] = Arm (MilliSeconds (40), &Bench::TcpDelayedAck, node, seq);
+    }
+  Leave ();
+}
+
+void
+Bench::TcpDelayedAck (uint32_t node, uint32_t seq)
+{
+  Enter ();
+  Send (node - 1, m_linkDelay, &Bench::TcpAck, node - 1, seq);
+  Leave ();
+}
+
+void
+Bench::TcpAck (uint32_t node, uint32_t seq)
+{
+  Enter ();
+  Simulator::Cancel (m_rto[node]);
+  Send (node, MicroSeconds (1 + Random () % 20), &Bench::TcpSend, node, seq + 1);
+  Leave ();
+}
+
+void
+Bench::TcpRetransmit (uint32_t node, uint32_t seq)
+{
+  Enter ();
+  Send (node, NanoSeconds (1), &Bench::TcpSend, node, seq);
+  Leave ();
+}
+
+void
+Bench::RipPeriodic (uint32_t node, uint32_t round)
+{
+  Enter ();
+  for (uint32_t k = 0; k < m_neighbours[node].size (); k++)
+    {
+      uint32_t to = m_neighbours[node][k];
+      Send (to, m_linkDelay, &Bench::RipReceive, to, node);
+    }
+  Time next = Seconds (25) + MilliSeconds (Random () % 10000);
+  Send (node, next, &Bench::RipPeriodic, node, round + 1);
+  Leave ();
+}
+
+void
+Bench::RipReceive (uint32_t node, uint32_t from)
+{
+  Enter ();
+  // some updates change the table and trigger an update
+  if (Random () % 16 == 0)
+    {
+      for (uint32_t k = 0; k < m_neighbours[node].size (); k++)
+        {
+          uint32_t to = m_neighbours[node][k];
+          if (to != from)
+            {
+              Send (to, m_linkDelay + MilliSeconds (1 + Random () % 5), &Bench::RipReceive, to, node);
+            }
+        }
+    }
+  Leave ();
+}
+
+void
+Bench::UdpSend (uint32_t node, uint32_t seq)
+{
+  Enter ();
+  if (m_nodes > 1)
+    {
+      Send (1, m_linkDelay, &Bench::UdpForward, 1, seq);
+    }
+  Send (0, MicroSeconds (10), &Bench::UdpSend, 0, seq + 1);
+  Leave ();
+}
+
+void
+Bench::UdpForward (uint32_t node, uint32_t seq)
+{
+  Enter ();
+  if (node + 1 < m_nodes)
+    {
+      Send (node + 1, m_linkDelay, &Bench::UdpForward, node + 1, seq);
+    }
+  Leave ();
+}
+
+void
+Bench::Replayed (uint32_t node, uint32_t unused)
+{
+  Enter ();
+  Leave ();
+}
+
+Results
+Bench::GetResults (void)
+{
+  // the child exits without destroying the bench
+  if (m_record.is_open ())
+    {
+      m_record.close ();
+    }
+  Results r;
+  r.events = m_events;
+  r.inserts = m_inserts;
+  r.insertNs = m_insertNs;
+  r.wallNs = Clock () - m_runStart;
+  r.p50 = r.p90 = r.p99 = r.max = 0;
+  if (!m_latencies.empty ())
+    {
+      std::vector<uint32_t> &l = m_latencies;
+      size_t n = l.size ();
+      std::nth_element (l.begin (), l.begin () + n / 2, l.end ());
+      r.p50 = l[n / 2];
+      std::nth_element (l.begin (), l.begin () + n * 9 / 10, l.end ());
+      r.p90 = l[n * 9 / 10];
+      std::nth_element (l.begin (), l.begin () + n * 99 / 100, l.end ());
+      r.p99 = l[n * 99 / 100];
+      r.max = *std::max_element (l.begin (), l.end ());
+    }
+  return r;
+}
+
+/**
+ * Run a scenario with a configuration in a child process.
+ * \returns \c false if the child failed.
+ */
+bool
+RunChild (const Configuration &config, std::string scenario, std::string trace, std::string record,
+          uint32_t nodes, uint64_t events, uint32_t seed, Results &results, long &maxRssKb)
+{
+  int fds[2];
+  NS_ABORT_MSG_IF (pipe (fds) != 0, "pipe failed");
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "fork failed");
+  if (pid == 0)
+    {
+      close (fds[0]);
+      ObjectFactory factory;
+      factory.SetTypeId (config.type);
+      Simulator::SetScheduler (factory);
+      std::vector<bool> implementations;
+      for (const char *c = config.implementations; *c; c++)
+        {
+          implementations.push_back (*c == '1');
+        }
+      Simulator::SetImplementations (implementations);
+
+      Bench bench (nodes, events, seed);
+      if (!record.empty ())
+        {
+          bench.Record (record);
+        }
+      if (!bench.Start (scenario, trace))
+        {
+          _exit (2);
+        }
+      uint64_t allocations = g_allocations;
+      Simulator::Run ();
+      allocations = g_allocations - allocations;
+      Results r = bench.GetResults ();
+      r.allocations = allocations;
+      Simulator::Destroy ();
+      bool ok = write (fds[1], &r, sizeof (r)) == sizeof (r);
+      close (fds[1]);
+      _exit (ok ? 0 : 1);
+    }
+
+  close (fds[1]);
+  bool ok = read (fds[0], &results, sizeof (results)) == sizeof (results);
+  close (fds[0]);
+  int status;
+  struct rusage usage;
+  wait4 (pid, &status, 0, &usage);
+  maxRssKb = usage.ru_maxrss;
+  return ok && WIFEXITED (status) && WEXITSTATUS (status) == 0;
+}
+
+} // unnamed namespace
+
+int
+main (int argc, char *argv[])
+{
+  std::string scenario = "all";
+  std::string scheduler = "all";
+  std::string trace;
+  std::string record;
+  uint32_t nodes = 16;
+  uint64_t events = 200000;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("scenario", "tcp, rip, udp, replay or all", scenario);
+  cmd.AddValue ("scheduler", "Configuration name, as in the results, or all", scheduler);
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("events", "Number of events executed per run", events);
+  cmd.AddValue ("seed", "Seed of the scenarios", seed);
+  cmd.AddValue ("trace", "Trace replayed by the replay scenario", trace);
+  cmd.AddValue ("record", "Write the executed events of the first run to this file", record);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> scenarios;
+  if (scenario == "all")
+    {
+      scenarios.push_back ("tcp");
+      scenarios.push_back ("rip");
+      scenarios.push_back ("udp");
+    }
+  else
+    {
+      scenarios.push_back (scenario);
+    }
+
+  std::cout << std::left << std::setw (10) << "scenario" << std::setw (24) << "scheduler" << std::right
+            << std::setw (10) << "events" << std::setw (12) << "inserts/s"
+            << std::setw (8) << "p50" << std::setw (8) << "p90" << std::setw (8) << "p99"
+            << std::setw (10) << "max ns" << std::setw (10) << "rss KB" << std::setw (10) << "allocs/ev"
+            << std::setw (10) << "wall s" << std::endl;
+
+  int status = 0;
+  uint32_t configurations = sizeof (g_configurations) / sizeof (g_configurations[0]);
+  for (uint32_t s = 0; s < scenarios.size (); s++)
+    {
+      for (uint32_t c = 0; c < configurations; c++)
+        {
+          const Configuration &config = g_configurations[c];
+          if (scheduler != "all" && scheduler != config.name)
+            {
+              continue;
+            }
+          Results r;
+          long rss = 0;
+          std::cout << std::left << std::setw (10) << scenarios[s] << std::setw (24) << config.name
+                    << std::right << std::flush;
+          if (!RunChild (config, scenarios[s], trace, record, nodes, events, seed, r, rss))
+            {
+              std::cout << "  failed" << std::endl;
+              status = 1;
+              continue;
+            }
+          // the trace is recorded once
+          record.clear ();
+          double insertRate = r.insertNs ? r.inserts * 1e9 / r.insertNs : 0;
+          std::cout << std::setw (10) << r.events << std::setw (12) << (uint64_t) insertRate
+                    << std::setw (8) << r.p50 << std::setw (8) << r.p90 << std::setw (8) << r.p99
+                    << std::setw (10) << r.max << std::setw (10) << rss
+                    << std::setw (10) << std::setprecision (2) << std::fixed
+                    << (r.events ? (double) r.allocations / r.events : 0)
+                    << std::setw (10) << std::fixed << std::setprecision (3) << r.wallNs / 1e9
+                    << std::endl;
+        }
+    }
+  return status;
+}
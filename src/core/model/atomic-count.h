@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ATOMIC_COUNT_H
+#define ATOMIC_COUNT_H
+
+#include "ns3/core-config.h"
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup ptr
+ * Counters shared by the nodes of a MultithreadedSimulatorImpl.
+ *
+ * When ns-3 is configured with --enable-node-threads, NS3_NODE_THREADS
+ * is defined and these functions are atomic. Otherwise they are plain
+ * increments and decrements, with no cost for the usual single-threaded
+ * simulations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup ptr
+ * Increment a counter.
+ * \param [in,out] count The counter.
+ * \returns The new value of the counter.
+ */
+inline uint32_t
+AtomicIncrement (uint32_t &count)
+{
+#ifdef NS3_NODE_THREADS
+  return __sync_add_and_fetch (&count, 1);
+#else
+  return ++count;
+#endif
+}
+
+/**
+ * \ingroup ptr
+ * Increment a 64-bit counter.
+ * \param [in,out] count The counter.
+ * \returns The new value of the counter.
+ */
+inline uint64_t
+AtomicIncrement (uint64_t &count)
+{
+#ifdef NS3_NODE_THREADS
+  return __sync_add_and_fetch (&count, 1);
+#else
+  return ++count;
+#endif
+}
+
+/**
+ * \ingroup ptr
+ * Decrement a counter.
+ * \param [in,out] count The counter.
+ * \returns The new value of the counter.
+ */
+inline uint32_t
+AtomicDecrement (uint32_t &count)
+{
+#ifdef NS3_NODE_THREADS
+  return __sync_sub_and_fetch (&count, 1);
+#else
+  return --count;
+#endif
+}
+
+} // namespace ns3
+
+#endif /* ATOMIC_COUNT_H */
@@ -27,6 +27,9 @@
 #include "log.h"
 
 #include <sstream>
+// <M>
+#include <map>
+// <M>
 
 /**
  * \file
@@ -166,7 +169,26 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (uint32_t i) const;
+  // <M>
+  /**
+   * Test if the Config path specification matches a single index, which
+   * can be looked up without going through the whole container.
+   *
+   * \param [out] i The index.
+   * \returns \c true if only the index \p i matches.
+   */
+  bool GetSingleIndex (uint32_t *i) const;
+  // <M>
 private:
+  // <M>
+  /**
+   * Parse a Config path specification into the ranges it matches.
+   *
+   * \param [in] element The Config path specification, or one of its
+   *             alternatives.
+   */
+  void Compile (std::string element);
+  // <M>
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -177,6 +199,10 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  // <M>
+  /** The indices matched, as closed intervals, parsed once. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
+  // <M>
 };
 
 
@@ -184,70 +210,83 @@ ArrayMatcher::ArrayMatcher (std::string element)
   : m_element (element)
 {
   NS_LOG_FUNCTION (this << element);
+  // <M>
+  Compile (element);
+  // <M>
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+// <M>
+void
+ArrayMatcher::Compile (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_ranges.push_back (std::make_pair (0, 0xffffffff));
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      Compile (element.substr (0, tmp-0));
+      Compile (element.substr (tmp+1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-      return true;
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+// <M>
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  // <M>
+  for (uint32_t j = 0; j < m_ranges.size (); j++)
+    {
+      if (i >= m_ranges[j].first && i <= m_ranges[j].second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
     }
+  // <M>
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
+// <M>
+bool
+ArrayMatcher::GetSingleIndex (uint32_t *i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_ranges.size () != 1 || m_ranges[0].first != m_ranges[0].second)
+    {
+      return false;
+    }
+  *i = m_ranges[0].first;
+  return true;
+}
+// <M>
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -284,23 +323,70 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
+  // <M>
+  /** An element of the Config path, parsed once. */
+  struct Element
+  {
+    /**
+     * Construct from the text of the element.
+     *
+     * \param [in] item The element, between two slashes.
+     */
+    Element (std::string item)
+      : item (item),
+        matcher (item)
+    {}
+    std::string item;     //!< The element.
+    ArrayMatcher matcher; //!< The element as an index of a container.
+  };
+  /** An attribute an element can go through. */
+  struct Attribute
+  {
+    std::string name;                          //!< The attribute name.
+    bool container;                            //!< A container, else a pointer.
+    uint32_t flags;                            //!< The flags of the accessor.
+    Ptr<const AttributeAccessor> accessor;     //!< What GetAttribute uses.
+  };
+  /**
+   * The pointer and container attributes an element matches, by TypeId
+   * uid and element, looked up once for all the resolutions.
+   */
+  typedef std::map<std::pair<uint16_t, std::string>, std::vector<Attribute> > AttributeIndex;
+
+  /**
+   * Get the attributes of a TypeId, or of its parents, an element matches.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \param [in] item The element.
+   * \returns The attributes, in the order of the TypeId and its parents.
+   */
+  static const std::vector<Attribute> & GetAttributes (TypeId tid, std::string item);
+  /**
+   * Get an attribute like Object::GetAttribute, without looking it up.
+   *
+   * \param [in] object The object.
+   * \param [in] attribute The attribute.
+   * \param [out] value The value.
+   */
+  static void GetAttribute (Ptr<Object> object, const Attribute &attribute, AttributeValue &value);
+  // <M>
   /** Ensure the Config path starts and ends with a '/'. */
   void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] element The index of the element in m_elements.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t element, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
+   * \param [in] element The index of the element in m_elements.
    * \param [in,out] vector The resulting list of matching objects.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (uint32_t element, const ObjectPtrContainerValue &vector);
   /**
    * Handle one object found on the path.
    *
@@ -325,6 +411,10 @@ private:
   std::vector<std::string> m_workStack;
   /** The Config path. */
   std::string m_path;
+  // <M>
+  /** The elements of the Config path. */
+  std::vector<Element> m_elements;
+  // <M>
 };
 
 Resolver::Resolver (std::string path)
@@ -332,6 +422,16 @@ Resolver::Resolver (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+  // <M>
+  // Parse the path once, rather than every time an object is reached
+  std::string::size_type begin = 1;
+  std::string::size_type next;
+  while ((next = m_path.find ("/", begin)) != std::string::npos)
+    {
+      m_elements.push_back (Element (m_path.substr (begin, next - begin)));
+      begin = next + 1;
+    }
+  // <M>
 }
 Resolver::~Resolver ()
 {
@@ -362,7 +462,9 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  // <M>
+  DoResolve (0, root);
+  // <M>
 }
 
 std::string
@@ -387,14 +489,82 @@ Resolver::DoResolveOne (Ptr<Object> object)
   DoOne (object, GetResolvedPath ());
 }
 
+// <M>
+const std::vector<Resolver::Attribute> &
+Resolver::GetAttributes (TypeId tid, std::string item)
+{
+  NS_LOG_FUNCTION (tid << item);
+  static AttributeIndex index;
+  std::pair<AttributeIndex::iterator, bool> inserted =
+    index.insert (std::make_pair (std::make_pair (tid.GetUid (), item), std::vector<Attribute> ()));
+  std::vector<Attribute> &attributes = inserted.first->second;
+  if (!inserted.second)
+    {
+      return attributes;
+    }
+
+  TypeId instanceTid = tid;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute(i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          Attribute attribute;
+          attribute.name = info.name;
+          // GetAttribute uses the first attribute with that name, from the
+          // instance TypeId
+          struct TypeId::AttributeInformation used;
+          instanceTid.LookupAttributeByName (info.name, &used);
+          attribute.flags = used.flags;
+          attribute.accessor = used.accessor;
+          // attempt to cast to a pointer checker.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = false;
+              attributes.push_back (attribute);
+            }
+          // attempt to cast to an object vector.
+          if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = true;
+              attributes.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::GetAttribute (Ptr<Object> object, const Attribute &attribute, AttributeValue &value)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (object << attribute.name << &value);
+  if ((attribute.flags & TypeId::ATTR_GET) && attribute.accessor->HasGetter ()
+      && attribute.accessor->Get (PeekPointer (object), value))
+    {
+      return;
+    }
+  // reports the error
+  object->GetAttribute (attribute.name, value);
+}
+// <M>
 
-  if (next == std::string::npos)
+void
+Resolver::DoResolve (uint32_t element, Ptr<Object> root)
+{
+  NS_LOG_FUNCTION (this << element << root);
+  // <M>
+  if (element == m_elements.size ())
+  // <M>
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -410,8 +580,9 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  // <M>
+  const std::string &item = m_elements[element].item;
+  // <M>
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -422,11 +593,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      // <M>
+      if (item.compare (0, 5, "Names") == 0)
+      // <M>
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (element + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -443,7 +615,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (element + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -473,91 +645,84 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (element + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      // <M>
+      const std::vector<Attribute> &attributes = GetAttributes (root->GetInstanceTypeId (), item);
+      for (uint32_t i = 0; i < attributes.size (); i++)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          const Attribute &attribute = attributes[i];
+          if (!attribute.container)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<attribute.name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              GetAttribute (root, attribute, ptr);
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.push_back (attribute.name);
+              DoResolve (element + 1, object);
+              m_workStack.pop_back ();
+              continue;
             }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          NS_LOG_DEBUG ("GetAttribute(vector)="<<attribute.name<<" on path="<<GetResolvedPath ());
+          m_workStack.push_back (attribute.name);
+          // A single index is looked up in place, rather than in a copy
+          // of the container
+          uint32_t index;
+          Ptr<Object> object;
+          const ObjectPtrContainerAccessor *accessor =
+            dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (attribute.accessor));
+          if (element + 1 < m_elements.size ()
+              && m_elements[element + 1].matcher.GetSingleIndex (&index)
+              && (attribute.flags & TypeId::ATTR_GET) && accessor != 0
+              && accessor->GetByIndex (PeekPointer (root), index, object))
+            {
+              std::ostringstream oss;
+              oss << index;
+              m_workStack.push_back (oss.str ());
+              DoResolve (element + 2, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              ObjectPtrContainerValue vector;
+              GetAttribute (root, attribute, vector);
+              DoArrayResolve (element + 1, vector);
+            }
+          m_workStack.pop_back ();
+        }
       
-      if (!foundMatch)
+      if (attributes.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
         }
+      // <M>
     }
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t element, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << element << &container);
+  // <M>
+  if (element == m_elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
-
-  ArrayMatcher matcher = ArrayMatcher (item);
+  const ArrayMatcher &matcher = m_elements[element].matcher;
+  // <M>
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -566,7 +731,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (element + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -32,7 +32,12 @@
 
 // <M>
 #include "list-scheduler.h"
-#include "s2e.h"
+#include "symbolic-injection-policy.h"
+#include "delay-explorer.h"
+#include "enum.h"
+#include "abort.h"
+#include <fstream>
+#include <algorithm>
 // <M>
 
 
@@ -75,13 +80,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   // <M>
-  // initialize local clocks
-  m_numNodes = 4;
-  ListScheduler::SetNumNodes (m_numNodes);
-  for (uint32_t i=0; i < m_numNodes; i++)
-    {
-	  m_localCurrentTs.push_back (0);	
-    }
+  // local clocks are added as nodes show up in event contexts
   // set implementations to use  
   m_implementations.push_back (true); // three to two paths per iteration
   m_implementations.push_back (true); // remove inactive events
@@ -89,11 +88,13 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_implementations.push_back (true); // local lists and clocks
   m_implementations.push_back (true); // end of simulation
   m_implementations.push_back (true); // local lists v2
-  ListScheduler::SetPathReduction (m_implementations.at (0));
-  ListScheduler::SetWaitingList (m_implementations.at (2));
-  ListScheduler::SetLocalList (m_implementations.at (3));
-  ListScheduler::SetEndOfSim (m_implementations.at (4));
-  ListScheduler::SetLocalListv2 (m_implementations.at (5));  	 
+  m_implementations.push_back (false); // indexed lists
+  m_implementations.push_back (false); // head heap over local lists
+  m_implementations.push_back (false); // unordered window for symbolic events
+  m_implementations.push_back (false); // merge paths, only TCP and RIP state is hashed
+  ApplyImplementations ();
+  m_fastForward = false;
+  m_forkPending = false;
   // <M>
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
@@ -118,6 +119,15 @@ DefaultSimulatorImpl::DoDispose (void)
       //next.impl->Unref ();
     //}
   m_events = 0;
+  // <M>
+  // the default policy outlives the simulator
+  if (!m_fastForwardIntervals.empty ())
+    {
+      SymbolicInjectionPolicy::GetDefault ()->TraceDisconnectWithoutContext
+        ("SymbolicPacket", MakeCallback (&DefaultSimulatorImpl::EndFastForward, this));
+      m_fastForwardIntervals.clear ();
+    }
+  // <M>
   SimulatorImpl::DoDispose ();
 }
 void
@@ -161,19 +171,19 @@ DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
 void
 DefaultSimulatorImpl::SetInterval (uint64_t interval)
 {
-  ListScheduler::SetInterval (interval);	
+  SymbolicInjectionPolicy::GetDefault ()->SetInterval (interval);
 }
 
 void
 DefaultSimulatorImpl::SetNumberSymPackets (uint32_t numpackets)
 {
-  ListScheduler::SetNumberSymPackets (numpackets);	
+  SymbolicInjectionPolicy::GetDefault ()->SetNumberPackets (numpackets);
 }
 
 void
 DefaultSimulatorImpl::SetFirstSymPacket (uint64_t firstSymPacket)
 {
-  ListScheduler::SetFirstSymPacket (firstSymPacket);	
+  SymbolicInjectionPolicy::GetDefault ()->SetFirstPacket (firstSymPacket);
 }
 
 void
@@ -181,6 +191,150 @@ DefaultSimulatorImpl::SetInterfaceInfo (std::vector<std::vector<uint32_t> > inte
 {
   ListScheduler::SetInterfaceInfo (interfaces);	
 }
+
+void
+DefaultSimulatorImpl::SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency)
+{
+  Ptr<ListScheduler> scheduler = DynamicCast<ListScheduler> (m_events);
+  if (scheduler != 0)
+    {
+      scheduler->SetTopologyImpactLatency (impactLatency);
+    }
+}
+
+void
+DefaultSimulatorImpl::SetImplementations (std::vector<bool> implementations)
+{
+  NS_LOG_FUNCTION (this << implementations.size ());
+  NS_ABORT_MSG_IF (implementations.size () > m_implementations.size (),
+                   "Only " << m_implementations.size () << " implementations");
+  for (uint32_t i = 0; i < implementations.size (); i++)
+    {
+      m_implementations.at (i) = implementations[i];
+    }
+  ApplyImplementations ();
+}
+
+void
+DefaultSimulatorImpl::ApplyImplementations (void)
+{
+  ListScheduler::SetPathReduction (m_implementations.at (0));
+  ListScheduler::SetWaitingList (m_implementations.at (2));
+  ListScheduler::SetLocalList (m_implementations.at (3));
+  ListScheduler::SetEndOfSim (m_implementations.at (4));
+  ListScheduler::SetLocalListv2 (m_implementations.at (5));
+  ListScheduler::SetIndexedList (m_implementations.at (6));
+  ListScheduler::SetHeadHeap (m_implementations.at (7));
+  ListScheduler::SetSymbolicWindow (m_implementations.at (8));
+  ListScheduler::SetPathCache (m_implementations.at (9));
+}
+
+void
+DefaultSimulatorImpl::SetNativeFastForward (std::string forkReportFile, std::vector<uint64_t> intervals)
+{
+  NS_LOG_FUNCTION (this << forkReportFile << intervals.size ());
+  NS_ABORT_MSG_IF (intervals.empty (), "Fast-forward needs at least one interval");
+  // connected once, EndFastForward ignores the packets after the first one
+  if (m_fastForwardIntervals.empty ())
+    {
+      SymbolicInjectionPolicy::GetDefault ()->TraceConnectWithoutContext
+        ("SymbolicPacket", MakeCallback (&DefaultSimulatorImpl::EndFastForward, this));
+    }
+  m_fastForward = true;
+  m_forkReportFile = forkReportFile;
+  m_fastForwardIntervals = intervals;
+}
+
+void
+DefaultSimulatorImpl::EndFastForward (uint32_t src, uint32_t dst, uint64_t rank)
+{
+  NS_LOG_FUNCTION (this << src << dst << rank);
+  if (!m_fastForward)
+    {
+      return;
+    }
+  // stay connected, the trace is being invoked
+  m_fastForward = false;
+  m_forkPending = true;
+  m_forkSrc = src;
+  m_forkDst = dst;
+  m_forkRank = rank;
+  // the packet is injected once the trace returns, with the widest
+  // interval; each exploration narrows it down to its own
+  SymbolicInjectionPolicy::GetDefault ()->SetInterval
+    (*std::max_element (m_fastForwardIntervals.begin (), m_fastForwardIntervals.end ()));
+}
+
+void
+DefaultSimulatorImpl::ForkExplorations (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_forkPending = false;
+
+  NS_ABORT_MSG_IF (!DelayExplorer::IsEnabled (),
+                   "The native fast-forward forks the explorations, enable the DelayExplorer");
+  std::ofstream report (m_forkReportFile.c_str ());
+  NS_ABORT_MSG_IF (!report.is_open (), "Cannot open fork report file " << m_forkReportFile);
+  report << "packet " << m_forkSrc << " " << m_forkDst << " " << m_forkRank << std::endl;
+  WriteForkReport (report);
+  report.close ();
+
+  // Closures and node state cannot be serialised, the report only records
+  // where the explorations start; each path continues from the memory of
+  // this process, between two events. The paths share the workers of the
+  // DelayExplorer.
+  EnumValue target;
+  SymbolicInjectionPolicy::GetDefault ()->GetAttribute ("Target", target);
+  bool narrow = target.Get () != SymbolicInjectionPolicy::DROP
+    && DynamicCast<ListScheduler> (m_events) != 0;
+  for (std::vector<uint64_t>::const_iterator i = m_fastForwardIntervals.begin ();
+       i != m_fastForwardIntervals.end (); i++)
+    {
+      if (DelayExplorer::Spawn ())
+        {
+          SymbolicInjectionPolicy::GetDefault ()->SetInterval (*i);
+          if (narrow && !ListScheduler::NarrowSymbolicDelay (*i))
+            {
+              NS_LOG_LOGIC ("no path with interval " << *i);
+              m_stop = true;
+            }
+          return;
+        }
+    }
+  // the explorations run the rest of the simulation
+  DelayExplorer::Wait ();
+  m_stop = true;
+}
+
+void
+DefaultSimulatorImpl::WriteForkReport (std::ostream &os) const
+{
+  os << "now " << m_currentTs << " " << m_currentContext << std::endl;
+  os << "uid " << m_uid << " " << m_currentUid << std::endl;
+  os << "unscheduled " << m_unscheduledEvents << std::endl;
+  os << "clocks " << m_localCurrentTs.size ();
+  for (std::vector<uint64_t>::const_iterator i = m_localCurrentTs.begin ();
+       i != m_localCurrentTs.end (); i++)
+    {
+      os << " " << *i;
+    }
+  os << std::endl;
+  Ptr<ListScheduler> scheduler = DynamicCast<ListScheduler> (m_events);
+  if (scheduler != 0)
+    {
+      scheduler->Print (os);
+    }
+}
+
+void
+DefaultSimulatorImpl::AddLocalClock (uint32_t context)
+{
+  // a node created during the simulation starts at the current time
+  while (context != 0xffffffff && context >= m_localCurrentTs.size ())
+    {
+      m_localCurrentTs.push_back (m_currentTs);
+    }
+}
 // <M>
 
 // System ID for non-distributed simulation is always zero
@@ -194,6 +348,14 @@ void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
   Scheduler::Event next = m_events->RemoveNext ();
+  // <M>
+  // another path already ran on from this state, the event is not run
+  if (DelayExplorer::IsMerged ())
+    {
+      DelayExplorer::End ();
+    }
+  next.impl->SetDequeued ();
+  // <M>
   if (next.key.m_eventType == Scheduler::INCOMING)
     {
 	  ListScheduler::DecrementInPacket (next);
@@ -272,6 +434,10 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
        ev.key.m_ts = m_currentTs + event.timestamp;
        ev.key.m_context = event.context;
        ev.key.m_uid = m_uid;
+       // <M>
+       ev.key.m_eventType = event.event->GetEventType ();
+       // <M>
+       AddLocalClock (event.context);
        m_uid++;
        m_unscheduledEvents++;
        m_events->Insert (ev);
@@ -292,6 +458,14 @@ DefaultSimulatorImpl::Run (void)
   while (!m_events->IsEmpty () && !m_stop) 
     {
       ProcessOneEvent ();
+      // <M>
+      // forked between two events rather than from the trace of the
+      // injection policy
+      if (m_forkPending)
+        {
+          ForkExplorations ();
+        }
+      // <M>
     }
 
   // If the simulator stopped naturally by lack of events, make a
@@ -306,7 +480,7 @@ DefaultSimulatorImpl::Stop (void)
   m_stop = true;
   if (m_implementations.at (3) == true)
     {
-	  for (uint32_t i = 0; i < m_numNodes; i++)
+	  for (uint32_t i = 0; i < m_localCurrentTs.size (); i++)
 	    {
 		  m_localCurrentTs.at (i) = m_currentTs;	
 		}	
@@ -317,8 +491,9 @@ void
 DefaultSimulatorImpl::Stop (Time const &delay)
 {
   NS_LOG_FUNCTION (this << delay.GetTimeStep ());
-  ListScheduler::SetEventType (Scheduler::STOP);
-  Simulator::Schedule (delay, &Simulator::Stop);
+  // <M>
+  Simulator::Schedule (delay, Scheduler::STOP, MakeEvent (&Simulator::Stop));
+  // <M>
 }
 
 //
@@ -354,7 +529,7 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   ev.key.m_uid = m_uid;
   
   // <M>
-  ev.key.m_eventType = ListScheduler::GetCurrEventType ();
+  ev.key.m_eventType = event->GetEventType ();
   // <M>
   
   m_uid++;
@@ -372,6 +547,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     {
 //      Time tAbsolute = delay + TimeStep (m_currentTs);
 // <M>
+      AddLocalClock (context);
       Time tAbsolute;
       if (GetContext () != 0xffffffff && m_implementations.at (3) == true)
         {
@@ -389,7 +565,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       ev.key.m_context = context;
       ev.key.m_uid = m_uid;
 // <M>      
-      ev.key.m_eventType = ListScheduler::GetCurrEventType ();
+      ev.key.m_eventType = event->GetEventType ();
 // <M>       
       m_uid++;
       m_unscheduledEvents++;
@@ -416,12 +592,14 @@ void
 DefaultSimulatorImpl::ScheduleWithContext (uint32_t prevContext, uint32_t context, Time const &delay, EventImpl *event)
 {
   NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
-  ListScheduler::SetEventType (Scheduler::OUTGOING);
+  event->SetEventType (Scheduler::OUTGOING);
 
   if (SystemThread::Equals (m_main))
     {
 //      Time tAbsolute = delay + TimeStep (m_currentTs);
 // <M>
+      AddLocalClock (prevContext);
+      AddLocalClock (context);
       Time tAbsolute;
       if (prevContext != 0xffffffff && m_implementations.at (3) == true)
         {
@@ -440,7 +618,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t prevContext, uint32_t contex
       ev.key.m_uid = m_uid;
 // <M>
       ev.key.m_prevContext = prevContext;      
-      ev.key.m_eventType = ListScheduler::GetCurrEventType ();
+      ev.key.m_eventType = event->GetEventType ();
 // <M>       
       m_uid++;
       m_unscheduledEvents++;
@@ -483,7 +661,7 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   ev.key.m_uid = m_uid;
   
   // <M>
-  ev.key.m_eventType = ListScheduler::GetCurrEventType ();
+  ev.key.m_eventType = event->GetEventType ();
   // <M>
 
   m_uid++;
@@ -621,30 +799,11 @@ DefaultSimulatorImpl::IsExpired (const EventId &id) const
       return true;
     }
 // <M>
-  uint64_t currentTs;
-  if (id.GetContext () != 0xffffffff && m_implementations.at (3) == true)
-    {
-	  currentTs = m_localCurrentTs.at (id.GetContext ());	
-	}
-  else
-    {
-	  currentTs = m_currentTs;	
-	}	
-  if (s2e_is_symbolic (&currentTs, sizeof(uint64_t)))
-    {
-      s2e_get_example (&currentTs, sizeof(uint64_t));
-    }
-    
-  uint64_t eventTs = id.GetTs ();
-  if (s2e_is_symbolic (&eventTs, sizeof(uint64_t)))
-    {
-      s2e_get_example (&eventTs, sizeof(uint64_t));
-    }  	
-	
+  // The event has run, or is running, once the scheduler dequeued it.
+  // Comparing its timestamp with the clock instead would concretise
+  // them when they are symbolic.
   if (id.PeekEventImpl () == 0 ||
-      eventTs < currentTs ||
-      (eventTs == currentTs &&
-       id.GetUid () <= m_currentUid) ||
+      id.PeekEventImpl ()->IsDequeued () ||
       id.PeekEventImpl ()->IsCancelled ()) 
     {
       return true;
@@ -32,6 +32,8 @@
 #include <list>
 // <M>
 #include <vector>
+#include <ostream>
+#include <string>
 // <M>
 
 /**
@@ -74,6 +76,9 @@ public:
   virtual void SetNumberSymPackets (uint32_t numpackets);
   virtual void SetFirstSymPacket (uint64_t firstSymPacket);
   virtual void SetInterfaceInfo (std::vector<std::vector<uint32_t> > interfaces);
+  virtual void SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency);
+  virtual void SetNativeFastForward (std::string forkReportFile, std::vector<uint64_t> intervals);
+  virtual void SetImplementations (std::vector<bool> implementations);
   // <M>
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
@@ -95,6 +100,36 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  // <M>
+  /**
+   * Make sure a local clock exists for a node.
+   * \param [in] context The node id, ignored for the simulator context.
+   */
+  void AddLocalClock (uint32_t context);
+  /**
+   * Called when the default injection policy selects a packet. The first
+   * call ends the fast-forward: the packet gets the widest interval and
+   * the explorations are forked once the current event is over.
+   * \param [in] src The sending node.
+   * \param [in] dst The receiving node.
+   * \param [in] rank The rank of the packet on its link.
+   */
+  void EndFastForward (uint32_t src, uint32_t dst, uint64_t rank);
+  /**
+   * Write the fork report and fork one exploration per interval, each
+   * narrowing the symbolic value of the packet to its interval. Called
+   * by Run between two events. The parent stops once the explorations
+   * are done.
+   */
+  void ForkExplorations (void);
+  /**
+   * Write the simulator clocks and the scheduled events.
+   * \param [in,out] os The output stream.
+   */
+  void WriteForkReport (std::ostream &os) const;
+  /** Pass the implementations to the ListScheduler. */
+  void ApplyImplementations (void);
+  // <M>
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -137,8 +172,20 @@ private:
   std::vector<uint64_t> m_localCurrentTs;
   /** Indication of which implementations to use. */
   std::vector<bool> m_implementations;
-  /** Number of nodes. */
-  uint32_t m_numNodes;
+  /** True until the first symbolic packet when fast-forwarding. */
+  bool m_fastForward;
+  /** File the report of the fork point is written to. */
+  std::string m_forkReportFile;
+  /** Intervals explored after the fast-forward, one child each. */
+  std::vector<uint64_t> m_fastForwardIntervals;
+  /** True once the fast-forward is over, until the explorations fork. */
+  bool m_forkPending;
+  /** The sending node of the first symbolic packet. */
+  uint32_t m_forkSrc;
+  /** The receiving node of the first symbolic packet. */
+  uint32_t m_forkDst;
+  /** The rank of the first symbolic packet on its link. */
+  uint64_t m_forkRank;
   // <M>
   /** Execution context of the current event. */
   uint32_t m_currentContext;
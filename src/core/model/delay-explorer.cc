@@ -0,0 +1,644 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "delay-explorer.h"
+#include "log.h"
+#include "abort.h"
+#include <algorithm>
+#include <limits>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::DelayExplorer class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DelayExplorer");
+
+namespace {
+/** No bound between two variables. */
+const int64_t INFINITE_BOUND = std::numeric_limits<int64_t>::max () / 4;
+/** Number of entries of the visited states table, a power of 2. */
+const uint32_t STATES_SIZE = 1 << 20;
+/** Entries probed before giving up on a state. */
+const uint32_t STATES_PROBES = 64;
+} // anonymous namespace
+
+bool DelayExplorer::m_enabled = false;
+int DelayExplorer::m_firstPid = 0;
+DelayExplorer::Shared *DelayExplorer::m_shared = 0;
+bool DelayExplorer::m_waited = false;
+uint64_t *DelayExplorer::m_states = 0;
+Hasher DelayExplorer::m_signature;
+uint64_t DelayExplorer::m_scheduled = 0;
+bool DelayExplorer::m_merged = false;
+std::vector<Callback<uint64_t> > DelayExplorer::m_stateHashes;
+std::map<uint32_t, uint32_t> DelayExplorer::m_vars;
+std::vector<uint32_t> DelayExplorer::m_uids;
+std::vector<std::vector<int64_t> > DelayExplorer::m_bounds;
+
+void
+DelayExplorer::Enable (bool value)
+{
+  NS_LOG_FUNCTION (value);
+  m_enabled = value;
+  m_vars.clear ();
+  m_uids.assign (1, 0);
+  m_bounds.assign (1, std::vector<int64_t> (1, 0));
+  m_scheduled = 0;
+  m_merged = false;
+  if (!value)
+    {
+      m_stateHashes.clear ();
+      return;
+    }
+  m_firstPid = getpid ();
+  Shared *shared = GetShared ();
+  pthread_mutex_lock (&shared->mutex);
+  shared->paths = 1;
+  shared->failed = 0;
+  shared->merged = 0;
+  memset (m_states, 0, STATES_SIZE * sizeof (uint64_t));
+  m_signature.clear ();
+  if (m_waited)
+    {
+      // this process runs a path again
+      shared->running++;
+      m_waited = false;
+    }
+  pthread_mutex_unlock (&shared->mutex);
+}
+
+bool
+DelayExplorer::IsEnabled (void)
+{
+  return m_enabled;
+}
+
+void
+DelayExplorer::MakeSymbolic (Scheduler::EventKey &key, uint64_t lo, uint64_t hi)
+{
+  NS_LOG_FUNCTION (key.m_uid << lo << hi);
+  NS_ASSERT (m_enabled && lo <= hi);
+  uint32_t var = m_bounds.size ();
+  for (uint32_t i = 0; i < var; i++)
+    {
+      m_bounds.at (i).push_back (INFINITE_BOUND);
+    }
+  m_bounds.push_back (std::vector<int64_t> (var + 1, INFINITE_BOUND));
+  m_bounds.at (var).at (var) = 0;
+  Constrain (var, 0, hi);
+  Constrain (0, var, -static_cast<int64_t> (lo));
+  m_vars[key.m_uid] = var;
+  m_uids.push_back (key.m_uid);
+  key.m_ts = lo;
+}
+
+bool
+DelayExplorer::Restrict (const Scheduler::EventKey &key, uint64_t lo, uint64_t hi)
+{
+  NS_LOG_FUNCTION (key.m_uid << lo << hi);
+  NS_ASSERT (IsSymbolic (key) && lo <= hi);
+  uint32_t var = m_vars[key.m_uid];
+  if (!IsFeasible (var, 0, hi) || !IsFeasible (0, var, -static_cast<int64_t> (lo)))
+    {
+      return false;
+    }
+  // lo <= hi, so the lower bound still holds once the upper one is added
+  Constrain (var, 0, hi);
+  Constrain (0, var, -static_cast<int64_t> (lo));
+  return true;
+}
+
+bool
+DelayExplorer::IsSymbolic (const Scheduler::EventKey &key)
+{
+  return m_enabled && m_vars.find (key.m_uid) != m_vars.end ();
+}
+
+bool
+DelayExplorer::IsBefore (const Scheduler::EventKey &a, const Scheduler::EventKey &b)
+{
+  if (!m_enabled)
+    {
+      return a < b;
+    }
+  // m_uid breaks the tie when m_ts are equal
+  return IsBefore (a, 0, b, a.m_uid < b.m_uid);
+}
+
+bool
+DelayExplorer::IsBefore (const Scheduler::EventKey &a, int64_t offset,
+                         const Scheduler::EventKey &b, bool orEqual)
+{
+  uint32_t x;
+  uint32_t y;
+  int64_t c;
+  if (!GetBound (a, offset, b, orEqual, x, y, c))
+    {
+      return 0 <= c;
+    }
+  return Branch (x, y, c);
+}
+
+bool
+DelayExplorer::PeekBefore (const Scheduler::EventKey &a, int64_t offset,
+                           const Scheduler::EventKey &b, bool orEqual)
+{
+  uint32_t x;
+  uint32_t y;
+  int64_t c;
+  if (!GetBound (a, offset, b, orEqual, x, y, c))
+    {
+      return 0 <= c;
+    }
+  if (!IsFeasible (y, x, -c - 1))
+    {
+      return true;
+    }
+  if (!IsFeasible (x, y, c))
+    {
+      return false;
+    }
+  // both outcomes are possible, compare the smallest values
+  return -m_bounds.at (0).at (x) + m_bounds.at (0).at (y) <= c;
+}
+
+void
+DelayExplorer::Concretise (Scheduler::EventKey &key)
+{
+  if (!IsSymbolic (key))
+    {
+      return;
+    }
+  uint32_t var = m_vars[key.m_uid];
+  int64_t value = -m_bounds.at (0).at (var);
+  NS_LOG_FUNCTION (key.m_uid << value);
+  Constrain (var, 0, value);
+  Constrain (0, var, -value);
+  key.m_ts = value;
+  // the other bounds already account for the value
+  Forget (key);
+}
+
+void
+DelayExplorer::Forget (const Scheduler::EventKey &key)
+{
+  std::map<uint32_t, uint32_t>::iterator i = m_vars.find (key.m_uid);
+  if (!m_enabled || i == m_vars.end ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (key.m_uid);
+  uint32_t var = i->second;
+  uint32_t last = m_bounds.size () - 1;
+  m_vars.erase (i);
+  // The matrix is closed, removing a row and a column keeps the bounds
+  // between the other variables. The last variable takes the free index.
+  if (var != last)
+    {
+      m_bounds.at (var).swap (m_bounds.at (last));
+      for (uint32_t j = 0; j <= last; j++)
+        {
+          std::swap (m_bounds.at (j).at (var), m_bounds.at (j).at (last));
+        }
+      m_uids.at (var) = m_uids.at (last);
+      m_vars[m_uids.at (var)] = var;
+    }
+  m_bounds.pop_back ();
+  for (uint32_t j = 0; j < last; j++)
+    {
+      m_bounds.at (j).pop_back ();
+    }
+  m_uids.pop_back ();
+}
+
+void
+DelayExplorer::Resolve (Scheduler::EventKey &key)
+{
+  if (IsSymbolic (key))
+    {
+      key.m_ts = -m_bounds.at (0).at (m_vars[key.m_uid]);
+    }
+}
+
+void
+DelayExplorer::SetWorkers (uint32_t workers)
+{
+  NS_LOG_FUNCTION (workers);
+  NS_ABORT_MSG_IF (workers == 0, "The explorer needs at least one worker");
+  Shared *shared = GetShared ();
+  pthread_mutex_lock (&shared->mutex);
+  shared->workers = workers;
+  pthread_cond_broadcast (&shared->cond);
+  pthread_mutex_unlock (&shared->mutex);
+}
+
+bool
+DelayExplorer::Spawn (void)
+{
+  Shared *shared = GetShared ();
+  pthread_mutex_lock (&shared->mutex);
+  shared->paths++;
+  // taken before the fork so that the paths are served in spawn order
+  uint64_t ticket = shared->nextTicket++;
+  pthread_mutex_unlock (&shared->mutex);
+
+  // buffered output would be written by both processes
+  fflush (stdout);
+  fflush (stderr);
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "Cannot fork a new path");
+  if (pid != 0)
+    {
+      return false;
+    }
+
+  // a new path, with no path of its own to wait for yet
+  m_waited = false;
+  pthread_mutex_lock (&shared->mutex);
+  while (shared->served != ticket || shared->running >= shared->workers)
+    {
+      pthread_cond_wait (&shared->cond, &shared->mutex);
+    }
+  shared->served++;
+  shared->running++;
+  pthread_cond_broadcast (&shared->cond);
+  pthread_mutex_unlock (&shared->mutex);
+  NS_LOG_LOGIC ("path " << getpid () << " running");
+  return true;
+}
+
+void
+DelayExplorer::Wait (void)
+{
+  if (m_shared == 0 || m_waited)
+    {
+      return;
+    }
+  m_waited = true;
+  ReleaseWorker ();
+  fflush (stdout);
+  fflush (stderr);
+  int status;
+  pid_t pid;
+  while ((pid = waitpid (-1, &status, 0)) > 0 || (pid < 0 && errno == EINTR))
+    {
+      if (pid < 0 || (WIFEXITED (status) && WEXITSTATUS (status) == 0))
+        {
+          continue;
+        }
+      pthread_mutex_lock (&m_shared->mutex);
+      m_shared->failed++;
+      pthread_mutex_unlock (&m_shared->mutex);
+      if (WIFSIGNALED (status))
+        {
+          // a crashed path could not give back its worker
+          ReleaseWorker ();
+        }
+    }
+}
+
+void
+DelayExplorer::AddScheduled (const Scheduler::EventKey &key)
+{
+  if (m_enabled)
+    {
+      m_scheduled += HashScheduled (key);
+    }
+}
+
+void
+DelayExplorer::RemoveScheduled (const Scheduler::EventKey &key)
+{
+  if (m_enabled)
+    {
+      m_scheduled -= HashScheduled (key);
+    }
+}
+
+void
+DelayExplorer::AddStateHash (Callback<uint64_t> hash)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_enabled)
+    {
+      m_stateHashes.push_back (hash);
+    }
+}
+
+void
+DelayExplorer::RemoveStateHash (Callback<uint64_t> hash)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (std::vector<Callback<uint64_t> >::iterator i = m_stateHashes.begin ();
+       i != m_stateHashes.end (); i++)
+    {
+      if (i->IsEqual (hash))
+        {
+          m_stateHashes.erase (i);
+          return;
+        }
+    }
+}
+
+bool
+DelayExplorer::Visit (const Scheduler::EventKey &key)
+{
+  if (!m_enabled)
+    {
+      return false;
+    }
+  // the processed events, without their time
+  uint32_t event[3] = { key.m_uid, key.m_context, key.m_eventType };
+  std::vector<int64_t> state;
+  state.push_back (m_signature.GetHash64 (reinterpret_cast<const char *> (event), sizeof (event)));
+  state.push_back (m_scheduled);
+
+  // only the variables of scheduled events are left, in uid order
+  for (std::map<uint32_t, uint32_t>::const_iterator x = m_vars.begin (); x != m_vars.end (); x++)
+    {
+      state.push_back (m_bounds.at (x->second).at (0));
+      state.push_back (m_bounds.at (0).at (x->second));
+      for (std::map<uint32_t, uint32_t>::const_iterator y = m_vars.begin (); y != m_vars.end (); y++)
+        {
+          state.push_back (m_bounds.at (x->second).at (y->second));
+        }
+    }
+  for (std::vector<Callback<uint64_t> >::const_iterator i = m_stateHashes.begin ();
+       i != m_stateHashes.end (); i++)
+    {
+      state.push_back ((*i) ());
+    }
+
+  uint64_t hash = Hash64 (reinterpret_cast<const char *> (&state[0]), state.size () * sizeof (int64_t));
+  if (IsVisited (hash) && !IsFirstPath ())
+    {
+      NS_LOG_LOGIC ("path " << getpid () << " merged at event " << key.m_uid);
+      pthread_mutex_lock (&m_shared->mutex);
+      m_shared->merged++;
+      pthread_mutex_unlock (&m_shared->mutex);
+      m_merged = true;
+    }
+  return m_merged;
+}
+
+bool
+DelayExplorer::IsMerged (void)
+{
+  return m_merged;
+}
+
+void
+DelayExplorer::End (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Wait ();
+  _exit (0);
+}
+
+uint32_t
+DelayExplorer::GetPaths (void)
+{
+  return m_shared != 0 ? m_shared->paths : 1;
+}
+
+uint32_t
+DelayExplorer::GetFailedPaths (void)
+{
+  return m_shared != 0 ? m_shared->failed : 0;
+}
+
+uint32_t
+DelayExplorer::GetMergedPaths (void)
+{
+  return m_shared != 0 ? m_shared->merged : 0;
+}
+
+bool
+DelayExplorer::IsFirstPath (void)
+{
+  return !m_enabled || getpid () == m_firstPid;
+}
+
+DelayExplorer::Term
+DelayExplorer::GetTerm (const Scheduler::EventKey &key)
+{
+  Term term;
+  std::map<uint32_t, uint32_t>::const_iterator i = m_vars.find (key.m_uid);
+  if (i != m_vars.end ())
+    {
+      term.var = i->second;
+      term.value = 0;
+    }
+  else
+    {
+      term.var = 0;
+      term.value = key.m_ts;
+    }
+  return term;
+}
+
+bool
+DelayExplorer::GetBound (const Scheduler::EventKey &a, int64_t offset,
+                         const Scheduler::EventKey &b, bool orEqual,
+                         uint32_t &x, uint32_t &y, int64_t &c)
+{
+  x = 0;
+  y = 0;
+  // an unreachable node, see Simulator::GetMaximumSimulationTime
+  if (offset >= INFINITE_BOUND)
+    {
+      c = -1;
+      return false;
+    }
+  if (!m_enabled || (!IsSymbolic (a) && !IsSymbolic (b)))
+    {
+      if (orEqual)
+        {
+          c = a.m_ts + offset <= b.m_ts ? 0 : -1;
+        }
+      else
+        {
+          c = a.m_ts + offset < b.m_ts ? 0 : -1;
+        }
+      return false;
+    }
+  // a + offset < b  <=>  xa - xb <= vb - va - offset - 1
+  Term ta = GetTerm (a);
+  Term tb = GetTerm (b);
+  c = tb.value - ta.value - offset - (orEqual ? 0 : 1);
+  if (ta.var == tb.var)
+    {
+      return false;
+    }
+  x = ta.var;
+  y = tb.var;
+  return true;
+}
+
+uint64_t
+DelayExplorer::HashScheduled (const Scheduler::EventKey &key)
+{
+  // a symbolic timestamp is part of the state through its bounds
+  uint64_t event[3] = { key.m_uid, key.m_context, IsSymbolic (key) ? 0 : key.m_ts };
+  return Hash64 (reinterpret_cast<const char *> (event), sizeof (event));
+}
+
+bool
+DelayExplorer::IsFeasible (uint32_t x, uint32_t y, int64_t c)
+{
+  // x - y <= c contradicts the path only if y - x <= d with c + d < 0
+  int64_t d = m_bounds.at (y).at (x);
+  return d == INFINITE_BOUND || c + d >= 0;
+}
+
+void
+DelayExplorer::Constrain (uint32_t x, uint32_t y, int64_t c)
+{
+  // no bound; below INFINITE_BOUND the sums cannot overflow
+  if (c >= m_bounds.at (x).at (y) || c >= INFINITE_BOUND)
+    {
+      return;
+    }
+  // the matrix is kept closed: every i - j bound goes through the new edge
+  uint32_t n = m_bounds.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      int64_t ix = m_bounds.at (i).at (x);
+      if (ix == INFINITE_BOUND)
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < n; j++)
+        {
+          int64_t yj = m_bounds.at (y).at (j);
+          if (yj != INFINITE_BOUND)
+            {
+              m_bounds.at (i).at (j) = std::min (m_bounds.at (i).at (j), ix + c + yj);
+            }
+        }
+    }
+}
+
+bool
+DelayExplorer::Branch (uint32_t x, uint32_t y, int64_t c)
+{
+  bool canBeTrue = IsFeasible (x, y, c);
+  bool canBeFalse = IsFeasible (y, x, -c - 1);
+  if (canBeTrue && canBeFalse)
+    {
+      if (Spawn ())
+        {
+          Constrain (x, y, c);
+          return true;
+        }
+      Constrain (y, x, -c - 1);
+      return false;
+    }
+  NS_ASSERT (canBeTrue || canBeFalse);
+  return canBeTrue;
+}
+
+DelayExplorer::Shared *
+DelayExplorer::GetShared (void)
+{
+  if (m_shared != 0)
+    {
+      return m_shared;
+    }
+  void *shared = mmap (0, sizeof (Shared), PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  NS_ABORT_MSG_IF (shared == MAP_FAILED, "Cannot map the path counters");
+  m_shared = static_cast<Shared *> (shared);
+  m_shared->paths = 1;
+  m_shared->failed = 0;
+  m_shared->merged = 0;
+  m_shared->workers = 1;
+  m_shared->running = 1;
+  m_shared->nextTicket = 0;
+  m_shared->served = 0;
+  pthread_mutexattr_t mutexAttr;
+  pthread_mutexattr_init (&mutexAttr);
+  pthread_mutexattr_setpshared (&mutexAttr, PTHREAD_PROCESS_SHARED);
+  pthread_mutex_init (&m_shared->mutex, &mutexAttr);
+  pthread_mutexattr_destroy (&mutexAttr);
+  pthread_condattr_t condAttr;
+  pthread_condattr_init (&condAttr);
+  pthread_condattr_setpshared (&condAttr, PTHREAD_PROCESS_SHARED);
+  pthread_cond_init (&m_shared->cond, &condAttr);
+  pthread_condattr_destroy (&condAttr);
+  // pages are only allocated once written
+  void *states = mmap (0, STATES_SIZE * sizeof (uint64_t), PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  NS_ABORT_MSG_IF (states == MAP_FAILED, "Cannot map the visited states");
+  m_states = static_cast<uint64_t *> (states);
+  atexit (&DelayExplorer::AtExit);
+  return m_shared;
+}
+
+void
+DelayExplorer::ReleaseWorker (void)
+{
+  pthread_mutex_lock (&m_shared->mutex);
+  m_shared->running--;
+  pthread_cond_broadcast (&m_shared->cond);
+  pthread_mutex_unlock (&m_shared->mutex);
+}
+
+void
+DelayExplorer::AtExit (void)
+{
+  Wait ();
+}
+
+bool
+DelayExplorer::IsVisited (uint64_t state)
+{
+  // 0 marks the free entries
+  if (state == 0)
+    {
+      state = 1;
+    }
+  uint32_t index = state & (STATES_SIZE - 1);
+  for (uint32_t probe = 0; probe < STATES_PROBES; probe++)
+    {
+      uint64_t previous = __sync_val_compare_and_swap (&m_states[index], 0, state);
+      if (previous == 0)
+        {
+          return false;
+        }
+      if (previous == state)
+        {
+          return true;
+        }
+      index = (index + 1) & (STATES_SIZE - 1);
+    }
+  // the table is full around this entry, keep exploring
+  return false;
+}
+
+} // namespace ns3
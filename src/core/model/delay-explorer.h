@@ -0,0 +1,348 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DELAY_EXPLORER_H
+#define DELAY_EXPLORER_H
+
+#include "scheduler.h"
+#include "hash.h"
+#include "callback.h"
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <pthread.h>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::DelayExplorer class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief Explore symbolic delays natively, without S2E.
+ *
+ * When enabled, the ListScheduler no longer asks S2E for a symbolic
+ * timestamp: the timestamp of a selected transmit event becomes a
+ * variable bounded by its delay interval. Every comparison of the
+ * scheduler involving such a timestamp goes through IsBefore. When both
+ * outcomes are possible the process forks: a new path follows the
+ * \c true branch and the current one the \c false branch. Each process
+ * thus runs one distinct ordering of the events.
+ *
+ * The comparisons are all of the form x - y <= c, so the constraints of
+ * a path are kept as a difference bound matrix over the variables; an
+ * outcome is possible when the matrix stays consistent. A variable is
+ * given its smallest possible value when its event is executed, and is
+ * then dropped from the matrix, as is the variable of a cancelled event:
+ * the matrix only grows with the symbolic events still scheduled.
+ *
+ * Only the loops of the scheduler fork, through IsBefore. The ordered
+ * containers and the const accessors use PeekBefore, which never forks.
+ *
+ * The explorer state is plain process memory, fork() gives each path its
+ * own copy. Only the path counters and the worker pool are shared between
+ * the processes.
+ *
+ * At most SetWorkers() paths run at the same time. A forked path waits
+ * for a free worker before running, and a worker that becomes idle picks
+ * the oldest waiting path. With a single worker the paths run one after
+ * the other.
+ *
+ * Different delays often lead to the same events being processed in the
+ * same order. Visit keeps a rolling murmur3 hash of the (uid, context,
+ * type) of the processed events, and hashes it with the scheduled events,
+ * the bounds of their variables and the state hashes registered with
+ * AddStateHash. The scheduled events are kept as a sum of their hashes,
+ * updated by AddScheduled and RemoveScheduled. The first path to reach a
+ * state records it in a table shared by all the paths; a later path
+ * reaching the same state is merged, and ends once the simulator is back
+ * in its event loop (End). The models are only part of the state through
+ * their state hashes: the TCP sockets (TcpSocketBase) and the RIP routers
+ * (Rip) register theirs when they are created with the explorer enabled,
+ * so it must be enabled before the topology is built. The state of other
+ * models is not compared, and paths which only differ in it are merged.
+ */
+class DelayExplorer
+{
+public:
+  /**
+   * Enable or disable the explorer. It must be enabled before the first
+   * symbolic event is inserted, and before the objects registering state
+   * hashes are created.
+   *
+   * \param [in] value \c true to explore the delays natively.
+   */
+  static void Enable (bool value);
+  /** \returns \c true if the explorer is enabled. */
+  static bool IsEnabled (void);
+
+  /**
+   * Make the timestamp of an event a variable in [lo, hi]. The key
+   * timestamp is set to lo.
+   *
+   * \param [in,out] key The key of the event.
+   * \param [in] lo The smallest timestamp.
+   * \param [in] hi The largest timestamp.
+   */
+  static void MakeSymbolic (Scheduler::EventKey &key, uint64_t lo, uint64_t hi);
+  /**
+   * Narrow the range of a symbolic timestamp to [lo, hi].
+   *
+   * \param [in] key The key of the event.
+   * \param [in] lo The smallest timestamp.
+   * \param [in] hi The largest timestamp.
+   * \returns \c false, the path being left unchanged, if the timestamp
+   *          cannot be in [lo, hi] on this path.
+   */
+  static bool Restrict (const Scheduler::EventKey &key, uint64_t lo, uint64_t hi);
+  /**
+   * \param [in] key The key of an event.
+   * \returns \c true if the timestamp of the event is a variable.
+   */
+  static bool IsSymbolic (const Scheduler::EventKey &key);
+
+  /**
+   * Order two events, forking if both orders are possible.
+   *
+   * \param [in] a The first key.
+   * \param [in] b The second key.
+   * \returns \c true if \c a is scheduled before \c b
+   */
+  static bool IsBefore (const Scheduler::EventKey &a, const Scheduler::EventKey &b);
+  /**
+   * Compare two timestamps, forking if both outcomes are possible.
+   *
+   * \param [in] a The first key.
+   * \param [in] offset Added to the timestamp of \c a.
+   * \param [in] b The second key.
+   * \param [in] orEqual \c true to compare with <= rather than <.
+   * \returns \c true if a.m_ts + offset is before b.m_ts, \c false if
+   *          \c offset is unreachable
+   */
+  static bool IsBefore (const Scheduler::EventKey &a, int64_t offset,
+                        const Scheduler::EventKey &b, bool orEqual);
+  /**
+   * Compare two timestamps as IsBefore does, without forking: if both
+   * outcomes are possible, the smallest values of the timestamps decide.
+   *
+   * \param [in] a The first key.
+   * \param [in] offset Added to the timestamp of \c a.
+   * \param [in] b The second key.
+   * \param [in] orEqual \c true to compare with <= rather than <.
+   * \returns \c true if a.m_ts + offset is before b.m_ts on this path, or
+   *          may be
+   */
+  static bool PeekBefore (const Scheduler::EventKey &a, int64_t offset,
+                          const Scheduler::EventKey &b, bool orEqual);
+
+  /**
+   * Give the timestamp of an event its smallest possible value, for
+   * good. Called when the event is executed.
+   *
+   * \param [in,out] key The key of the event.
+   */
+  static void Concretise (Scheduler::EventKey &key);
+  /**
+   * Drop the variable of an event leaving the scheduler without being
+   * executed. Nothing is done for a concrete event.
+   *
+   * \param [in] key The key of the event.
+   */
+  static void Forget (const Scheduler::EventKey &key);
+  /**
+   * Set the key timestamp to the smallest possible value, without
+   * constraining the variable.
+   *
+   * \param [in,out] key The key of the event.
+   */
+  static void Resolve (Scheduler::EventKey &key);
+
+  /**
+   * Set the number of paths that may run at the same time.
+   *
+   * \param [in] workers The number of workers, at least 1.
+   */
+  static void SetWorkers (uint32_t workers);
+  /**
+   * Start a new path from the current state. The new path waits for a
+   * free worker, the oldest waiting path being served first.
+   *
+   * \returns \c true in the new path, \c false in the caller.
+   */
+  static bool Spawn (void);
+  /**
+   * End the path: give back its worker and wait for every path it has
+   * spawned. Called at exit if not called before.
+   */
+  static void Wait (void);
+
+  /**
+   * Add an event to the scheduled events of the state.
+   *
+   * \param [in] key The key of the event, once made symbolic if it is.
+   */
+  static void AddScheduled (const Scheduler::EventKey &key);
+  /**
+   * Remove an event from the scheduled events of the state, before it is
+   * concretised or forgotten.
+   *
+   * \param [in] key The key of the event.
+   */
+  static void RemoveScheduled (const Scheduler::EventKey &key);
+  /**
+   * Add a hash of the state of a node or an application to the state of
+   * the paths, called by Visit. Nothing is added while the explorer is
+   * disabled, and the hashes are dropped when it is disabled.
+   *
+   * \param [in] hash The function returning the hash.
+   */
+  static void AddStateHash (Callback<uint64_t> hash);
+  /**
+   * Remove a hash added by AddStateHash, before its object is destroyed.
+   *
+   * \param [in] hash A callback equal to the one added.
+   */
+  static void RemoveStateHash (Callback<uint64_t> hash);
+  /**
+   * Record the state reached once an event has been removed. The path is
+   * merged if another path has already reached it; the first path never
+   * is.
+   *
+   * \param [in] key The key of the removed event.
+   * \returns \c true if the path is merged.
+   */
+  static bool Visit (const Scheduler::EventKey &key);
+  /** \returns \c true if Visit has merged the path. */
+  static bool IsMerged (void);
+  /**
+   * End a merged path: wait for the paths it has spawned and exit the
+   * process. Called between two events, not from the scheduler.
+   */
+  static void End (void);
+
+  /** \returns The number of paths started so far, this one included. */
+  static uint32_t GetPaths (void);
+  /** \returns The number of paths whose process failed. */
+  static uint32_t GetFailedPaths (void);
+  /** \returns The number of paths ended by Visit. */
+  static uint32_t GetMergedPaths (void);
+  /** \returns \c true in the process that enabled the explorer. */
+  static bool IsFirstPath (void);
+
+private:
+  /** The value of a timestamp: a variable, 0 for none, plus a constant. */
+  struct Term
+  {
+    uint32_t var;    /**< Index of the variable. */
+    int64_t value;   /**< Constant added to the variable. */
+  };
+  /** Counters and worker pool shared by all the paths. */
+  struct Shared
+  {
+    uint32_t paths;         /**< Paths started. */
+    uint32_t failed;        /**< Paths whose process failed. */
+    uint32_t merged;        /**< Paths ended by Visit. */
+    uint32_t workers;       /**< Paths that may run at the same time. */
+    uint32_t running;       /**< Paths running. */
+    uint64_t nextTicket;    /**< Ticket of the next spawned path. */
+    uint64_t served;        /**< Tickets already given a worker. */
+    pthread_mutex_t mutex;  /**< Protects the pool. */
+    pthread_cond_t cond;    /**< Signalled when the pool changes. */
+  };
+
+  /**
+   * \param [in] key The key of an event.
+   * \returns The value of its timestamp.
+   */
+  static Term GetTerm (const Scheduler::EventKey &key);
+  /**
+   * \param [in] a The first key.
+   * \param [in] offset Added to the timestamp of \c a.
+   * \param [in] b The second key.
+   * \param [in] orEqual \c true to compare with <= rather than <.
+   * \param [out] x The first variable of the comparison.
+   * \param [out] y The second variable of the comparison.
+   * \param [out] c The bound of the comparison, x - y <= c.
+   * \returns \c true if the outcome depends on the variables, otherwise
+   *          \c x and \c y are both 0 and \c c gives the outcome.
+   */
+  static bool GetBound (const Scheduler::EventKey &a, int64_t offset,
+                        const Scheduler::EventKey &b, bool orEqual,
+                        uint32_t &x, uint32_t &y, int64_t &c);
+  /**
+   * \param [in] key The key of a scheduled event.
+   * \returns Its term in the sum of the scheduled events.
+   */
+  static uint64_t HashScheduled (const Scheduler::EventKey &key);
+  /**
+   * \param [in] x The first variable.
+   * \param [in] y The second variable.
+   * \param [in] c The bound.
+   * \returns \c true if x - y <= c is consistent with the path.
+   */
+  static bool IsFeasible (uint32_t x, uint32_t y, int64_t c);
+  /**
+   * Add x - y <= c to the path and tighten the matrix.
+   * \param [in] x The first variable.
+   * \param [in] y The second variable.
+   * \param [in] c The bound.
+   */
+  static void Constrain (uint32_t x, uint32_t y, int64_t c);
+  /**
+   * Decide x - y <= c, forking if both outcomes are possible.
+   * \param [in] x The first variable.
+   * \param [in] y The second variable.
+   * \param [in] c The bound.
+   * \returns The outcome followed by this process.
+   */
+  static bool Branch (uint32_t x, uint32_t y, int64_t c);
+  /** \returns The shared state, mapped on first use. */
+  static Shared *GetShared (void);
+  /** Give back the worker of this path. */
+  static void ReleaseWorker (void);
+  /** Called at exit, see Wait. */
+  static void AtExit (void);
+  /**
+   * Add a state to the shared table.
+   * \param [in] state The hash of the state.
+   * \returns \c true if the state was already there.
+   */
+  static bool IsVisited (uint64_t state);
+
+  static bool m_enabled;                      //!< Explorer enabled.
+  static int m_firstPid;                      //!< Process that enabled it.
+  static Shared *m_shared;                    //!< Counters of all the paths.
+  static bool m_waited;                       //!< Wait has been called.
+  static uint64_t *m_states;                  //!< Table of the visited states.
+  static Hasher m_signature;                  //!< Processed events of the path.
+  static uint64_t m_scheduled;                //!< Sum of the scheduled events.
+  static bool m_merged;                       //!< Visit merged the path.
+  /** State hashes of the nodes and applications. */
+  static std::vector<Callback<uint64_t> > m_stateHashes;
+  /** Variable of each symbolic event, by uid. */
+  static std::map<uint32_t, uint32_t> m_vars;
+  /** Uid of the event of each variable, variable 0 having none. */
+  static std::vector<uint32_t> m_uids;
+  /** m_bounds[x][y] is the tightest c with x - y <= c, variable 0 is zero. */
+  static std::vector<std::vector<int64_t> > m_bounds;
+};
+
+} // namespace ns3
+
+#endif /* DELAY_EXPLORER_H */
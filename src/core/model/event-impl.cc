@@ -20,6 +20,16 @@
 
 #include "event-impl.h"
 #include "log.h"
+// <M>
+#include "ns3/core-config.h"
+
+#include <pthread.h>
+
+// the sanitizer only sees the events allocated one by one
+#if defined (__SANITIZE_ADDRESS__) && !defined (NS3_NO_EVENT_POOL)
+#define NS3_NO_EVENT_POOL 1
+#endif
+// <M>
 
 /**
  * \file
@@ -31,13 +41,106 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+// <M>
+namespace {
+
+/** Granularity of the size classes of the pools, and their alignment. */
+const std::size_t POOL_GRANULARITY = 16;
+/** Largest pooled event. */
+const std::size_t POOL_MAX_SIZE = 256;
+/** Number of size classes. */
+const std::size_t POOL_CLASSES = POOL_MAX_SIZE / POOL_GRANULARITY;
+/** Events carved at once when a free list is empty. */
+const std::size_t POOL_SLAB_EVENTS = 64;
+
+/** A free event, linked in the free list of its size class. */
+struct FreeEvent
+{
+  FreeEvent *next; //!< Next free event.
+};
+
+/**
+ * Free lists of the current thread, by size class. An event freed by
+ * another thread than the one which allocated it moves to the pool of
+ * that thread.
+ */
+__thread FreeEvent *g_freeEvents[POOL_CLASSES];
+/** Whether the free lists of the current thread go to the depot on exit. */
+__thread bool g_isExitRegistered = false;
+
+/**
+ * Free lists of the threads which exited, by size class. A thread whose
+ * free list is empty takes the list of the depot before carving a slab.
+ */
+FreeEvent *g_depot[POOL_CLASSES];
+/** Protects g_depot. */
+pthread_mutex_t g_depotMutex = PTHREAD_MUTEX_INITIALIZER;
+/** Key whose destructor runs when a thread with free lists exits. */
+pthread_key_t g_exitKey;
+/** Creates g_exitKey once. */
+pthread_once_t g_exitKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Move the free lists of an exiting thread to the depot.
+ * \param [in] value Unused.
+ */
+void
+ReturnToDepot (void *value)
+{
+  pthread_mutex_lock (&g_depotMutex);
+  for (std::size_t c = 0; c < POOL_CLASSES; c++)
+    {
+      FreeEvent *head = g_freeEvents[c];
+      if (head == 0)
+        {
+          continue;
+        }
+      FreeEvent *tail = head;
+      while (tail->next != 0)
+        {
+          tail = tail->next;
+        }
+      tail->next = g_depot[c];
+      g_depot[c] = head;
+      g_freeEvents[c] = 0;
+    }
+  pthread_mutex_unlock (&g_depotMutex);
+}
+
+/** Create g_exitKey. */
+void
+CreateExitKey (void)
+{
+  pthread_key_create (&g_exitKey, &ReturnToDepot);
+}
+
+/** Have the free lists of the current thread returned to the depot when it exits. */
+void
+RegisterExit (void)
+{
+  if (!g_isExitRegistered)
+    {
+      pthread_once (&g_exitKeyOnce, &CreateExitKey);
+      // the destructor only runs for a non null value
+      pthread_setspecific (g_exitKey, &g_isExitRegistered);
+      g_isExitRegistered = true;
+    }
+}
+
+} // unnamed namespace
+// <M>
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_eventType (Scheduler::UNDEFINED),
+    m_isTransmit (false),
+    m_packetSize (0),
+    m_dequeued (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,4 +169,110 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+// <M>
+void
+EventImpl::SetEventType (Scheduler::EventSchedulers_t type)
+{
+  m_eventType = type;
+}
+
+Scheduler::EventSchedulers_t
+EventImpl::GetEventType (void) const
+{
+  return m_eventType;
+}
+
+void
+EventImpl::SetTransmit (uint32_t packetSize)
+{
+  m_isTransmit = true;
+  m_packetSize = packetSize;
+}
+
+bool
+EventImpl::IsTransmit (void) const
+{
+  return m_isTransmit;
+}
+
+uint32_t
+EventImpl::GetPacketSize (void) const
+{
+  return m_packetSize;
+}
+
+void
+EventImpl::SetDequeued (void)
+{
+  m_dequeued = true;
+}
+
+bool
+EventImpl::IsDequeued (void) const
+{
+  return m_dequeued;
+}
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+#ifdef NS3_NO_EVENT_POOL
+  return ::operator new (size);
+#else
+  if (size > POOL_MAX_SIZE)
+    {
+      return ::operator new (size);
+    }
+  std::size_t c = (size - 1) / POOL_GRANULARITY;
+  FreeEvent *&head = g_freeEvents[c];
+  if (head == 0)
+    {
+      RegisterExit ();
+      pthread_mutex_lock (&g_depotMutex);
+      head = g_depot[c];
+      g_depot[c] = 0;
+      pthread_mutex_unlock (&g_depotMutex);
+    }
+  if (head == 0)
+    {
+      // The slab is aligned for any type and the events in it are
+      // multiples of POOL_GRANULARITY
+      std::size_t eventSize = (c + 1) * POOL_GRANULARITY;
+      char *slab = static_cast<char *> (::operator new (eventSize * POOL_SLAB_EVENTS));
+      for (std::size_t i = POOL_SLAB_EVENTS; i > 0; i--)
+        {
+          FreeEvent *e = reinterpret_cast<FreeEvent *> (slab + (i - 1) * eventSize);
+          e->next = head;
+          head = e;
+        }
+    }
+  FreeEvent *e = head;
+  head = e->next;
+  return e;
+#endif
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+#ifdef NS3_NO_EVENT_POOL
+  ::operator delete (p);
+#else
+  if (size > POOL_MAX_SIZE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeEvent *e = static_cast<FreeEvent *> (p);
+  FreeEvent *&head = g_freeEvents[(size - 1) / POOL_GRANULARITY];
+  if (head == 0)
+    {
+      RegisterExit ();
+    }
+  e->next = head;
+  head = e;
+#endif
+}
+// <M>
+
 } // namespace ns3
@@ -22,6 +22,10 @@
 
 #include <stdint.h>
 #include "simple-ref-count.h"
+// <M>
+#include <cstddef>
+#include "scheduler.h"
+// <M>
 
 /**
  * \file
@@ -40,6 +44,9 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events, with the arguments bound by MakeEvent, are allocated from
+ * per-thread pools of size classes rather than by the global allocator.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +73,61 @@ public:
    */
   bool IsCancelled (void);
 
+  // <M>
+  /**
+   * Classify the event for the ListScheduler. Set before the event is
+   * scheduled, Scheduler::UNDEFINED by default.
+   *
+   * \param [in] type The event type.
+   */
+  void SetEventType (Scheduler::EventSchedulers_t type);
+  /** \returns The event type. */
+  Scheduler::EventSchedulers_t GetEventType (void) const;
+  /**
+   * Mark the event as the reception of a packet sent over a channel.
+   *
+   * \param [in] packetSize The size of the packet.
+   */
+  void SetTransmit (uint32_t packetSize);
+  /** \returns \c true if the event receives a transmitted packet. */
+  bool IsTransmit (void) const;
+  /** \returns The size of the transmitted packet, 0 if none. */
+  uint32_t GetPacketSize (void) const;
+  /**
+   * Mark the event as removed from the event list to be executed. Set by
+   * the simulator implementation right before Invoke().
+   */
+  void SetDequeued (void);
+  /**
+   * \returns \c true if the event has been dequeued to be executed.
+   *
+   * Unlike the timestamp of the event, which may be symbolic, this tells
+   * whether the event expired without involving the solver.
+   */
+  bool IsDequeued (void) const;
+
+  /**
+   * Allocate an event from the free list of its size class, in the
+   * current thread. Events larger than the largest class use the global
+   * allocator, and so do all the events when ns-3 is configured with
+   * --disable-event-pool or built with the address sanitizer.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return an event to the free list of its size class, in the current
+   * thread. The memory is never returned to the global allocator: the
+   * free lists of a thread go to a depot when it exits, for the other
+   * threads to allocate from.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+  // <M>
+
 protected:
   /**
    * Implementation for Invoke().
@@ -77,6 +139,12 @@ protected:
 
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
+  // <M>
+  Scheduler::EventSchedulers_t m_eventType;  /**< Type for the ListScheduler. */
+  bool m_isTransmit;                         /**< Receives a transmitted packet. */
+  uint32_t m_packetSize;                     /**< Size of the transmitted packet. */
+  bool m_dequeued;                           /**< Dequeued to be executed. */
+  // <M>
 };
 
 } // namespace ns3
@@ -19,6 +19,11 @@
  */
 #include "fatal-impl.h"
 #include "log.h"
+// <M>
+#ifdef NS3_LOG_ASYNC
+#include "log-ring-buffer.h"
+#endif
+// <M>
 
 #include <iostream>
 #include <list>
@@ -183,6 +188,11 @@ FlushStreams (void)
   std::cout.flush ();
   std::cerr.flush ();
   std::clog.flush ();
+  // <M>
+#ifdef NS3_LOG_ASYNC
+  LogRingBuffer::FlushClog ();
+#endif
+  // <M>
 
   delete l;
   *pl = 0;
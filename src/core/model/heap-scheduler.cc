@@ -54,7 +54,9 @@ HeapScheduler::HeapScheduler ()
   // we purposedly waste an item at the start of
   // the array to make sure the indexes in the
   // array start at one.
-  Scheduler::Event empty = { 0,{ 0,0}};
+  Scheduler::Event empty;
+  empty.key.m_ts = 0;
+  empty.key.m_uid = 0;
   m_heap.push_back (empty);
 }
 
@@ -21,11 +21,19 @@
 #include "list-scheduler.h"
 #include "event-impl.h"
 #include "log.h"
+#include "simulator.h"
+#include "string.h"
 #include <utility>
+#include <algorithm>
+#include <limits>
+#include <sstream>
 #include <string>
 #include "assert.h"
+#include "abort.h"
 #include <stdio.h>
 // <M>
+#include "delay-explorer.h"
+#include "symbolic-trace.h"
 #include "s2e.h"
 // <M>
 
@@ -48,6 +56,16 @@ ListScheduler::GetTypeId (void)
     .SetParent<Scheduler> ()
     .SetGroupName ("Core")
     .AddConstructor<ListScheduler> ()
+    .AddAttribute ("ImpactLatency",
+                   "The impact latency matrix in time steps, rows separated by "
+                   "';' and entries by spaces. Entry j of row i is the shortest "
+                   "delay for an event at node i to affect node j. If empty, the "
+                   "matrix is computed from the topology when the local lists first "
+                   "need it.",
+                   StringValue (""),
+                   MakeStringAccessor (&ListScheduler::SetImpactLatencyMatrix,
+                                       &ListScheduler::GetImpactLatencyMatrix),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -55,75 +73,105 @@ ListScheduler::GetTypeId (void)
 ListScheduler::ListScheduler ()
 {
   m_currNode = 0;		
+  m_isImpactLatencyFixed = false;
+  m_isImpactLatencySet = false;
+  m_impactLatencyNodes = 0;
+  m_pending.resize (1);
+  m_freePending = 0;
+  m_schedulers.push_back (this);
   NS_LOG_FUNCTION (this);
 }
 ListScheduler::~ListScheduler ()
 {
+  m_schedulers.erase (std::find (m_schedulers.begin (), m_schedulers.end (), this));
 }
 
 // <M>
-uint32_t ListScheduler::m_numpackets = 0;
-uint64_t ListScheduler::m_interval = 1024;
-//uint64_t ListScheduler::m_symTime = 0;
-uint64_t ListScheduler::m_firstSymPacket = 0;
-uint32_t ListScheduler::m_symLink[2] = {0xffffffff, 0xffffffff};
-uint64_t ListScheduler::m_packetId = 0;
+bool ListScheduler::m_injectSymbolic = false;
+uint64_t ListScheduler::m_symInterval = 0;
+uint64_t ListScheduler::m_symMinimum = 0;
+bool ListScheduler::m_symAdvance = false;
+ListScheduler::SymbolicDelay ListScheduler::m_lastSymbolic;
 std::vector<Scheduler::Node> ListScheduler::m_nodes;
+uint32_t ListScheduler::m_waitingNodes = 0;
+std::set<uint32_t> ListScheduler::m_readyNodes;
+uint32_t ListScheduler::m_deadLocks = 0;
+bool ListScheduler::m_inDeadLock = false;
 
 bool ListScheduler::m_usePathReduction = true;
 bool ListScheduler::m_useWaitingList = true;
 bool ListScheduler::m_useLocalList = true;
 bool ListScheduler::m_useEndOfSim = true;
 bool ListScheduler::m_useLocalListv2 = true;
+bool ListScheduler::m_useIndexedList = false;
+bool ListScheduler::m_useHeadHeap = false;
+bool ListScheduler::m_useSymbolicWindow = false;
+bool ListScheduler::m_usePathCache = false;
 
-bool ListScheduler::m_isTransmitEvent = false;
-uint32_t ListScheduler::m_numNodes = 2;
-uint32_t ListScheduler::m_currPacketSize = 0;
-Scheduler::EventSchedulers_t ListScheduler::m_currEventType = UNDEFINED;
-bool ListScheduler::m_isNodeVectorInitialized = false;
 bool ListScheduler::debug = false;
+std::vector<ListScheduler *> ListScheduler::m_schedulers;
 
-void
-ListScheduler::SetPacketId (uint64_t packetId)
-{
-  m_packetId = packetId;
-}
-
-void
-ListScheduler::SetSymLink (uint32_t node1, uint32_t node2)
-{
-  m_symLink[0] = node1;
-  m_symLink[1] = node2;
-}
-
-void
-ListScheduler::SetFirstSymPacket (uint64_t firstSymPacket)
+bool
+ListScheduler::HasQueuedEvents (void)
 {
-  m_firstSymPacket = firstSymPacket;
+  for (uint32_t i = 0; i < m_schedulers.size (); i++)
+    {
+      if (!m_schedulers[i]->IsEmpty ())
+        {
+          return true;
+        }
+    }
+  return false;
 }
 
 void
-ListScheduler::SetInterval (uint64_t interval)
+ListScheduler::SetSymbolicDelay (uint64_t interval, bool advance, uint64_t minimum)
 {
-  m_interval = interval;
+  NS_ASSERT (minimum <= interval);
+  m_injectSymbolic = true;
+  m_symInterval = interval;
+  m_symMinimum = minimum;
+  m_symAdvance = advance;
 }
 
-void
-ListScheduler::SetNumberSymPackets (uint32_t numpackets)
+bool
+ListScheduler::NarrowSymbolicDelay (uint64_t interval)
 {
-  m_numpackets = numpackets;
+  NS_LOG_FUNCTION (interval);
+  SymbolicDelay &last = m_lastSymbolic;
+  NS_ASSERT (interval <= last.interval);
+  if (last.minimum > interval && !last.advance)
+    {
+      return false;
+    }
+  // the minimum of an advance is capped by the advance, as in
+  // SymbolicInjectionPolicy::Inject
+  uint64_t minimum = std::min (last.minimum, interval);
+  uint64_t lo = last.advance ? last.ts - interval : last.ts + minimum;
+  uint64_t hi = last.advance ? last.ts - minimum : last.ts + interval;
+  if (DelayExplorer::IsEnabled ())
+    {
+      return DelayExplorer::Restrict (last.key, lo, hi);
+    }
+  s2e_assume ((last.key.m_ts >= lo) & (last.key.m_ts <= hi));
+  return true;
 }
 
 void
 ListScheduler::SetInterfaceInfo (std::vector<std::vector<uint32_t> > interfaces)
 {
   m_nodes.resize (interfaces.size ());	
+  m_waitingNodes = 0;
+  m_readyNodes.clear ();
+  m_inDeadLock = false;
   for (unsigned  i = 0; i < interfaces.size (); i++)
     {
 	  m_nodes.at (i).m_context = i;
 	  m_nodes.at (i).m_isWaiting = false;
 	  m_nodes.at (i).m_interface = interfaces.at (i);
 	  m_nodes.at (i).m_inPackets. assign (interfaces.at (i).size (), 0);        	
+	  m_nodes.at (i).m_emptyInterfaces = interfaces.at (i).size ();
+	  m_readyNodes.insert (m_readyNodes.end (), i);
     }
   //if (true)
     //{
@@ -149,6 +197,10 @@ ListScheduler::SetPathReduction (bool value)
 void
 ListScheduler::SetWaitingList (bool value)
 {
+  // TIMEOUT events hold pending lists and are indexed as barriers only
+  // in this mode
+  NS_ABORT_MSG_IF (value != m_useWaitingList && HasQueuedEvents (),
+                   "ListScheduler: the waiting list mode cannot change while events are queued");
   m_useWaitingList = value;
 }
 
@@ -167,38 +219,234 @@ ListScheduler::SetEndOfSim (bool value)
 void
 ListScheduler::SetLocalListv2 (bool value)
 {
+  // the head heap is kept for the deadlocks of local lists v2
+  NS_ABORT_MSG_IF (value != m_useLocalListv2 && HasQueuedEvents (),
+                   "ListScheduler: local lists v2 cannot change while events are queued");
   m_useLocalListv2 = value;	
 }
 
 void
-ListScheduler::SetPacketSize (uint32_t packetSize)
+ListScheduler::SetIndexedList (bool value)
 {
-  m_currPacketSize = packetSize;		
-}	
+  NS_ABORT_MSG_IF (value != m_useIndexedList && HasQueuedEvents (),
+                   "ListScheduler: the indexed list mode cannot change while events are queued");
+  m_useIndexedList = value;
+}
 
 void
-ListScheduler::SetNumNodes (uint32_t n)
+ListScheduler::SetHeadHeap (bool value)
 {
-  m_numNodes = n;		
-}	
+  NS_ABORT_MSG_IF (value != m_useHeadHeap && HasQueuedEvents (),
+                   "ListScheduler: the head heap cannot change while events are queued");
+  m_useHeadHeap = value;
+}
 
 void
-ListScheduler::SetTransmitEvent (bool value)
+ListScheduler::SetSymbolicWindow (bool value)
 {
-  m_isTransmitEvent = value;
+  m_useSymbolicWindow = value;
 }
 
-void 
-ListScheduler::SetEventType (EventSchedulers_t eventType)
+void
+ListScheduler::SetPathCache (bool value)
 {
-  m_currEventType = eventType;
+  m_usePathCache = value;
 }
 
-Scheduler::EventSchedulers_t
-ListScheduler::GetCurrEventType (void)
+void
+ListScheduler::SetImpactLatencyMatrix (std::string matrix)
 {
-  return m_currEventType;	
-}	
+  NS_LOG_FUNCTION (this << matrix);
+  m_impactLatency.clear ();
+  std::istringstream rows (matrix);
+  std::string row;
+  while (std::getline (rows, row, ';'))
+    {
+      std::istringstream entries (row);
+      nodeImpactLatency latency;
+      uint64_t entry;
+      while (entries >> entry)
+        {
+          latency.push_back (entry);
+        }
+      NS_ABORT_MSG_IF (!entries.eof (), "Invalid impact latency row \"" << row << "\"");
+      m_impactLatency.push_back (latency);
+    }
+  m_isImpactLatencyFixed = !m_impactLatency.empty ();
+}
+
+std::string
+ListScheduler::GetImpactLatencyMatrix (void) const
+{
+  std::ostringstream oss;
+  for (unsigned i = 0; i < m_impactLatency.size (); i++)
+    {
+      if (i != 0)
+        {
+          oss << ";";
+        }
+      for (unsigned j = 0; j < m_impactLatency.at (i).size (); j++)
+        {
+          if (j != 0)
+            {
+              oss << " ";
+            }
+          oss << m_impactLatency.at (i).at (j);
+        }
+    }
+  return oss.str ();
+}
+
+void
+ListScheduler::SetTopologyImpactLatency (std::vector<std::vector<uint64_t> > impactLatency)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_isImpactLatencyFixed)
+    {
+      m_impactLatency = impactLatency;
+      m_isImpactLatencySet = true;
+    }
+}
+
+void
+ListScheduler::UpdateImpactLatency (void)
+{
+  if (m_isImpactLatencyFixed || m_isImpactLatencySet
+      || m_nodesEvents.size () <= m_impactLatencyNodes)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_nodesEvents.size ());
+  m_impactLatencyNodes = m_nodesEvents.size ();
+  m_impactLatency = Simulator::GetTopologyImpactLatency ();
+}
+
+void
+ListScheduler::Print (std::ostream &os) const
+{
+  PrintList (os, "main", m_events);
+  PrintList (os, "sim", m_simEvents);
+  for (uint32_t i = 0; i < m_nodesEvents.size (); i++)
+    {
+      std::ostringstream name;
+      name << "node " << i;
+      PrintList (os, name.str (), m_nodesEvents.at (i));
+    }
+  PrintList (os, "symbolic", m_symWindow);
+}
+
+void
+ListScheduler::PrintList (std::ostream &os, std::string name, const Events &subList) const
+{
+  os << "list " << name << " " << subList.size () << std::endl;
+  for (Events::const_iterator i = subList.begin (); i != subList.end (); i++)
+    {
+      os << i->key.m_ts << " " << i->key.m_uid << " " << i->key.m_context
+         << " " << i->key.m_eventType << " " << GetPendingSize (*i) << std::endl;
+    }
+}
+
+void
+ListScheduler::PushPending (Event &owner, const Event &ev)
+{
+  // Pending events never wait on each other
+  NS_ASSERT (ev.pending == 0);
+  uint32_t node = m_freePending;
+  if (node != 0)
+    {
+      m_freePending = m_pending[node].next;
+    }
+  else
+    {
+      node = m_pending.size ();
+      m_pending.push_back (PendingNode ());
+    }
+  m_pending[node].ev = ev;
+  m_pending[node].next = 0;
+  if (owner.pending == 0)
+    {
+      owner.pending = node;
+    }
+  else
+    {
+      m_pending[m_pending[owner.pending].last].next = node;
+    }
+  m_pending[owner.pending].last = node;
+}
+
+Scheduler::Event
+ListScheduler::PopPending (Event &owner)
+{
+  uint32_t node = owner.pending;
+  NS_ASSERT (node != 0);
+  owner.pending = m_pending[node].next;
+  if (owner.pending != 0)
+    {
+      m_pending[owner.pending].last = m_pending[node].last;
+    }
+  m_pending[node].next = m_freePending;
+  m_freePending = node;
+  return m_pending[node].ev;
+}
+
+bool
+ListScheduler::ErasePending (Event &owner, uint32_t uid)
+{
+  uint32_t prev = 0;
+  for (uint32_t node = owner.pending; node != 0; node = m_pending[node].next)
+    {
+      if (m_pending[node].ev.key.m_uid == uid)
+        {
+          if (prev == 0)
+            {
+              PopPending (owner);
+              return true;
+            }
+          m_pending[prev].next = m_pending[node].next;
+          if (m_pending[owner.pending].last == node)
+            {
+              m_pending[owner.pending].last = prev;
+            }
+          m_pending[node].next = m_freePending;
+          m_freePending = node;
+          return true;
+        }
+      prev = node;
+    }
+  return false;
+}
+
+uint32_t
+ListScheduler::GetPendingSize (const Event &owner) const
+{
+  uint32_t size = 0;
+  for (uint32_t node = owner.pending; node != 0; node = m_pending[node].next)
+    {
+      size++;
+    }
+  return size;
+}
+
+uint64_t
+ListScheduler::GetImpactLatency (uint32_t src, uint32_t dst) const
+{
+  if (src < m_impactLatency.size () && dst < m_impactLatency.at (src).size ())
+    {
+      return m_impactLatency.at (src).at (dst);
+    }
+  return 0;
+}
+
+void
+ListScheduler::AddNodeList (uint32_t context)
+{
+  if (context != 0xffffffff && context >= m_nodesEvents.size ())
+    {
+      m_nodesEvents.resize (context + 1);
+      m_nodesIndex.resize (context + 1);
+      m_isNodeDirty.resize (context + 1, false);
+    }
+}
 
 
 void
@@ -250,25 +498,331 @@ ListScheduler::InsertPathReduction (EventsI i, const Event &ev)
   // m_uid are used as a tiebreaker when m_ts are equal 		
   if (ev.key.m_uid < i->key.m_uid)
 	{
-      if (ev.key.m_ts <= i->key.m_ts)
+      if (DelayExplorer::IsBefore (ev.key, 0, i->key, true))
         {		  	
 	      return true;	
 	    }	
     }
   else // m_uid of ev is larger than that of i
 	{
-      if (ev.key.m_ts < i->key.m_ts)
+      if (DelayExplorer::IsBefore (ev.key, 0, i->key, false))
         {
 	      return true;	
 	    }		
     }
-  return false;         	
+  return false;         	
+}
+
+bool
+ListScheduler::IsIndexed (void)
+{
+  // a comparison of the DelayExplorer may fork, which must not happen
+  // halfway through an update of a multimap
+  return m_useIndexedList == true && !DelayExplorer::IsEnabled ();
+}
+
+bool
+ListScheduler::KeepsHeads (void)
+{
+  return m_useHeadHeap == true || m_useLocalListv2 == true;
+}
+
+bool
+ListScheduler::EventKeyLess::operator () (const Scheduler::EventKey &a,
+                                          const Scheduler::EventKey &b) const
+{
+  if (m_usePathReduction == true)
+    {
+      // same single comparison of m_ts as InsertPathReduction
+      if (a.m_uid < b.m_uid)
+        {
+          return a.m_ts <= b.m_ts;
+        }
+      return a.m_ts < b.m_ts;
+    }
+  return a < b;
+}
+
+ListScheduler::IndexedList &
+ListScheduler::GetIndex (Events &subList)
+{
+  if (&subList == &m_events)
+    {
+      return m_eventsIndex;
+    }
+  if (&subList == &m_simEvents)
+    {
+      return m_simEventsIndex;
+    }
+  return m_nodesIndex.at (&subList - &m_nodesEvents.front ());
+}
+
+// All insertions into a top level list go through here to keep its index in sync
+ListScheduler::EventsI
+ListScheduler::Link (Events &subList, EventsI pos, const Event &ev)
+{
+  EventsI i = subList.insert (pos, ev);
+  if (KeepsHeads () && i == subList.begin ())
+    {
+      PushHead (GetNode (subList));
+    }
+  if (IsIndexed ())
+    {
+      IndexedList &index = GetIndex (subList);
+      index.keys.insert (std::make_pair (ev.key, i));
+      // TIMEOUT events only stop the insertion loops with waiting lists
+      if (ev.key.m_eventType == TIMEOUT && m_useWaitingList == true)
+        {
+          index.barriers.insert (std::make_pair (ev.key, i));
+        }
+      if (ev.key.m_eventType == STOP && m_useEndOfSim == true)
+        {
+          index.barriers.insert (std::make_pair (ev.key, i));
+          index.stops.insert (std::make_pair (ev.key, i));
+        }
+    }
+  return i;
+}
+
+void
+ListScheduler::EraseIndex (EventIndex &index, EventsI i)
+{
+  std::pair<EventIndex::iterator, EventIndex::iterator> range = index.equal_range (i->key);
+  for (EventIndex::iterator j = range.first; j != range.second; j++)
+    {
+      if (j->second == i)
+        {
+          index.erase (j);
+          return;
+        }
+    }
+}
+
+// All removals from a top level list go through here to keep its index in sync
+void
+ListScheduler::Unlink (Events &subList, EventsI i)
+{
+  if (IsIndexed ())
+    {
+      IndexedList &index = GetIndex (subList);
+      EraseIndex (index.keys, i);
+      if (i->key.m_eventType == TIMEOUT || i->key.m_eventType == STOP)
+        {
+          EraseIndex (index.barriers, i);
+          EraseIndex (index.stops, i);
+        }
+    }
+  if (KeepsHeads () && i == subList.begin ())
+    {
+      uint32_t node = GetNode (subList);
+      subList.erase (i);
+      PushHead (node);
+      if (m_useHeadHeap == true)
+        {
+          MarkDirty (node);
+        }
+      return;
+    }
+  subList.erase (i);
+}
+
+// Find an event of a top level list by key, end () if it is not in that list
+ListScheduler::EventsI
+ListScheduler::Find (Events &subList, const Event &ev)
+{
+  if (IsIndexed ())
+    {
+      IndexedList &index = GetIndex (subList);
+      std::pair<EventIndex::iterator, EventIndex::iterator> range = index.keys.equal_range (ev.key);
+      for (EventIndex::iterator j = range.first; j != range.second; j++)
+        {
+          if (j->second->key.m_uid == ev.key.m_uid)
+            {
+              return j->second;
+            }
+        }
+      return subList.end ();
+    }
+  for (EventsI i = subList.begin (); i != subList.end (); i++)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          return i;
+        }
+    }
+  return subList.end ();
+}
+
+uint32_t
+ListScheduler::GetListNode (const Scheduler::EventKey &key) const
+{
+  if (m_useLocalList == false)
+    {
+      return 0xffffffff;
+    }
+  if (m_useLocalListv2 == true && key.m_eventType == OUTGOING)
+    {
+      return key.m_prevContext;
+    }
+  return key.m_context;
+}
+
+uint32_t
+ListScheduler::GetNode (const Events &subList) const
+{
+  if (m_nodesEvents.empty () || &subList < &m_nodesEvents.front ()
+      || &subList > &m_nodesEvents.back ())
+    {
+      return 0xffffffff;
+    }
+  return &subList - &m_nodesEvents.front ();
+}
+
+bool
+ListScheduler::HeadGreater::operator () (const Head &a, const Head &b) const
+{
+  // never forks: a symbolic timestamp is its smallest value when pushed
+  return b.key < a.key;
+}
+
+// Called whenever the front of a list may have changed
+void
+ListScheduler::PushHead (uint32_t node)
+{
+  if (node == 0xffffffff || m_nodesEvents.at (node).empty ())
+    {
+      return;
+    }
+  // Too many stale entries, rebuild the heap from the fronts
+  if (m_heads.size () > 2 * m_nodesEvents.size () + 16)
+    {
+      m_heads.clear ();
+      for (uint32_t j = 0; j < m_nodesEvents.size (); j++)
+        {
+          if (j != node && !m_nodesEvents.at (j).empty ())
+            {
+              Head head = { m_nodesEvents.at (j).front ().key, j };
+              m_heads.push_back (head);
+            }
+        }
+      std::make_heap (m_heads.begin (), m_heads.end (), HeadGreater ());
+    }
+  Head head = { m_nodesEvents.at (node).front ().key, node };
+  m_heads.push_back (head);
+  std::push_heap (m_heads.begin (), m_heads.end (), HeadGreater ());
+}
+
+// A front event with a pending list must have it extracted before it runs
+void
+ListScheduler::MarkDirty (uint32_t node)
+{
+  if (node != 0xffffffff && !m_isNodeDirty.at (node))
+    {
+      m_isNodeDirty.at (node) = true;
+      m_dirtyNodes.push_back (node);
+    }
+}
+
+bool
+ListScheduler::PeekHead (uint32_t &node) const
+{
+  while (!m_heads.empty ())
+    {
+      const Head &head = m_heads.front ();
+      const Events &subList = m_nodesEvents.at (head.node);
+      if (!subList.empty () && subList.front ().key.m_uid == head.key.m_uid)
+        {
+          node = head.node;
+          return true;
+        }
+      std::pop_heap (m_heads.begin (), m_heads.end (), HeadGreater ());
+      m_heads.pop_back ();
+    }
+  return false;
+}
+
+// Indexed equivalent of the linear insertion loops.
+// A loop starting at start stops at the first of:
+// - an event after ev, where ev is inserted,
+// - a TIMEOUT event (if useTimeout and its uid is not skipUid), where ev is pushed
+//   into its pending list,
+// - a STOP event not after ev, where ev is pushed at the back of the list.
+// Events in front of the first STOP are sorted, so the loop reaches the first
+// barrier iff ev is not before the event just in front of it.
+void
+ListScheduler::InsertIndexed (Events &subList, EventsI start, const Event &ev,
+                              bool useTimeout, uint32_t skipUid)
+{
+  if (start == subList.end ())
+    {
+      Link (subList, subList.end (), ev);
+      return;
+    }
+
+  IndexedList &index = GetIndex (subList);
+  EventKeyLess less;
+  EventIndex::iterator b = index.barriers.begin ();
+  if (start != subList.begin ())
+    {
+      if (!index.stops.empty () && less (index.stops.begin ()->first, start->key))
+        {
+          // start is behind the end of simulation, nothing there is ordered
+          Link (subList, subList.end (), ev);
+          return;
+        }
+      // in front of the first STOP the list is in key order
+      b = index.barriers.lower_bound (start->key);
+    }
+  // at most the front TIMEOUT is skipped
+  while (b != index.barriers.end ()
+         && (b->second->key.m_uid == skipUid
+             || (b->second->key.m_eventType == TIMEOUT && !useTimeout)))
+    {
+      b++;
+    }
+  EventsI barrier = (b == index.barriers.end ()) ? subList.end () : b->second;
+
+  if (barrier != start)
+    {
+      EventsI last = barrier;
+      last--;
+      if (less (ev.key, last->key))
+        {
+          EventIndex::iterator next = index.keys.upper_bound (ev.key);
+          NS_ASSERT (next != index.keys.end ());
+          Link (subList, next->second, ev);
+          return;
+        }
+    }
+
+  if (barrier == subList.end ())
+    {
+      Link (subList, subList.end (), ev);
+    }
+  else if (barrier->key.m_eventType == TIMEOUT)
+    {
+      PushPending (*barrier, ev);
+    }
+  else if (less (ev.key, barrier->key))
+    {
+      Link (subList, barrier, ev);
+    }
+  else
+    {
+      Link (subList, subList.end (), ev);
+    }
 }
 
 // First time an event is inserted into a list
 void
 ListScheduler::InsertMultiList (Events &subList, const Event &ev)
 {
+  // ev may end up in the pending list of the front event
+  if (m_useHeadHeap == true && m_useWaitingList == true)
+    {
+      MarkDirty (GetNode (subList));
+    }
+
   //if (debug)
     //{
 	  //printf ("InsertIntoSubList-1\n");  
@@ -276,13 +830,18 @@ ListScheduler::InsertMultiList (Events &subList, const Event &ev)
 
   if (m_useWaitingList == false) // Local lists without waiting lists
     {
+	  if (IsIndexed ())
+	    {
+		  InsertIndexed (subList, subList.begin (), ev, false, 0);
+		  return;
+		}
 	  if (m_usePathReduction == true)
 	    {	  
 		  for (EventsI i = subList.begin (); i != subList.end (); i++)
 			{
 			  if (InsertPathReduction (i, ev))
 				{
-				   subList.insert (i, ev);
+				   Link (subList, i, ev);
 				   //PrintDebugInfo (subList, ev.key.m_uid, i->key.m_uid);
 				   return;
 				}
@@ -291,11 +850,11 @@ ListScheduler::InsertMultiList (Events &subList, const Event &ev)
               // Thus we push ev at the end of the list.	
 			  if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 			    {
-				  subList.push_back (ev);
+				  Link (subList, subList.end (), ev);
 				  return;	
 				}	
 			}
-		  subList.push_back (ev);
+		  Link (subList, subList.end (), ev);
 		  //PrintDebugInfo (subList, ev.key.m_uid, ev.key.m_uid);
 		  return;
 		}  
@@ -304,19 +863,19 @@ ListScheduler::InsertMultiList (Events &subList, const Event &ev)
 	    {
 		  for (EventsI i = subList.begin (); i != subList.end (); i++)
 		    {
-		      if (ev.key < i->key)
+		      if (DelayExplorer::IsBefore (ev.key, i->key))
 		        {
-		          subList.insert (i, ev);
+		          Link (subList, i, ev);
 		          return;
 		        }
 		        
 		      if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 		        {
-				  subList.push_back (ev);
+				  Link (subList, subList.end (), ev);
 				  return;	
 				}    
 		    }
-		  subList.push_back (ev);
+		  Link (subList, subList.end (), ev);
 		  return;		
 	    }	
     }
@@ -334,6 +893,11 @@ void
 ListScheduler::InsertBackToMainList_FrontIsTimeout (Events &subList, const Event &ev)
 {
   Event next = subList.front ();
+  if (IsIndexed ())
+    {
+	  InsertIndexed (subList, subList.begin (), ev, true, next.key.m_uid);
+	  return;
+	}
   if (m_usePathReduction == true)
     {
 	  for (EventsI i = subList.begin (); i != subList.end (); i++)
@@ -346,7 +910,7 @@ ListScheduler::InsertBackToMainList_FrontIsTimeout (Events &subList, const Event
 		  // there will be infinite loop
 		  if (i->key.m_eventType == TIMEOUT && i->key.m_uid != next.key.m_uid)
 		    {
-			  i->pendingEvents.push_back(ev);
+			  PushPending (*i, ev);
 			  //printf ("Pushing event %u into pending list of event %u, size %lu \n", 
 			  //	           ev.key.m_uid, i->key.m_uid, i->pendingEvents.size());			  
 			  return;
@@ -354,7 +918,7 @@ ListScheduler::InsertBackToMainList_FrontIsTimeout (Events &subList, const Event
 		  // i is not a timeout event, compare timestamp		
 	      if (InsertPathReduction (i, ev))
 	        { 	
-			  subList.insert (i, ev);
+			  Link (subList, i, ev);
 			  //printf ("Inserting event %u into main list\n", ev.key.m_uid);	
               //PrintDebugInfo (ev.key.m_uid, i->key.m_uid);
 			  return;	                
@@ -362,11 +926,11 @@ ListScheduler::InsertBackToMainList_FrontIsTimeout (Events &subList, const Event
 	        
 	      if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 		    {
-			  subList.push_back (ev);
+			  Link (subList, subList.end (), ev);
 			  return;	
 			}	   
 	    }
-	  subList.push_back (ev);
+	  Link (subList, subList.end (), ev);
 	  return;
     }
     
@@ -376,25 +940,25 @@ ListScheduler::InsertBackToMainList_FrontIsTimeout (Events &subList, const Event
 	    {
 		  if (i->key.m_eventType == TIMEOUT && i->key.m_uid != next.key.m_uid)
 		    {
-			  i->pendingEvents.push_back(ev);
+			  PushPending (*i, ev);
 			  //printf ("Pushing event %u into pending list of event %u, size %lu \n", 
 			  //	           ev.key.m_uid, i->key.m_uid, i->pendingEvents.size());			  
 			  return;
 			}
 						
-	      if (ev.key < i->key)
+	      if (DelayExplorer::IsBefore (ev.key, i->key))
 	        {
-	          subList.insert (i, ev);
+	          Link (subList, i, ev);
 	          return;
 	        }
 	      
 	      if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 		    {
-			  subList.push_back (ev);
+			  Link (subList, subList.end (), ev);
 			  return;	
 			}	   
 	    }
-	  subList.push_back (ev);
+	  Link (subList, subList.end (), ev);
 	  return;		
     }
 }	
@@ -409,6 +973,12 @@ ListScheduler::InsertWaitingList (Events &subList, EventsI start, const Event &e
       //PrintDebugInfo (subList, 1, 1);
       //printf ("Inserting loop start at event id %u \n", start->key.m_uid);
     //}  
+
+  if (IsIndexed ())
+    {
+	  InsertIndexed (subList, start, ev, true, 0);
+	  return;
+	}
    
   if (m_usePathReduction == true)
     {   
@@ -417,7 +987,7 @@ ListScheduler::InsertWaitingList (Events &subList, EventsI start, const Event &e
 		  // insert to pending list of timeout event	
 		  if (i->key.m_eventType == TIMEOUT)
 		    {
-			  i->pendingEvents.push_back(ev);
+			  PushPending (*i, ev);
 			  //printf ("Pushing event %u into pending list of event %u, size %lu \n", 
 			  //	           ev.key.m_uid, i->key.m_uid, i->pendingEvents.size());			  
 			  return;
@@ -425,7 +995,7 @@ ListScheduler::InsertWaitingList (Events &subList, EventsI start, const Event &e
 		  //printf ("Current event iterator %u \n", i->key.m_uid);
 		  if (InsertPathReduction (i, ev))
 			{
-			  subList.insert (i, ev);
+			  Link (subList, i, ev);
 			  //printf ("Inserting event %u into sub list\n", ev.key.m_uid);
 			  //PrintDebugInfo (subList, ev.key.m_uid, i->key.m_uid);
 			  return;
@@ -433,11 +1003,11 @@ ListScheduler::InsertWaitingList (Events &subList, EventsI start, const Event &e
 			
 		  if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 			{
-			  subList.push_back (ev);
+			  Link (subList, subList.end (), ev);
 			  return;	
 			}				
 	    }
-	  subList.push_back (ev);
+	  Link (subList, subList.end (), ev);
 	  return;
     }
  
@@ -447,26 +1017,26 @@ ListScheduler::InsertWaitingList (Events &subList, EventsI start, const Event &e
 	    {
 		  if (i->key.m_eventType == TIMEOUT)
 		    {
-			  i->pendingEvents.push_back(ev);
+			  PushPending (*i, ev);
 			  //printf ("Pushing event %u into pending list of event %u, size %lu \n", 
 			  //	           ev.key.m_uid, i->key.m_uid, i->pendingEvents.size());			  
 			  return;
 			}
 						
-	      if (ev.key < i->key)
+	      if (DelayExplorer::IsBefore (ev.key, i->key))
 	        {
-	          subList.insert (i, ev);
+	          Link (subList, i, ev);
 	          //PrintDebugInfo (subList, ev.key.m_uid, i->key.m_uid);
 	          return;
 	        }
 	        
 	      if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 		    {
-			  subList.push_back (ev);
+			  Link (subList, subList.end (), ev);
 			  return;	
 			}  
 	    }
-	  subList.push_back (ev);
+	  Link (subList, subList.end (), ev);
 	  return;		
     }
 }			
@@ -475,75 +1045,60 @@ void
 ListScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
-  if (!m_isNodeVectorInitialized)
-    {
-	  //uint64_t inf = 100000000;	
-	  // tcp-bulk-send
-	  uint64_t impactLatencyMatrix [2][2] = {{0, 0}, 
-	                                         {0, 0}};
-	                                         	                                        	                                         
-	  // rip-simple-network
-	  //uint64_t impactLatencyMatrix [6][6] = {{0, 8, 2, 4, 4, 6}, 
-	                                         //{8, 0, 6, 4, 4, 2},
-	                                         //{2, 6, 0, 2, 2, 4},
-	                                         //{4, 4, 2, 0, 2, 2},
-	                                         //{4, 4, 2, 2, 0, 2},
-	                                         //{6, 2, 4, 2, 2, 0}};
-	                                         
-	  // simple-error-model
-	  //uint64_t impactLatencyMatrix [4][4] = {{0, inf, 2, inf}, 
-	                                         //{inf, 0, 2, 13},
-	                                         //{2, 2, 0, 11},
-	                                         //{inf, 13, 11, 0}};
-	  //uint64_t impactLatencyMatrix [4][4] = {{0, inf, 0, inf}, 
-	                                         //{inf, 0, 0, 0},
-	                                         //{0, 0, 0, 0},
-	                                         //{inf, 0, 0, 0}};                                                                                 			  
-	  m_impactLatency.resize (m_numNodes);
-	  for (unsigned i = 0; i < m_numNodes; i++)
-	    {
-		  m_impactLatency.at (i).resize (m_numNodes);
-		  for (unsigned j = 0; j < m_numNodes; j++)
-		    {
-			  m_impactLatency.at (i).at (j) = impactLatencyMatrix [i][j];	
-			}	
-		}                           	
-	  m_nodesEvents.resize (m_numNodes);
-	  m_isNodeVectorInitialized = true;	
-	}
- 	
   char buf[64];
   memset (buf, 0, sizeof(buf));
+  bool isSymbolic = false;
+  // A new event, nothing waits on it yet
+  (const_cast<Event&>(ev)).pending = 0;
 
   // Only make m_ts of transmit events symbolic
-  if (m_isTransmitEvent)
+  if (ev.impl != 0 && ev.impl->IsTransmit ())
     {
       (const_cast<Event&>(ev)).key.m_isTransEvent = true;
-      (const_cast<Event&>(ev)).key.m_packetSize = m_currPacketSize;
-      if ((m_symLink[0] == 0 && m_symLink[1] == 2) || (m_symLink[0] == 2 && m_symLink[1] == 0))
+      (const_cast<Event&>(ev)).key.m_packetSize = ev.impl->GetPacketSize ();
+      // The SymbolicInjectionPolicy selected this packet
+      if (m_injectSymbolic)
         {
-          m_packetId++;
-          //if (ev.key.m_packetSize > 58 && m_numSymEvents < 1000)
-          if (m_packetId >= m_firstSymPacket && m_numpackets > 0)
+          isSymbolic = true;
+          m_lastSymbolic.ts = ev.key.m_ts;
+          m_lastSymbolic.interval = m_symInterval;
+          m_lastSymbolic.minimum = m_symMinimum;
+          m_lastSymbolic.advance = m_symAdvance;
+          // Explored natively, the timestamp becomes a bounded variable
+          if (DelayExplorer::IsEnabled ())
+            {
+              uint64_t lo = m_symAdvance ? ev.key.m_ts - m_symInterval : ev.key.m_ts + m_symMinimum;
+              uint64_t hi = m_symAdvance ? ev.key.m_ts - m_symMinimum : ev.key.m_ts + m_symInterval;
+              (const_cast<Event&>(ev)).key.m_originalTs = lo;
+              DelayExplorer::MakeSymbolic ((const_cast<Event&>(ev)).key, lo, hi);
+            }
+          else
             {
-			  m_numpackets--;	
-              snprintf (buf, sizeof(buf), "Setting event id %u to symbolic !!!!!", ev.key.m_uid);
-              s2e_warning (buf);
-              memset (buf, 0, sizeof(buf));
               // New symbolic delay for each data packet
               uint64_t sym_ts;
               s2e_enable_forking ();
               s2e_make_symbolic (&sym_ts, sizeof(uint64_t), "Symbolic Delay");
-              if (sym_ts > m_interval)
+              // The range only constrains the path instead of forking a
+              // state to kill. The bounds are combined with & rather than
+              // &&, which would branch on the symbolic value.
+              s2e_assume ((sym_ts >= m_symMinimum) & (sym_ts <= m_symInterval));
+              // m_originalTs keeps the concrete lower bound of the timestamp
+              if (m_symAdvance)
+                {
+                  (const_cast<Event&>(ev)).key.m_originalTs = ev.key.m_ts - m_symInterval;
+                  (const_cast<Event&>(ev)).key.m_ts -= sym_ts;
+                }
+              else
                 {
-                  s2e_kill_state (0, "Out of Range");
+                  (const_cast<Event&>(ev)).key.m_originalTs = ev.key.m_ts + m_symMinimum;
+                  (const_cast<Event&>(ev)).key.m_ts += sym_ts;
                 }
-              (const_cast<Event&>(ev)).key.m_ts += sym_ts;
-              s2e_print_expression ("SymTime", ev.key.m_ts);
+              SymbolicTrace::Symbolic (SymbolicTrace::SYMBOLIC_DELAY, ev.key.m_uid,
+                                       ev.key.m_context, "SymTime", ev.key.m_ts,
+                                       ev.key.m_originalTs);
             }
+          m_lastSymbolic.key = ev.key;
         }
-	  SetSymLink (0xffffffff, 0xffffffff);  
-      SetTransmitEvent (false);
 //    printf("Event to be inserted is a transmit event \n");
     }
   else
@@ -551,23 +1106,46 @@ ListScheduler::Insert (const Event &ev)
       (const_cast<Event&>(ev)).key.m_isTransEvent = false;
       (const_cast<Event&>(ev)).key.m_packetSize = 0;
     } 
+  m_injectSymbolic = false;
+  if (m_usePathCache == true)
+    {
+      DelayExplorer::AddScheduled (ev.key);
+    }
   //snprintf (buf, sizeof(buf), "New event %u to be inserted", ev.key.m_uid);
   //s2e_warning (buf);
   //memset (buf, 0, sizeof(buf));
 
-  const_cast<Event&>(ev).key.m_eventType = m_currEventType;
-  SetEventType (UNDEFINED);
-  
+  // Keep symbolic events out of the lists until they may be the next one
+  if (m_useSymbolicWindow == true && isSymbolic)
+    {
+      m_symWindow.push_back (ev);
+      return;
+    }
+
+  InsertIntoLists (ev);
+}
+
+void
+ListScheduler::InsertIntoLists (const Event &ev)
+{
   // Insert events into right list if local lists are used  
   if (m_useLocalList == true)
     {
+	  uint32_t node = GetListNode (ev.key);
+	  if (m_useLocalListv2 == true && node < m_nodes.size ())
+	    {
+	      // a waiting node may be ready with an event in its list
+	      SetWaiting (node, false);
+	    }
 	  if (m_useLocalListv2 == true && ev.key.m_eventType == OUTGOING)
 	    {
+		  AddNodeList (ev.key.m_prevContext);
 		  InsertMultiList (m_nodesEvents.at (ev.key.m_prevContext), ev);
 		  return;
 		}	
       if (ev.key.m_context != 0xffffffff)
 	    {
+	      AddNodeList (ev.key.m_context);
 	      InsertMultiList (m_nodesEvents.at (ev.key.m_context), ev);
 	      return;	
 	    }
@@ -585,6 +1163,13 @@ ListScheduler::Insert (const Event &ev)
 	  return;	
 	}
 	
+  // No waiting list or local list used but indexed
+  if (IsIndexed ())
+    {
+	  InsertIndexed (m_events, m_events.begin (), ev, false, 0);
+	  return;
+	}
+
   // No waiting list or local list used but with path reduction	
   if (m_usePathReduction == true)
     {
@@ -592,17 +1177,17 @@ ListScheduler::Insert (const Event &ev)
 	    {
 		  if (InsertPathReduction (i, ev))
 		    {
-			  m_events.insert (i, ev);
+			  Link (m_events, i, ev);
 			  return;	
 			}			
 		  // use end of simulation	
 		  if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 		    {
-			  m_events.push_back (ev);
+			  Link (m_events, m_events.end (), ev);
 			  return;	
 			}		
 		}
-	  m_events.push_back (ev);
+	  Link (m_events, m_events.end (), ev);
 	  return;		
     }
   
@@ -611,19 +1196,19 @@ ListScheduler::Insert (const Event &ev)
     //{
 	  for (EventsI i = m_events.begin (); i != m_events.end (); i++)
 	    {
-		  if (ev.key < i->key)
+		  if (DelayExplorer::IsBefore (ev.key, i->key))
 		    {
-			  m_events.insert (i, ev);
+			  Link (m_events, i, ev);
 			  return;	
 			}
 		  // use end of simulation	
 		  if (m_useEndOfSim == true && i->key.m_eventType == STOP)
 		    {
-			  m_events.push_back (ev);
+			  Link (m_events, m_events.end (), ev);
 			  return;	
 			}		
 		}
-	  m_events.push_back (ev);
+	  Link (m_events, m_events.end (), ev);
 	  return;		
 	//}  	 
 
@@ -636,12 +1221,23 @@ bool
 ListScheduler::IsEmpty (void) const
 {
   NS_LOG_FUNCTION (this);
-  
+  return m_symWindow.empty () && IsListsEmpty ();
+}
+
+bool
+ListScheduler::IsListsEmpty (void) const
+{
   // Check all lists
   if (!m_simEvents.empty ())
     {
 	  return false;
 	}
+
+  if (m_useHeadHeap == true)
+    {
+      uint32_t node;
+      return m_events.empty () && !PeekHead (node);
+    }
   
   for (unsigned j = 0; j < m_nodesEvents.size (); j++)
     {
@@ -665,6 +1261,44 @@ Scheduler::Event
 ListScheduler::PeekNext (void) const
 {
   NS_LOG_FUNCTION (this);
+  Event next = PeekNextOrdered ();
+  DelayExplorer::Resolve (next.key);
+  return next;
+}
+
+Scheduler::Event
+ListScheduler::PeekNextOrdered (void) const
+{
+  if (m_useSymbolicWindow == false || m_symWindow.empty ())
+    {
+      return PeekNextFromLists ();
+    }
+
+  // Symbolic events are not ordered yet, report the one with the
+  // smallest lower bound if it may run before the next listed event
+  Event next = m_symWindow.front ();
+  for (Events::const_iterator i = m_symWindow.begin (); i != m_symWindow.end (); i++)
+    {
+      if (i->key.m_originalTs < next.key.m_originalTs)
+        {
+          next = *i;
+        }
+    }
+  if (IsListsEmpty ())
+    {
+      return next;
+    }
+  Event listed = PeekNextFromLists ();
+  if (next.key.m_originalTs <= listed.key.m_ts)
+    {
+      return next;
+    }
+  return listed;
+}
+
+Scheduler::Event
+ListScheduler::PeekNextFromLists (void) const
+{
 //  printf ("PeekNext-1-Start \n");
   
   Event next;
@@ -678,13 +1312,24 @@ ListScheduler::PeekNext (void) const
 	    {
 		  next = m_simEvents.front();	
 	    }	
+
+	  uint32_t node;
+	  if (m_useHeadHeap == true)
+	    {
+	      if (PeekHead (node) && (m_simEvents.empty ()
+	          || DelayExplorer::PeekBefore (m_nodesEvents.at (node).front ().key, 0, next.key, false)))
+	        {
+	          next = m_nodesEvents.at (node).front ();
+	        }
+	      return next;
+	    }
 	  
 	  for (unsigned j = 0; j < m_nodesEvents.size(); j++)
 	    {
 	      if (!(m_nodesEvents.at(j)).empty())
 	      {
 		    i = (m_nodesEvents.at(j)).front ();
-		    if (next.key.m_ts > i.key.m_ts)
+		    if (DelayExplorer::PeekBefore (i.key, 0, next.key, false))
 		    {
 		      next = i; 	   
 		    }	  	
@@ -717,11 +1362,11 @@ ListScheduler::CheckFrontEvent (Events &subList)
 	  
   EventsI nextI = subList.begin ();
 	
-  if (!nextI->pendingEvents.empty ()) // pending list is not empty, should be a timeout event
+  if (nextI->pending != 0) // pending list is not empty, should be a timeout event
     {
       NS_ASSERT (nextI->key.m_eventType == TIMEOUT);
 
-	  uint64_t size = nextI->pendingEvents.size();	
+	  uint64_t size = GetPendingSize (*nextI);	
 	  // insert events in pending list into main list until the next timeout event
 	  // use for instead of while because of infinite loop
 	  // when a pending event is poped and pushed into the same pending list infinitely
@@ -730,8 +1375,7 @@ ListScheduler::CheckFrontEvent (Events &subList)
 		  //printf ("-RemoveNext-2-Whileloop \n");
 		  //printf ("-next event id %u pending list in RemoveNext---", nextI->key.m_uid);
 		  //PrintDebugInfo (nextI->pendingEvents, 1, 1);	
-          Event ev = nextI->pendingEvents.front ();
-	      nextI->pendingEvents.pop_front();
+          Event ev = PopPending (*nextI);
 	      //printf ("About to insert event id %u- %lu ms to main list \n",
 		  //         ev.key.m_uid, ev.key.m_ts);
 	      InsertBackToMainList_FrontIsTimeout (subList, ev);		      		      	
@@ -745,37 +1389,111 @@ ListScheduler::CheckFrontEvent (Events &subList)
 	//}	      	
 }
 
+void
+ListScheduler::SetWaiting (uint32_t nodeID, bool waiting)
+{
+  Scheduler::Node &node = m_nodes.at (nodeID);
+  if (node.m_isWaiting != waiting)
+    {
+      node.m_isWaiting = waiting;
+      if (waiting)
+        {
+          m_waitingNodes++;
+          m_readyNodes.erase (nodeID);
+        }
+      else
+        {
+          m_waitingNodes--;
+          m_readyNodes.insert (nodeID);
+        }
+    }
+}
+
 bool
 ListScheduler::IsDeadLock ()
 {
-  for (unsigned i = 0; i < m_nodes.size (); i++)
+  return m_waitingNodes == m_nodes.size ();
+}
+
+uint32_t
+ListScheduler::GetDeadLocks (void)
+{
+  return m_deadLocks;
+}
+
+void
+ListScheduler::ForwardOutgoing (uint32_t nodeID)
+{
+  Event next = m_nodesEvents.at (nodeID).front ();
+  NS_ASSERT_MSG (nodeID == next.key.m_prevContext,
+                 "ListScheduler: OUTGOING event " << next.key.m_uid << " of node "
+                 << next.key.m_prevContext << " in the list of node " << nodeID);
+  uint32_t interface = GetInterface (next.key.m_prevContext, next.key.m_context);
+  Scheduler::Node &dest = m_nodes.at (next.key.m_context);
+  if (dest.m_inPackets.at (interface)++ == 0)
     {
-	  if (m_nodes.at (i).m_isWaiting == false)
-	    {
-		  return false;	
-		}	
-	}
-  return true;		
+      dest.m_emptyInterfaces--;
+    }
+  Unlink (m_nodesEvents.at (nodeID), m_nodesEvents.at (nodeID).begin ());
+  next.key.m_eventType = INCOMING;
+  AddNodeList (next.key.m_context);
+  InsertMultiList (m_nodesEvents.at (next.key.m_context), next);
+  // the packet may be the one the destination waited for
+  SetWaiting (next.key.m_context, false);
+  // the packet may be in the pending list of a TIMEOUT now at the front,
+  // and the front of the sender may be one
+  if (m_useWaitingList == true)
+    {
+      Events &from = m_nodesEvents.at (nodeID);
+      Events &to = m_nodesEvents.at (next.key.m_context);
+      if (!from.empty () && from.begin ()->pending != 0)
+        {
+          CheckFrontEvent (from);
+        }
+      if (to.begin ()->pending != 0)
+        {
+          CheckFrontEvent (to);
+        }
+    }
+}
+
+bool
+ListScheduler::GetEarliestNode (uint32_t &node)
+{
+  // the heap does not order symbolic timestamps
+  if (KeepsHeads () && !DelayExplorer::IsEnabled ())
+    {
+      return PeekHead (node);
+    }
+  bool found = false;
+  for (uint32_t j = 0; j < m_nodesEvents.size (); j++)
+    {
+      if (!m_nodesEvents.at (j).empty ()
+          && (!found || DelayExplorer::IsBefore (m_nodesEvents.at (j).front ().key,
+                                                 m_nodesEvents.at (node).front ().key)))
+        {
+          node = j;
+          found = true;
+        }
+    }
+  return found;
 }
 
 void
 ListScheduler::DecrementInPacket (const Event &ev)
 {
   uint32_t interface = GetInterface (ev.key.m_prevContext, ev.key.m_context);
-  m_nodes.at (ev.key.m_context).m_inPackets.at (interface) -= 1; 	
+  Scheduler::Node &node = m_nodes.at (ev.key.m_context);
+  if (--node.m_inPackets.at (interface) == 0)
+    {
+      node.m_emptyInterfaces++;
+    }
 }
 
 bool
 ListScheduler::HasIncomingOnAllInterfaces (uint32_t nodeID)
 {
-  for (unsigned i = 0; i < m_nodes.at (nodeID).m_inPackets.size (); i++)
-    {
-	  if (m_nodes.at (nodeID).m_inPackets.at (i) == 0)
-	    {
-		  return false;	
-		}	
-	}
-  return true;		
+  return m_nodes.at (nodeID).m_emptyInterfaces == 0;
 }
 
 uint32_t
@@ -793,22 +1511,64 @@ ListScheduler::GetInterface (uint32_t src, uint32_t dst)
   return interface;		
 }
 
-Scheduler::Event
-ListScheduler::RemoveNextLocalList (void)
+bool
+ListScheduler::IsEligible (uint32_t node)
+{
+  Scheduler::EventKey key = m_nodesEvents.at (node).front ().key;
+  if (key.m_eventType == STOP)
+    {
+      return false;
+    }
+  // Compare it to the front event of other node lists
+  for (unsigned j = 0; j < m_nodesEvents.size (); j++)
+    {
+      if (node != j && !m_nodesEvents.at (j). empty ()
+          && DelayExplorer::IsBefore (m_nodesEvents.at (j).front ().key, GetImpactLatency (node, j),
+                                      key, false))
+      //if  (node != j && !m_nodesEvents.at (j). empty ()
+           //&& !InsertPathReduction (m_nodesEvents.at (j).begin (), next))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+ListScheduler::Events &
+ListScheduler::SelectNextLocalList (uint32_t &turn)
 {
+  UpdateImpactLatency ();
   // If using waiting list, first check if any front event is timeout one
   // If there is, extract events from its waiting list
   if (m_useWaitingList == true) // local lists and waiting lists
     {
-	  if (!m_simEvents.empty () && !m_simEvents.begin ()->pendingEvents.empty())
+	  if (!m_simEvents.empty () && m_simEvents.begin ()->pending != 0)
 	    {	
 	      CheckFrontEvent (m_simEvents);
 	    }  
-	  for (unsigned i = 0; i < m_nodesEvents.size(); i++)
+	  if (m_useHeadHeap == true)
+	    {
+	      // Only the node lists whose front changed or got a pending event
+	      std::vector<uint32_t> dirtyNodes;
+	      dirtyNodes.swap (m_dirtyNodes);
+	      for (unsigned i = 0; i < dirtyNodes.size (); i++)
+	        {
+	          uint32_t node = dirtyNodes.at (i);
+	          m_isNodeDirty.at (node) = false;
+	          if (!m_nodesEvents.at (node).empty () && m_nodesEvents.at (node).begin ()->pending != 0)
+	            {
+	              CheckFrontEvent (m_nodesEvents.at (node));
+	            }
+	        }
+	    }
+	  else
 	    {
-		  if (!m_nodesEvents.at (i).empty () && !m_nodesEvents.at (i).begin ()->pendingEvents.empty())
-		    {	
-		      CheckFrontEvent (m_nodesEvents.at (i));	
+	      for (unsigned i = 0; i < m_nodesEvents.size(); i++)
+	        {
+		      if (!m_nodesEvents.at (i).empty () && m_nodesEvents.at (i).begin ()->pending != 0)
+		        {	
+		          CheckFrontEvent (m_nodesEvents.at (i));	
+		        }
 		    }
 		}
 	}
@@ -822,7 +1582,17 @@ ListScheduler::RemoveNextLocalList (void)
 	  next = m_simEvents.front();
 	  //printf ("Front simulator event id %u - %lu ms - node %u\n",
 	  //        next.key.m_uid, next.key.m_ts, next.key.m_context);	
-	  for (unsigned i = 0; i < m_nodesEvents.size (); i++)
+	  // same condition as the loop below, against the earliest node event
+	  // only; the heap does not order symbolic timestamps, the DelayExplorer
+	  // needs the loop
+	  bool useHeadHeap = m_useHeadHeap == true && !DelayExplorer::IsEnabled ();
+	  uint32_t node;
+	  if (useHeadHeap && PeekHead (node)
+	      && DelayExplorer::IsBefore (m_nodesEvents.at (node).front ().key, next.key))
+	    {
+	      foundNext = false;
+	    }
+	  for (unsigned i = 0; i < m_nodesEvents.size () && !useHeadHeap; i++)
 	    {
 		  // simulator events have impact latency of 0 to other nodes
 		  if (!m_nodesEvents.at (i).empty ())
@@ -830,7 +1600,7 @@ ListScheduler::RemoveNextLocalList (void)
 			  // if simulator event id is smaller	
 		      if (next.key.m_uid < m_nodesEvents.at (i).front ().key.m_uid)
 		        {	
-		          if (next.key.m_ts > m_nodesEvents.at (i).front ().key.m_ts)
+		          if (DelayExplorer::IsBefore (m_nodesEvents.at (i).front ().key, 0, next.key, false))
 		            {
 			          //if (debug)
 			            //{	
@@ -844,7 +1614,7 @@ ListScheduler::RemoveNextLocalList (void)
 			    }
 			  else // simulator event id is larger thus its timestamp must be strictly lesser
 			    {
-				  if (next.key.m_ts >= m_nodesEvents.at (i).front ().key.m_ts)
+				  if (DelayExplorer::IsBefore (m_nodesEvents.at (i).front ().key, 0, next.key, true))
 				    {
 					  foundNext = false;
 					  break;	 
@@ -858,190 +1628,294 @@ ListScheduler::RemoveNextLocalList (void)
     {
       //printf ("Removing next simulator event: %u - %llu ms \n", next.key.m_uid, next.key.m_ts);
       //PrintDebugInfo (m_simEvents, 1, 1);
-      m_simEvents.pop_front ();
-      return next;
+      return m_simEvents;
     }
     
-  if (m_useLocalListv2 == true)
+  if (m_useLocalListv2 == true && !m_nodes.empty ())
   {   
     uint32_t nodeID = 0;
+    // A waiting node only gets ready when an event is inserted in its
+    // list or a packet arrives, which clears its flag, so only the nodes
+    // not waiting are tried, in turn from node 0, and a deadlock left by
+    // the previous call is still one
     while (true)
       {
-		//front event at this node can safely execute  
-		if (HasIncomingOnAllInterfaces (nodeID))
-		  {
-			m_nodes.at (nodeID).m_isWaiting = false;
-			next = m_nodesEvents.at (nodeID).front ();
-			if (next.key.m_eventType == OUTGOING)
-			  {
-				if (nodeID != next.key.m_prevContext)
-				  {
-				    printf ("Error: Local list v2 !!!!!!!!");
-				  }  
-				uint32_t interface = GetInterface (next.key.m_prevContext, next.key.m_context);
-				m_nodes.at (next.key.m_context).m_inPackets.at (interface) += 1;
-				m_nodesEvents.at (nodeID).pop_front ();
-				next.key.m_eventType = INCOMING;
-				InsertMultiList (m_nodesEvents.at (next.key.m_context), next);
-				m_nodes.at (next.key.m_context).m_isWaiting = false;  
-			  }
-			else
-			  {
-				m_nodesEvents.at (nodeID).pop_front ();
-				return next;  
-			  }    
-		  }
-		//set current nodes to wait status and move to next node 
-		//check if there is deadlock  
-		else
-		  {
-			m_nodes.at (nodeID).m_isWaiting = true;
-			nodeID = (nodeID + 1) % m_nodes.size ();
-			if (IsDeadLock ())
-			  {
-				break;  
-			  }  
-		  }    
+        while (!IsDeadLock ())
+          {
+            std::set<uint32_t>::const_iterator ready = m_readyNodes.lower_bound (nodeID);
+            nodeID = ready != m_readyNodes.end () ? *ready : *m_readyNodes.begin ();
+		    //front event at this node can safely execute  
+		    if (HasIncomingOnAllInterfaces (nodeID) && nodeID < m_nodesEvents.size ()
+		        && !m_nodesEvents.at (nodeID).empty ())
+		      {
+			    m_inDeadLock = false;
+			    if (m_nodesEvents.at (nodeID).front ().key.m_eventType == OUTGOING)
+			      {
+				    ForwardOutgoing (nodeID);
+			      }
+			    else
+			      {
+				    return m_nodesEvents.at (nodeID);
+			      }    
+		      }
+		    //set current node to wait status and move to next node 
+		    else
+		      {
+			    SetWaiting (nodeID, true);
+			    nodeID = (nodeID + 1) % m_nodes.size ();
+		      }    
+	      }
+	    // Deadlock: every node waits for a packet on one of its interfaces.
+	    // The earliest node event is safe, no other event can precede it:
+	    // a packet is forwarded to its destination, any other event runs.
+	    if (!m_inDeadLock)
+	      {
+	        m_inDeadLock = true;
+	        m_deadLocks++;
+	        NS_LOG_LOGIC ("deadlock " << m_deadLocks << ", every node waits for a packet");
+	      }
+	    uint32_t safe;
+	    if (!GetEarliestNode (safe))
+	      {
+	        break;
+	      }
+	    if (m_nodesEvents.at (safe).front ().key.m_eventType == OUTGOING)
+	      {
+	        ForwardOutgoing (safe);
+	        continue;
+	      }
+	    return m_nodesEvents.at (safe);
 	  }
   }    
     
 // Next eligible event is in one of the node lists  
+  // With the head heap, a node whose front event is after the earliest
+  // node event plus the impact latency between them is not eligible: the
+  // nodes are still tried in turn, but most of them without a scan
+  uint32_t first;
+  bool hasFirst = m_useHeadHeap == true && PeekHead (first);
+  uint32_t curr = m_currNode;
+  Events *last = 0;
   for (unsigned i = 0; i < m_nodesEvents.size (); i++)
     {
-	  foundNext = true;	
-      if (!m_nodesEvents.at (m_currNode).empty ())
+      if (!m_nodesEvents.at (curr).empty ())
         {
-		  next = m_nodesEvents.at (m_currNode).front ();
-		  // Pick the front event of a non-empty node list
-		  // Compare it to the front event of other node lists
-		  for (unsigned j = 0; j < m_nodesEvents.size (); j++)
-		    {
-			  if (next.key.m_eventType == STOP)
-			    {
-				  foundNext = false;
-				  break;	
-				}		
-			  if (m_currNode != j && !m_nodesEvents.at (j). empty ()
-			      && next.key.m_ts > m_nodesEvents.at (j).front ().key.m_ts + m_impactLatency.at (m_currNode).at (j))
-			  //if  (m_currNode != j && !m_nodesEvents.at (j). empty ()
-			       //&& !InsertPathReduction (m_nodesEvents.at (j).begin (), next))    
-			    {
-				  foundNext = false;
-				  break;	
-				}    	
-			}
-		  if (foundNext)
+		  last = &m_nodesEvents.at (curr);
+		  next = m_nodesEvents.at (curr).front ();
+		  if (next.key.m_eventType != STOP
+		      && (!hasFirst || first == curr
+		       || !DelayExplorer::IsBefore (m_nodesEvents.at (first).front ().key,
+		                                    GetImpactLatency (curr, first), next.key, false))
+		      && IsEligible (curr))
 		    {
 			  //printf ("Removing next event: %u - %llu ms, i = %u \n", next.key.m_uid, next.key.m_ts, i);
 			  //printf ("Node list %u size %lu", i, m_nodesEvents.at (i).size ());
-			  m_nodesEvents.at (m_currNode).pop_front ();
-			  m_currNode = (m_currNode + 1) % m_nodesEvents.size();	
-			  return next;	
+			  turn = curr;
+			  return m_nodesEvents.at (curr);
 			}		
 		}
-	  m_currNode = (m_currNode + 1) % m_nodesEvents.size();	  	 	
+	  curr = (curr + 1) % m_nodesEvents.size();	  	 	
 	}
   	  	 		 	    
   //printf ("Error: Shoud not reach this statement \n");
-  return next;
+  NS_ASSERT (last != 0);
+  return *last;
 }
 
 Scheduler::Event
 ListScheduler::RemoveNext (void)
 {
   NS_LOG_FUNCTION (this);
-  
-  Event next;
+  Event next = RemoveNextOrdered ();
+  if (m_usePathCache == true)
+    {
+      DelayExplorer::RemoveScheduled (next.key);
+    }
+  // the event runs now, its timestamp is fixed for the rest of the path
+  DelayExplorer::Concretise (next.key);
+  if (m_usePathCache == true)
+    {
+      // a merged path is ended by the simulator, once back in its loop
+      DelayExplorer::Visit (next.key);
+    }
+  return next;
+}
+
+// An event leaves the scheduler without being executed
+void
+ListScheduler::Drop (const Scheduler::EventKey &key)
+{
+  if (m_usePathCache == true)
+    {
+      DelayExplorer::RemoveScheduled (key);
+    }
+  // it is not compared again
+  DelayExplorer::Forget (key);
+}
+
+Scheduler::Event
+ListScheduler::RemoveNextOrdered (void)
+{
+  if (m_useSymbolicWindow == false || m_symWindow.empty ())
+    {
+      return RemoveNextFromLists ();
+    }
+
+  while (true)
+    {
+      // Only the symbolic events left, all of them may be next
+      if (IsListsEmpty ())
+        {
+          ReleaseSymbolicWindow (0, 0xffffffff, true);
+          continue;
+        }
+      // A symbolic event may only run before next if its concrete lower
+      // bound does not exceed next's timestamp. Next stays in its list
+      // while the lists order them.
+      uint32_t turn;
+      Events &subList = SelectNextFromLists (turn);
+      if (!ReleaseSymbolicWindow (subList.front ().key.m_ts, GetNode (subList), false))
+        {
+          return RemoveFront (subList, turn);
+        }
+    }
+}
+
+// Move into the lists the symbolic events that could run before the
+// next event, at ts in the list of node
+bool
+ListScheduler::ReleaseSymbolicWindow (uint64_t ts, uint32_t node, bool all)
+{
+  bool released = false;
+  EventsI i = m_symWindow.begin ();
+  while (i != m_symWindow.end ())
+    {
+      uint64_t limit = ts;
+      uint32_t evNode = GetListNode (i->key);
+      if (node != 0xffffffff && evNode != 0xffffffff)
+        {
+          // a node v2 runs its front event whatever its timestamp, else
+          // an event may run before the front event of another node up
+          // to the impact latency between them
+          limit = m_useLocalListv2 == true && !m_nodes.empty () ?
+            std::numeric_limits<uint64_t>::max () :
+            ts + std::min (GetImpactLatency (evNode, node), std::numeric_limits<uint64_t>::max () - ts);
+        }
+      if (all || i->key.m_originalTs <= limit)
+        {
+          Event ev = *i;
+          i = m_symWindow.erase (i);
+          InsertIntoLists (ev);
+          released = true;
+        }
+      else
+        {
+          i++;
+        }
+    }
+  return released;
+}
+
+ListScheduler::Events &
+ListScheduler::SelectNextFromLists (uint32_t &turn)
+{
+  turn = 0xffffffff;
   if (m_useLocalList == true)
     {
-	  next = RemoveNextLocalList ();
-	  return next; 	
+	  return SelectNextLocalList (turn);
 	}
 	
   if (m_useWaitingList == true)
     {
 	  CheckFrontEvent (m_events);
-	  next = m_events.front ();
-	  m_events.pop_front ();
-	  return next;	
 	}
+  return m_events;
+}
 
-  //if (m_useWaitingList == false)
-    //{
-	  next = m_events.front ();
-	  m_events.pop_front ();
-	  return next;			
-	//}		
+Scheduler::Event
+ListScheduler::RemoveFront (Events &subList, uint32_t turn)
+{
+  Event next = subList.front ();
+  Unlink (subList, subList.begin ());
+  if (turn != 0xffffffff)
+    {
+      // the local lists try the next node first next time
+      m_currNode = (turn + 1) % m_nodesEvents.size ();
+    }
+  return next;
+}
 
-  //printf ("Error: Should not reach this statement \n");
-  //return next;  
+Scheduler::Event
+ListScheduler::RemoveNextFromLists (void)
+{
+  uint32_t turn;
+  Events &subList = SelectNextFromLists (turn);
+  return RemoveFront (subList, turn);
 }
 
 void
 ListScheduler::RemoveWaitingList (Events &subList, const Event &ev)
 {
   // Event to be removed is intially in the main list	
-  for (EventsI i = subList.begin (); i != subList.end (); i++)
+  EventsI i = Find (subList, ev);
+  if (i != subList.end ())
     {		
-      if (i->key.m_uid == ev.key.m_uid)
+      NS_ASSERT (ev.impl == i->impl);
+      //NS_ASSERT (i->key.m_eventType == TIMEOUT);
+              
+      while (i->pending != 0)
         {
-          NS_ASSERT (ev.impl == i->impl);
-          //NS_ASSERT (i->key.m_eventType == TIMEOUT);
-                  
-          while (!i->pendingEvents.empty ())
-            {
-			  //printf ("Remove-1, i id %u - %lu ms, pending list size %lu \n",
-			  //        i->key.m_uid, i->key.m_ts, i->pendingEvents.size());
-			  //if (debug)
-			  //{        
-			    //printf ("-next pending list in Remove---");
-		        //PrintDebugInfo (i->pendingEvents, 1, 1);
-		      //}        	
-		      Event pendingEv = i->pendingEvents.front ();
-		      i->pendingEvents.pop_front ();
-		      // Event ev is removed, insert pending events from ev++
-		      // Do not need to compare pendingEv with ev
-		      for (EventsI j = subList.begin (); j != subList.end (); j++)
-		        {
-				  if (j->key.m_uid == ev.key.m_uid)
-				    {
-					  j++;
-					  InsertWaitingList (subList, j, pendingEv);
-					  break;	
-					}	  
-		        }	  		      
-		      //printf ("i id %u - %lu ms \n", i->key.m_uid, i->key.m_ts);
-		      //printf ("i id %u - %lu ms, pending list size %lu \n", 
-		      //        i->key.m_uid, i->key.m_ts, i->pendingEvents.size());	        
-		    }	
-          
-          subList.erase (i);
-          //printf ("Finish Removing cancelled event: %u, time: %lu \n", i->key.m_uid, i->key.m_ts);
-          return;
-        }
+		  //printf ("Remove-1, i id %u - %lu ms, pending list size %lu \n",
+		  //        i->key.m_uid, i->key.m_ts, i->pendingEvents.size());
+		  //if (debug)
+		  //{        
+		    //printf ("-next pending list in Remove---");
+	        //PrintDebugInfo (i->pendingEvents, 1, 1);
+	      //}        	
+	      Event pendingEv = PopPending (*i);
+	      // Event ev is removed, insert pending events from ev++
+	      // Do not need to compare pendingEv with ev
+	      EventsI j = i;
+	      j++;
+	      InsertWaitingList (subList, j, pendingEv);
+	      //printf ("i id %u - %lu ms \n", i->key.m_uid, i->key.m_ts);
+	      //printf ("i id %u - %lu ms, pending list size %lu \n", 
+	      //        i->key.m_uid, i->key.m_ts, i->pendingEvents.size());	        
+	    }	
+      
+      Unlink (subList, i);
+      //printf ("Finish Removing cancelled event: %u, time: %lu \n", i->key.m_uid, i->key.m_ts);
+      return;
     }
     
   // Event to be removed is initially not in the main list
-  for (EventsI i = subList.begin (); i != subList.end (); i++)
+  if (IsIndexed ())
+    {
+	  // Only TIMEOUT events have waiting lists
+	  IndexedList &index = GetIndex (subList);
+	  for (EventIndex::iterator b = index.barriers.begin (); b != index.barriers.end (); b++)
+	    {
+		  if (ErasePending (*b->second, ev.key.m_uid))
+		    {
+			  return;
+			}
+		}
+	  return;
+	}
+
+  for (i = subList.begin (); i != subList.end (); i++)
     {
 	  // Event to be removed is just inserted into main list by above loop
 	  // Todo: check whether this if is redundant  
 	  if (i->key.m_uid == ev.key.m_uid)
 		{
-		  subList.erase (i);
+		  Unlink (subList, i);
 		  return;  
 		}
 	  // Event to be removed is in some waiting list  
-	  if (!i->pendingEvents.empty())
+	  if (i->pending != 0 && ErasePending (*i, ev.key.m_uid))
 		{
-		  for (EventsI j = i->pendingEvents.begin (); j != i->pendingEvents.end(); j++)
-		    {
-			  if (j->key.m_uid == ev.key.m_uid)
-			    {
-			  	  i->pendingEvents.erase(j); 
-				  return; 
-				}	    
-			}	    
+		  return; 
 		}	   	    
 	}
 }
@@ -1057,15 +1931,13 @@ ListScheduler::RemoveLocalList (Events &subList, const Event &ev)
 
   if (m_useWaitingList == false)		
     {	
-	  for (EventsI i = subList.begin (); i != subList.end (); i++)
+	  EventsI i = Find (subList, ev);
+	  if (i != subList.end ())
 	    {
-	      if (i->key.m_uid == ev.key.m_uid)
-	        {
-	          NS_ASSERT (ev.impl == i->impl);
-	          subList.erase (i);
-	          //printf ("Removing event: %u, time: %lu \n", ev.key.m_uid, ev.key.m_ts);
-	          return;
-	        }
+	      NS_ASSERT (ev.impl == i->impl);
+	      Unlink (subList, i);
+	      //printf ("Removing event: %u, time: %lu \n", ev.key.m_uid, ev.key.m_ts);
+	      return;
 	    }
     }  
 }
@@ -1074,12 +1946,26 @@ void
 ListScheduler::Remove (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
+  Drop (ev.key);
+
+  if (m_useSymbolicWindow == true)
+    {
+      for (EventsI i = m_symWindow.begin (); i != m_symWindow.end (); i++)
+        {
+          if (i->key.m_uid == ev.key.m_uid)
+            {
+              m_symWindow.erase (i);
+              return;
+            }
+        }
+    }
   
   // Local lists are used, remove the event from the corresponding local list
   if (m_useLocalList == true)
     {
 	  if (ev.key.m_context != 0xffffffff)
 	    {	  		
+		  AddNodeList (ev.key.m_context);
 		  RemoveLocalList (m_nodesEvents.at (ev.key.m_context), ev);
 		  return;	
 		}
@@ -1100,14 +1986,12 @@ ListScheduler::Remove (const Event &ev)
   // At this point, local lists and waiting lists are not used
   //if (m_useWaitingList == false)
     //{
-	  for (EventsI i = m_events.begin (); i != m_events.end (); i++)
+	  EventsI i = Find (m_events, ev);
+	  if (i != m_events.end ())
 		{
-		  if (i->key.m_uid == ev.key.m_uid)
-			{
-			  NS_ASSERT (ev.impl == i->impl);
-			  m_events.erase (i);
-			  return;
-			}
+		  NS_ASSERT (ev.impl == i->impl);
+		  Unlink (m_events, i);
+		  return;
 		}
 	//}  
      
@@ -1118,10 +2002,36 @@ uint32_t
 ListScheduler::RemoveAll (uint32_t context)
 {
   uint32_t num = 0;	
+  EventsI i = m_symWindow.begin ();
+  while (i != m_symWindow.end ())
+    {
+      if (i->key.m_context == context)
+        {
+          Drop (i->key);
+          i->impl->Unref ();
+          i = m_symWindow.erase (i);
+          num++;
+        }
+      else
+        {
+          i++;
+        }
+    }
+  AddNodeList (context);
   while (!m_nodesEvents.at (context). empty())
     {
-	  Event ev = m_nodesEvents.at (context).front ();
-	  m_nodesEvents.at (context).pop_front ();
+	  // The events waiting on it are dropped with it
+	  Event &front = m_nodesEvents.at (context).front ();
+	  while (front.pending != 0)
+	    {
+	      Event pending = PopPending (front);
+	      Drop (pending.key);
+	      pending.impl->Unref ();
+	      num++;
+	    }
+	  Event ev = front;
+	  Drop (ev.key);
+	  Unlink (m_nodesEvents.at (context), m_nodesEvents.at (context).begin ());
 	  ev.impl->Unref ();
 	  num++;	
 	}
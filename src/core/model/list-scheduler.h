@@ -23,6 +23,10 @@
 
 #include "scheduler.h"
 #include <list>
+#include <ostream>
+#include <string>
+#include <map>
+#include <set>
 #include <utility>
 #include <stdint.h>
 
@@ -42,6 +46,58 @@ class EventImpl;
  *
  * This class implements an event scheduler using an std::list
  * data structure, that is, a double linked-list.
+ *
+ * When indexed lists are enabled (SetIndexedList), every list is
+ * shadowed by a std::multimap from event keys to list positions, so that
+ * the insertion point, the pending list of a TIMEOUT event and the
+ * end-of-simulation STOP event are found in O(log n) instead of by
+ * walking the list from its front. The indexed and waiting list modes
+ * cannot change while a scheduler holds events, which were linked and
+ * indexed with the previous modes.
+ *
+ * When the head heap is enabled as well as local lists (SetHeadHeap), the
+ * fronts of the node lists are kept in a lazily updated binary min-heap,
+ * so that PeekNext does not scan every node list. RemoveNext still tries
+ * the nodes in turn, in the impact latency order of the local lists, but
+ * a node whose front event is after the earliest node event plus the
+ * impact latency between them is ruled out without comparing it to every
+ * other node.
+ *
+ * When the symbolic window is enabled (SetSymbolicWindow), events whose
+ * timestamp has been made symbolic are kept in an unordered bucket rather
+ * than inserted by comparing them with every event on the way. An event
+ * of the bucket is only moved into the lists, and compared, once its
+ * concrete lower bound (the timestamp before the symbolic delay was added)
+ * does not exceed the timestamp of the next event to run, plus the impact
+ * latency between their nodes with local lists. The next event stays in
+ * its list meanwhile, so the lists and the turn of the nodes are as if
+ * the event had been in the lists all along.
+ *
+ * With local lists v2, a node runs its front event once a packet is
+ * waiting on each of its interfaces. The nodes not known to wait are kept
+ * in id order, a node being woken when an event is inserted in its list
+ * or a packet reaches it, so the next ready node is found without
+ * scanning the waiting ones and a deadlock, every node waiting, is
+ * detected in O(1). It is resolved from the earliest front event of the
+ * node lists, taken from the head heap, which local lists v2 keep up to
+ * date even without SetHeadHeap: a packet is forwarded to its
+ * destination, any other event runs, until a node is ready again. Each
+ * deadlock is counted once (GetDeadLocks).
+ *
+ * When the DelayExplorer is enabled, symbolic timestamps are bounded
+ * variables of the explorer instead of S2E values, and every timestamp
+ * comparison of the insertion and removal loops goes through
+ * DelayExplorer::IsBefore, which may fork. The forks are never taken
+ * inside a container: the indexes are bypassed, the head heap orders the
+ * smallest values of the timestamps and only rules out nodes, and
+ * PeekNext uses DelayExplorer::PeekBefore. With the path cache
+ * (SetPathCache), the events entering and leaving the scheduler are
+ * reported to the DelayExplorer, which keeps their hash up to date, and
+ * every removed event is reported to DelayExplorer::Visit. The path cache
+ * is off by default: the state of a path only covers the TCP sockets and
+ * RIP routers, which register their state hashes, besides the scheduled
+ * events (DelayExplorer::AddStateHash). Paths differing in the state of
+ * other models would be merged.
  */
 class ListScheduler : public Scheduler
 {
@@ -58,26 +114,69 @@ public:
   virtual ~ListScheduler ();
 
   // <M>
-  static void SetPacketSize (uint32_t packetSize);
-  static void SetTransmitEvent (bool value);  
-  static void SetEventType (EventSchedulers_t eventType);
-  static EventSchedulers_t GetCurrEventType (void);   
-  static void SetNumNodes (uint32_t n);
-  
   static void SetPathReduction (bool value);
   static void SetWaitingList (bool value);
   static void SetLocalList (bool value);
   static void SetEndOfSim (bool value);
   static void SetLocalListv2 (bool value);
+  static void SetIndexedList (bool value);
+  static void SetHeadHeap (bool value);
+  static void SetSymbolicWindow (bool value);
+  static void SetPathCache (bool value);
   
-  static void SetInterval (uint64_t interval);
-  static void SetNumberSymPackets (uint32_t numpackets);
-  static void SetFirstSymPacket (uint64_t firstSymPacket);
-  static void SetSymLink (uint32_t node1, uint32_t node2);
-  static void SetPacketId (uint64_t packetId);
+  /**
+   * Make the timestamp of the next inserted transmit event symbolic.
+   * It is called by the SymbolicInjectionPolicy.
+   *
+   * Under S2E the range of the symbolic value is a constraint of the
+   * path, added through s2e_assume, so no state is forked and killed
+   * for the values out of it.
+   *
+   * \param [in] interval The range of the symbolic value in time steps.
+   * \param [in] advance If \c true the event may happen up to interval
+   *        earlier, otherwise up to interval later.
+   * \param [in] minimum The smallest symbolic value, at most interval,
+   *        for instance a minimum propagation delay.
+   */
+  static void SetSymbolicDelay (uint64_t interval, bool advance, uint64_t minimum = 0);
+  /**
+   * Narrow the range of the last symbolic timestamp to what
+   * SetSymbolicDelay would have given it with a smaller interval, so that
+   * several intervals are explored from the same injection.
+   *
+   * \param [in] interval The interval, at most the one it was made
+   *        symbolic with.
+   * \returns \c false if the path cannot go on with this interval.
+   */
+  static bool NarrowSymbolicDelay (uint64_t interval);
   static void SetInterfaceInfo (std::vector<std::vector<uint32_t> > interfaces);
   
   static void DecrementInPacket (const Scheduler::Event &ev);      
+
+  /**
+   * \returns The number of times every node of local lists v2 ended up
+   * waiting for an incoming packet. A deadlock lasts until a node is
+   * ready again, its events being run or forwarded by the resolver in
+   * the meantime.
+   */
+  static uint32_t GetDeadLocks (void);
+
+  /**
+   * Set the impact latency matrix derived from the topology. It is ignored
+   * when the ImpactLatency attribute has been set explicitly.
+   *
+   * \param [in] impactLatency The shortest delay, in time steps, for an event
+   *        at node i to affect node j.
+   */
+  void SetTopologyImpactLatency (std::vector<std::vector<uint64_t> > impactLatency);
+
+  /**
+   * Print every scheduled event, one per line, list by list: timestamp,
+   * uid, context, event type and number of pending events.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void Print (std::ostream &os) const;
   // <M>
 
   // Inherited
@@ -98,13 +197,21 @@ private:
   Events m_events;
 
   // <M>
-  /** Parameters for symbolic execution. */
-  static uint32_t m_numpackets;
-//  static uint64_t m_symTime;
-  static uint64_t m_interval;
-  static uint64_t m_firstSymPacket;
-  static uint32_t m_symLink[2];
-  static uint64_t m_packetId;
+  /** Symbolic value requested for the next transmit event. */
+  static bool m_injectSymbolic;
+  static uint64_t m_symInterval;
+  static uint64_t m_symMinimum;
+  static bool m_symAdvance;
+  /** The last symbolic timestamp, see NarrowSymbolicDelay. */
+  struct SymbolicDelay
+  {
+    Scheduler::EventKey key;  /**< Key of the event, once symbolic. */
+    uint64_t ts;              /**< Concrete timestamp of the event. */
+    uint64_t interval;        /**< Range of the symbolic value. */
+    uint64_t minimum;         /**< Smallest symbolic value. */
+    bool advance;             /**< \c true if the event may happen earlier. */
+  };
+  static SymbolicDelay m_lastSymbolic;
   
   /** Set techniques to use. */
   static bool m_usePathReduction;
@@ -112,23 +219,44 @@ private:
   static bool m_useLocalList;
   static bool m_useEndOfSim;
   static bool m_useLocalListv2;
+  static bool m_useIndexedList;
+  static bool m_useHeadHeap;
+  static bool m_useSymbolicWindow;
+  static bool m_usePathCache;
   
-  static uint32_t m_currPacketSize;
-  static bool m_isTransmitEvent;
-  static uint32_t m_numNodes;
-  static Scheduler::EventSchedulers_t m_currEventType;
-  static bool m_isNodeVectorInitialized;
   static bool debug;
+
+  /** The live schedulers, whose lists depend on the modes set. */
+  static std::vector<ListScheduler *> m_schedulers;
+  /**
+   * \returns \c true if a live scheduler holds events, which were linked
+   * and indexed with the current waiting and indexed list modes.
+   */
+  static bool HasQueuedEvents (void);
   unsigned m_currNode;
   
   typedef std::vector<uint64_t> nodeImpactLatency;
   /** The impact latency matrix. */
   std::vector<nodeImpactLatency> m_impactLatency;
+  /** True if m_impactLatency comes from the ImpactLatency attribute. */
+  bool m_isImpactLatencyFixed;
+  /** True if m_impactLatency was given by SetTopologyImpactLatency. */
+  bool m_isImpactLatencySet;
+  /** Number of node lists when m_impactLatency was last fetched. */
+  uint32_t m_impactLatencyNodes;
   /** The simulator event list. */
   Events m_simEvents;
   /** The node event lists, each node has its own list. */
   std::vector<Events> m_nodesEvents;
   static std::vector<Scheduler::Node> m_nodes;
+  /** Number of nodes of m_nodes waiting for an incoming packet. */
+  static uint32_t m_waitingNodes;
+  /** The nodes of m_nodes not waiting, tried in id order by local lists v2. */
+  static std::set<uint32_t> m_readyNodes;
+  /** Number of deadlocks. */
+  static uint32_t m_deadLocks;
+  /** Whether the current deadlock has been counted and is not over yet. */
+  static bool m_inDeadLock;
   
   bool InsertPathReduction (EventsI i,const Scheduler::Event &ev);
   void InsertBackToMainList_FrontIsTimeout (Events &subList, const Scheduler::Event &ev);
@@ -136,15 +264,275 @@ private:
   void InsertMultiList (Events &subList, const Scheduler::Event &ev);
   
   void CheckFrontEvent (Events &subList);
-  Scheduler::Event RemoveNextLocalList (void);
+  /**
+   * Find the list whose front event runs next with local lists. The lists
+   * may be rearranged, as when the event is removed, but it stays at the
+   * front of its list.
+   * \param [out] turn The node picked in turn, 0xffffffff if the event
+   *             was not picked by the round robin of the node lists.
+   * \returns The list.
+   */
+  Events &SelectNextLocalList (uint32_t &turn);
     
   void RemoveLocalList (Events &subList, const Scheduler::Event &ev); 
   void RemoveWaitingList (Events &subList, const Scheduler::Event &ev);
   void PrintDebugInfo (Events &subList, uint32_t ev_id, uint32_t i_id);
+  /** \returns The next event, its timestamp as ordered by the lists. */
+  Scheduler::Event PeekNextOrdered (void) const;
+  /** \returns The removed next event, its timestamp as ordered by the lists. */
+  Scheduler::Event RemoveNextOrdered (void);
+  /**
+   * Take an event that leaves the scheduler without being executed out
+   * of the DelayExplorer state.
+   * \param [in] key The key of the event.
+   */
+  void Drop (const Scheduler::EventKey &key);
+  /**
+   * Print the events of one list.
+   * \param [in,out] os The output stream.
+   * \param [in] name The name of the list.
+   * \param [in] subList The list.
+   */
+  void PrintList (std::ostream &os, std::string name, const Events &subList) const;
+
+  /**
+   * Node of a chain of pending events. The events waiting on a TIMEOUT
+   * event are chained in m_pending rather than held by the event, so that
+   * an Event is copied without allocating.
+   */
+  struct PendingNode
+  {
+    Scheduler::Event ev;  /**< The pending event. */
+    uint32_t next;        /**< Next node of the chain, 0 at the end. */
+    uint32_t last;        /**< Last node of the chain, valid in its first node. */
+  };
+  /** Arena of the pending chains, node 0 is never used. */
+  std::vector<PendingNode> m_pending;
+  /** First node of the free list of m_pending, 0 if none. */
+  uint32_t m_freePending;
+
+  /**
+   * Append an event to the pending chain of another.
+   * \param [in,out] owner The event waited on.
+   * \param [in] ev The pending event.
+   */
+  void PushPending (Scheduler::Event &owner, const Scheduler::Event &ev);
+  /**
+   * Remove the first event of a pending chain.
+   * \param [in,out] owner The event waited on, with pending events.
+   * \returns The removed event.
+   */
+  Scheduler::Event PopPending (Scheduler::Event &owner);
+  /**
+   * Remove an event from a pending chain.
+   * \param [in,out] owner The event waited on.
+   * \param [in] uid The uid of the event to remove.
+   * \returns \c true if the event was in the chain.
+   */
+  bool ErasePending (Scheduler::Event &owner, uint32_t uid);
+  /**
+   * \param [in] owner An event.
+   * \returns The number of events waiting on it.
+   */
+  uint32_t GetPendingSize (const Scheduler::Event &owner) const;
   
+  /**
+   * \param [in] nodeID The node.
+   * \returns \c true if a packet is waiting on each interface of the
+   * node, in O(1).
+   */
   bool HasIncomingOnAllInterfaces (uint32_t nodeID);
+  /**
+   * Set the waiting status of a node of local lists v2, keeping the
+   * number of waiting nodes and m_readyNodes up to date.
+   * \param [in] nodeID The node.
+   * \param [in] waiting \c true if the node waits for an incoming packet.
+   */
+  static void SetWaiting (uint32_t nodeID, bool waiting);
+  /** \returns \c true if every node of local lists v2 is waiting, in O(1). */
   bool IsDeadLock ();
+  /**
+   * Move the OUTGOING front event of a node into the list of its
+   * destination, where it is INCOMING.
+   * \param [in] nodeID The sending node.
+   */
+  void ForwardOutgoing (uint32_t nodeID);
+  /**
+   * Find the node whose front event is the earliest of the node lists,
+   * which no other node can precede: the safe node of a deadlock. It is
+   * the top of the head heap, unless the DelayExplorer is enabled: the
+   * heap does not order symbolic timestamps, the fronts are compared.
+   * \param [out] node The node.
+   * \returns \c false if every node list is empty.
+   */
+  bool GetEarliestNode (uint32_t &node);
   static uint32_t GetInterface (uint32_t src, uint32_t dst);
+
+  void SetImpactLatencyMatrix (std::string matrix);
+  std::string GetImpactLatencyMatrix (void) const;
+  /**
+   * \param [in] src The node an event is executed at.
+   * \param [in] dst The node it may affect.
+   * \returns The impact latency, 0 for nodes missing from the matrix.
+   */
+  uint64_t GetImpactLatency (uint32_t src, uint32_t dst) const;
+  /**
+   * \param [in] node A node whose list is not empty.
+   * \returns \c true if the front event of the node may run: it is not an
+   * end of simulation and no front event of another node, plus the impact
+   * latency between the nodes, is before it.
+   */
+  bool IsEligible (uint32_t node);
+  /**
+   * Fetch the matrix from Simulator::GetTopologyImpactLatency() the first
+   * time the local lists need it, and again when nodes have been added
+   * since. Nothing is fetched if the matrix was set explicitly.
+   */
+  void UpdateImpactLatency (void);
+  /**
+   * Grow the node lists so that they hold a list for a node.
+   * \param [in] context The node id, ignored for the simulator context.
+   */
+  void AddNodeList (uint32_t context);
+
+  /**
+   * \returns \c true if the lists are indexed, which they are not while
+   * the DelayExplorer is enabled.
+   */
+  static bool IsIndexed (void);
+  /**
+   * \returns \c true if the fronts of the node lists are kept in the head
+   * heap: with SetHeadHeap, and with local lists v2 for their deadlocks.
+   */
+  static bool KeepsHeads (void);
+  /**
+   * Ordering of event keys used by the list indexes. With path reduction
+   * it performs the same single m_ts comparison as InsertPathReduction.
+   * It never forks, the indexes only hold concrete or S2E timestamps.
+   */
+  struct EventKeyLess
+  {
+    /**
+     * \param [in] a The first key.
+     * \param [in] b The second key.
+     * \returns \c true if \c a is scheduled before \c b
+     */
+    bool operator () (const Scheduler::EventKey &a, const Scheduler::EventKey &b) const;
+  };
+  /** Index from event keys to positions in an event list. */
+  typedef std::multimap<Scheduler::EventKey, EventsI, EventKeyLess> EventIndex;
+  /**
+   * Balanced-tree index over one event list, used when indexed lists
+   * are enabled so that insertion and lookup are O(log n).
+   */
+  struct IndexedList
+  {
+    EventIndex keys;      /**< Every event of the list. */
+    /**
+     * Events where a linear scan stops: the STOP events and, with waiting
+     * lists, the TIMEOUT events.
+     */
+    EventIndex barriers;
+    EventIndex stops;     /**< The STOP events, the first one ends the ordered events. */
+  };
+  /** Index of m_events. */
+  IndexedList m_eventsIndex;
+  /** Index of m_simEvents. */
+  IndexedList m_simEventsIndex;
+  /** Indexes of m_nodesEvents. */
+  std::vector<IndexedList> m_nodesIndex;
+
+  IndexedList &GetIndex (Events &subList);
+  EventsI Link (Events &subList, EventsI pos, const Scheduler::Event &ev);
+  /**
+   * Remove a list position from an index.
+   * \param [in,out] index The index.
+   * \param [in] i The position.
+   */
+  static void EraseIndex (EventIndex &index, EventsI i);
+  void Unlink (Events &subList, EventsI i);
+  EventsI Find (Events &subList, const Scheduler::Event &ev);
+  void InsertIndexed (Events &subList, EventsI start, const Scheduler::Event &ev,
+                      bool useTimeout, uint32_t skipUid);
+
+  /** Entry of the head heap: the front event of a node list when it was pushed. */
+  struct Head
+  {
+    Scheduler::EventKey key;  /**< Key of the front event. */
+    uint32_t node;            /**< Index of the node list. */
+  };
+  /** Ordering of the head heap, the earliest key on top. */
+  struct HeadGreater
+  {
+    /**
+     * \param [in] a The first entry.
+     * \param [in] b The second entry.
+     * \returns \c true if \c a is scheduled after \c b
+     */
+    bool operator () (const Head &a, const Head &b) const;
+  };
+  /**
+   * Heap over the fronts of the node lists. An entry is stale once its
+   * event has left the front of its list; stale entries are dropped when
+   * they reach the top.
+   */
+  mutable std::vector<Head> m_heads;
+  /** Node lists whose front may have a pending list to extract. */
+  std::vector<uint32_t> m_dirtyNodes;
+  /** True for the node lists in m_dirtyNodes. */
+  std::vector<bool> m_isNodeDirty;
+
+  /**
+   * \param [in] subList A top level list.
+   * \returns The node the list belongs to, 0xffffffff for the other lists.
+   */
+  uint32_t GetNode (const Events &subList) const;
+  /**
+   * \param [in] key The key of an event.
+   * \returns The node list the event goes into, 0xffffffff for the
+   * other lists.
+   */
+  uint32_t GetListNode (const Scheduler::EventKey &key) const;
+  void PushHead (uint32_t node);
+  void MarkDirty (uint32_t node);
+  /**
+   * Drop stale entries from the top of the head heap.
+   * \param [out] node The node list holding the earliest node event.
+   * \returns \c false if all node lists are empty.
+   */
+  bool PeekHead (uint32_t &node) const;
+
+  /** Events with a symbolic timestamp, not ordered yet. */
+  Events m_symWindow;
+
+  void InsertIntoLists (const Scheduler::Event &ev);
+  bool IsListsEmpty (void) const;
+  Scheduler::Event PeekNextFromLists (void) const;
+  /**
+   * Find the list whose front event runs next, see SelectNextLocalList.
+   * \param [out] turn The node picked in turn, or 0xffffffff.
+   * \returns The list.
+   */
+  Events &SelectNextFromLists (uint32_t &turn);
+  /**
+   * Remove the front event of the list found by SelectNextFromLists.
+   * \param [in] subList The list.
+   * \param [in] turn The node picked in turn, or 0xffffffff.
+   * \returns The event.
+   */
+  Scheduler::Event RemoveFront (Events &subList, uint32_t turn);
+  Scheduler::Event RemoveNextFromLists (void);
+  /**
+   * Insert into the lists the symbolic events that may run before the
+   * next event: those whose lower bound is at most ts, plus the impact
+   * latency from their node to the node of the next event with local
+   * lists.
+   * \param [in] ts The timestamp of the next event in the lists.
+   * \param [in] node The node list of the next event, or 0xffffffff.
+   * \param [in] all Release every symbolic event regardless of ts.
+   * \returns \c true if any event was released.
+   */
+  bool ReleaseSymbolicWindow (uint64_t ts, uint32_t node, bool all);
   // <M>
 };
 
@@ -144,6 +144,11 @@
  * NS_LOG (LOG_DEBUG, "a number="<<aNumber<<", anotherNumber="<<anotherNumber);
  * \endcode
  *
+ * <M>
+ * The level is first tested against the levels compiled in, \c g_logFilter,
+ * a constant: the statement compiles to nothing if it is filtered out.
+ * <M>
+ *
  * \param [in] level The log level
  * \param [in] msg The message to log
  * \internal
@@ -153,7 +158,7 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (level))                              \
+      if ((g_logFilter & (level)) && g_log.IsEnabled (level))   \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -177,7 +182,8 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if ((g_logFilter & ns3::LOG_FUNCTION)                     \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -214,7 +220,8 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if ((g_logFilter & ns3::LOG_FUNCTION)                     \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-ring-buffer.h"
+#include "assert.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup logging
+ * Implementation of class ns3::LogRingBuffer.
+ */
+
+namespace ns3 {
+
+namespace {
+
+/** Size of the line gathered by a thread. */
+const uint32_t LINE_SIZE = 1024;
+/** Bytes the thread gathers before writing them to the output. */
+const uint32_t BATCH_SIZE = 64 * 1024;
+
+/** The line of the calling thread. */
+__thread char g_line[LINE_SIZE];
+/** Bytes used in g_line. */
+__thread uint32_t g_lineSize = 0;
+/** The buffer g_line is written to. */
+__thread LogRingBuffer *g_lineRing = 0;
+/**
+ * Whether the calling thread drains or wakes a buffer: the lines it
+ * writes, e.g. by logging SystemCondition, go to the output directly.
+ */
+__thread bool g_direct = false;
+
+/** The buffer of std::clog, if installed. */
+LogRingBuffer *g_clog = 0;
+/** The buffer std::clog had before. */
+std::streambuf *g_clogOutput = 0;
+
+/** Pushes the line of the calling thread and writes the lines of std::clog before a fork. */
+void
+ForkPrepare (void)
+{
+  if (g_lineRing != 0)
+    {
+      g_lineRing->pubsync ();
+    }
+  LogRingBuffer::FlushClog ();
+}
+
+/**
+ * The threads are not forked: the child writes to std::clog directly.
+ * The line of the calling thread was pushed by ForkPrepare.
+ */
+void
+ForkChild (void)
+{
+  g_lineRing = 0;
+  g_lineSize = 0;
+  if (g_clog != 0)
+    {
+      std::clog.rdbuf (g_clogOutput);
+      g_clog = 0;
+    }
+}
+
+/** Writes the lines of std::clog at exit. */
+struct ClogRing
+{
+  ~ClogRing ()
+  {
+    if (g_clog != 0)
+      {
+        LogRingBuffer *ring = g_clog;
+        ring->Flush ();
+        std::clog.rdbuf (g_clogOutput);
+        g_clog = 0;
+        delete ring;
+      }
+  }
+} g_clogRing; //!< Deletes g_clog at exit.
+
+} // unnamed namespace
+
+const uint32_t LogRingBuffer::SLOT_SIZE;
+
+LogRingBuffer::LogRingBuffer (std::streambuf *output, uint32_t slots)
+  : m_output (output),
+    m_slots (new Slot[slots]),
+    m_mask (slots - 1),
+    m_tail (0),
+    m_head (0),
+    m_written (0),
+    m_stop (false),
+    m_sleeping (false)
+{
+  NS_ASSERT_MSG ((slots & m_mask) == 0 && slots * SLOT_SIZE >= 2 * LINE_SIZE,
+                 "LogRingBuffer: " << slots << " slots");
+  for (uint32_t i = 0; i < slots; i++)
+    {
+      m_slots[i].sequence = i;
+    }
+  m_thread = Create<SystemThread> (MakeCallback (&LogRingBuffer::Drain, this));
+  m_thread->Start ();
+}
+
+LogRingBuffer::~LogRingBuffer ()
+{
+  PushLine ();
+  __atomic_store_n (&m_stop, true, __ATOMIC_RELEASE);
+  Wake ();
+  m_thread->Join ();
+  if (g_lineRing == this)
+    {
+      g_lineRing = 0;
+    }
+  delete [] m_slots;
+}
+
+void
+LogRingBuffer::Flush (void)
+{
+  PushLine ();
+  uint64_t tail = __atomic_load_n (&m_tail, __ATOMIC_ACQUIRE);
+  while (__atomic_load_n (&m_written, __ATOMIC_ACQUIRE) < tail)
+    {
+      usleep (100);
+    }
+}
+
+void
+LogRingBuffer::Install (void)
+{
+  static bool installing = false;
+  if (!__sync_bool_compare_and_swap (&installing, false, true))
+    {
+      return;
+    }
+  g_clogOutput = std::clog.rdbuf ();
+  g_clog = new LogRingBuffer (g_clogOutput);
+  std::clog.rdbuf (g_clog);
+  pthread_atfork (&ForkPrepare, 0, &ForkChild);
+}
+
+void
+LogRingBuffer::FlushClog (void)
+{
+  if (g_clog != 0)
+    {
+      g_clog->Flush ();
+    }
+}
+
+int
+LogRingBuffer::overflow (int c)
+{
+  if (c != traits_type::eof ())
+    {
+      char ch = c;
+      Append (&ch, 1);
+    }
+  return traits_type::not_eof (c);
+}
+
+std::streamsize
+LogRingBuffer::xsputn (const char *s, std::streamsize n)
+{
+  Append (s, n);
+  return n;
+}
+
+int
+LogRingBuffer::sync (void)
+{
+  if (g_direct)
+    {
+      return m_output->pubsync ();
+    }
+  PushLine ();
+  return 0;
+}
+
+void
+LogRingBuffer::Append (const char *s, uint32_t n)
+{
+  if (g_direct)
+    {
+      m_output->sputn (s, n);
+      return;
+    }
+  if (g_lineRing != this)
+    {
+      if (g_lineRing != 0)
+        {
+          g_lineRing->PushLine ();
+        }
+      g_lineRing = this;
+    }
+  while (n > 0)
+    {
+      const char *end = static_cast<const char *> (memchr (s, '\n', n));
+      uint32_t length = end != 0 ? end - s + 1 : n;
+      uint32_t size = std::min (length, LINE_SIZE - g_lineSize);
+      memcpy (g_line + g_lineSize, s, size);
+      g_lineSize += size;
+      s += size;
+      n -= size;
+      if (g_lineSize == LINE_SIZE || (size == length && end != 0))
+        {
+          PushLine ();
+        }
+    }
+}
+
+void
+LogRingBuffer::PushLine (void)
+{
+  if (g_lineRing == this && g_lineSize > 0)
+    {
+      Push (g_line, g_lineSize);
+      g_lineSize = 0;
+    }
+}
+
+void
+LogRingBuffer::Push (const char *s, uint32_t n)
+{
+  uint32_t count = (n + SLOT_SIZE - 1) / SLOT_SIZE;
+  uint64_t position = __sync_fetch_and_add (&m_tail, count);
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Slot &slot = m_slots[(position + i) & m_mask];
+      // Wait for the thread to read the slot if the ring is full
+      while (__atomic_load_n (&slot.sequence, __ATOMIC_ACQUIRE) != position + i)
+        {
+          usleep (10);
+        }
+      slot.size = std::min (n, SLOT_SIZE);
+      memcpy (slot.data, s, slot.size);
+      s += slot.size;
+      n -= slot.size;
+      __atomic_store_n (&slot.sequence, position + i + 1, __ATOMIC_RELEASE);
+    }
+  Wake ();
+}
+
+void
+LogRingBuffer::Wake (void)
+{
+  // Pairs with the fence of Drain: either the thread sees the slots
+  // written or this sees it sleeping.
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&m_sleeping, __ATOMIC_RELAXED)
+      && __atomic_exchange_n (&m_sleeping, false, __ATOMIC_ACQ_REL))
+    {
+      bool direct = g_direct;
+      g_direct = true;
+      m_wake.SetCondition (true);
+      m_wake.Signal ();
+      g_direct = direct;
+    }
+}
+
+void
+LogRingBuffer::Drain (void)
+{
+  g_direct = true;
+  std::string batch;
+  while (true)
+    {
+      Slot &slot = m_slots[m_head & m_mask];
+      if (__atomic_load_n (&slot.sequence, __ATOMIC_ACQUIRE) == m_head + 1)
+        {
+          batch.append (slot.data, slot.size);
+          __atomic_store_n (&slot.sequence, m_head + m_mask + 1, __ATOMIC_RELEASE);
+          m_head++;
+          if (batch.size () < BATCH_SIZE)
+            {
+              continue;
+            }
+        }
+      if (!batch.empty ())
+        {
+          m_output->sputn (batch.data (), batch.size ());
+          m_output->pubsync ();
+          batch.clear ();
+          __atomic_store_n (&m_written, m_head, __ATOMIC_RELEASE);
+          continue;
+        }
+      if (__atomic_load_n (&m_stop, __ATOMIC_ACQUIRE)
+          && m_head == __atomic_load_n (&m_tail, __ATOMIC_ACQUIRE))
+        {
+          break;
+        }
+      // Sleep until a writer clears m_sleeping. Setting m_sleeping before
+      // checking the ring again pairs with the fence of Wake, so a line
+      // pushed meanwhile is seen here or wakes the thread. The condition
+      // is reset after each wait: a writer of an earlier sleep may set it
+      // late, which only costs a spurious return.
+      __atomic_store_n (&m_sleeping, true, __ATOMIC_RELAXED);
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      if (__atomic_load_n (&slot.sequence, __ATOMIC_ACQUIRE) == m_head + 1
+          || (__atomic_load_n (&m_stop, __ATOMIC_ACQUIRE)
+              && m_head == __atomic_load_n (&m_tail, __ATOMIC_ACQUIRE)))
+        {
+          __atomic_store_n (&m_sleeping, false, __ATOMIC_RELAXED);
+          continue;
+        }
+      do
+        {
+          m_wake.TimedWait (1000000000);
+          m_wake.SetCondition (false);
+          __atomic_thread_fence (__ATOMIC_SEQ_CST);
+        }
+      while (__atomic_load_n (&m_sleeping, __ATOMIC_ACQUIRE));
+    }
+}
+
+} // namespace ns3
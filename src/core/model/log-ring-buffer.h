@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOG_RING_BUFFER_H
+#define LOG_RING_BUFFER_H
+
+#include "system-thread.h"
+#include "system-condition.h"
+#include "ptr.h"
+
+#include <streambuf>
+#include <string>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup logging
+ * Declaration of class ns3::LogRingBuffer.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ *
+ * A stream buffer queueing the lines written to it in a bounded ring,
+ * written to another stream buffer by a background thread.
+ *
+ * Each thread gathers its current line in a buffer of its own and pushes
+ * it when the line ends or the stream is flushed. A line takes one or
+ * more consecutive slots of the ring, reserved with a single atomic
+ * increment, so the lines of different threads do not mix and no lock is
+ * taken. A writer only waits when the ring is full. The thread sleeps on
+ * a SystemCondition while the ring is empty and the writer of the next
+ * line wakes it.
+ *
+ * With \c --log-filter, Install replaces the buffer of \c std::clog, so
+ * that the logging macros and NS_LOG_APPEND_CONTEXT do not wait for the
+ * output. The lines queued are written before the program exits, before
+ * a fork and by FatalImpl::FlushStreams.
+ */
+class LogRingBuffer : public std::streambuf
+{
+public:
+  /**
+   * Start the thread writing to \p output.
+   * \param [in] output The stream buffer the lines are written to.
+   * \param [in] slots The size of the ring, a power of 2.
+   */
+  LogRingBuffer (std::streambuf *output, uint32_t slots = 4096);
+  /** Write the lines queued and stop the thread. */
+  ~LogRingBuffer ();
+
+  /** Wait until the lines pushed have been written to the output. */
+  void Flush (void);
+
+  /** Queue the lines written to \c std::clog, once. */
+  static void Install (void);
+  /** Flush the buffer of \c std::clog if it was installed. */
+  static void FlushClog (void);
+
+protected:
+  virtual int overflow (int c);
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  virtual int sync (void);
+
+private:
+  /** Bytes of a line held by a slot. */
+  static const uint32_t SLOT_SIZE = 240;
+
+  /** A slot of the ring. */
+  struct Slot
+  {
+    /**
+     * Position the slot can be written at, or the position plus one
+     * once it was written.
+     */
+    uint64_t sequence;
+    uint32_t size;         //!< Bytes used in data.
+    char data[SLOT_SIZE];  //!< Part of a line.
+  };
+
+  /**
+   * Append to the line of the calling thread, pushing the lines ended.
+   * \param [in] s The characters.
+   * \param [in] n The number of characters.
+   */
+  void Append (const char *s, uint32_t n);
+  /** Push the line of the calling thread, if any. */
+  void PushLine (void);
+  /**
+   * Queue characters in consecutive slots.
+   * \param [in] s The characters.
+   * \param [in] n The number of characters.
+   */
+  void Push (const char *s, uint32_t n);
+  /** Wake the thread if it sleeps. */
+  void Wake (void);
+  /** Body of the thread. */
+  void Drain (void);
+
+  std::streambuf *m_output; //!< Where the lines are written.
+  Slot *m_slots;            //!< The ring.
+  uint32_t m_mask;          //!< Number of slots minus one.
+  uint64_t m_tail;          //!< Next position reserved by a writer.
+  uint64_t m_head;          //!< Next position read by the thread.
+  uint64_t m_written;       //!< Positions written to the output.
+  bool m_stop;              //!< Whether the thread should stop once empty.
+  bool m_sleeping;          //!< Whether the thread sleeps on m_wake.
+  SystemCondition m_wake;   //!< Wakes the thread.
+  Ptr<SystemThread> m_thread; //!< The thread.
+};
+
+} // namespace ns3
+
+#endif /* LOG_RING_BUFFER_H */
@@ -25,6 +25,11 @@
 #include "assert.h"
 #include "ns3/core-config.h"
 #include "fatal-error.h"
+// <M>
+#ifdef NS3_LOG_ASYNC
+#include "log-ring-buffer.h"
+#endif
+// <M>
 
 #ifdef HAVE_GETENV
 #include <cstring>
@@ -291,6 +296,14 @@ void
 LogComponent::Enable (const enum LogLevel level)
 {
   m_levels |= (level & ~m_mask);
+  // <M>
+#ifdef NS3_LOG_ASYNC
+  if (m_levels & LOG_LEVEL_ALL)
+    {
+      LogRingBuffer::Install ();
+    }
+#endif
+  // <M>
 }
 
 void 
@@ -26,6 +26,9 @@
 #include <stdint.h>
 #include <map>
 
+// <M>
+#include "ns3/core-config.h"
+// <M>
 #include "log-macros-enabled.h"
 #include "log-macros-disabled.h"
 
@@ -78,6 +81,19 @@
  *   NS_LOG_FUNCTION (this << arg1 << args);
  * \endcode
  * Use NS_LOG_FUNCTION_NOARGS() only in static functions with no arguments.
+ *
+ * <M>
+ * When ns-3 is configured with \c --log-filter, the logging macros are
+ * compiled in every build profile, but only for the components and
+ * levels of the filter, which uses the syntax of NS_LOG:
+ * \code
+ *   $ ./waf configure -d optimized --log-filter='PointToPointChannel=info|function:ListScheduler'
+ * \endcode
+ * The statements of the other components and levels compile to nothing.
+ * The selected ones are still enabled at run time with NS_LOG or
+ * LogComponentEnable, and, when threads are available, \c std::clog is
+ * written to a LogRingBuffer drained by a background thread.
+ * <M>
  */
 /** @{ */
 
@@ -161,10 +177,173 @@ void LogComponentDisable (char const *name, enum LogLevel level);
  */
 void LogComponentDisableAll (enum LogLevel level);
 
+// <M>
+/**
+ * \internal
+ * Compile-time parser of the filter given to \c --log-filter.
+ * The filter is a string literal with the syntax of NS_LOG; the prefixes
+ * are ignored, they are selected at run time.
+ */
+namespace LogFilter {
+
+/**
+ * \param [in] c A character of the filter.
+ * \returns \c true if \p c ends a level.
+ */
+constexpr bool
+IsLevelEnd (char c)
+{
+  return c == '\0' || c == ':' || c == '|';
+}
+
+/**
+ * \param [in] c A character of the filter.
+ * \returns \c true if \p c ends a component name.
+ */
+constexpr bool
+IsNameEnd (char c)
+{
+  return c == '\0' || c == ':' || c == '=';
+}
+
+/**
+ * \param [in] s A level in the filter.
+ * \returns The end of the level.
+ */
+constexpr const char *
+SkipLevel (const char *s)
+{
+  return IsLevelEnd (*s) ? s : SkipLevel (s + 1);
+}
+
+/**
+ * \param [in] s A component in the filter.
+ * \returns The end of the component and of its levels.
+ */
+constexpr const char *
+SkipComponent (const char *s)
+{
+  return (*s == '\0' || *s == ':') ? s : SkipComponent (s + 1);
+}
+
+/**
+ * \param [in] s A level in the filter.
+ * \param [in] label A level label.
+ * \returns \c true if the level is \p label.
+ */
+constexpr bool
+IsLevel (const char *s, const char *label)
+{
+  return *label == '\0' ? IsLevelEnd (*s) : (*s == *label && IsLevel (s + 1, label + 1));
+}
+
+/**
+ * \param [in] s A component in the filter.
+ * \param [in] name A component name.
+ * \returns \c true if the component is \p name.
+ */
+constexpr bool
+IsName (const char *s, const char *name)
+{
+  return *name == '\0' ? IsNameEnd (*s) : (*s == *name && IsName (s + 1, name + 1));
+}
+
+/**
+ * \param [in] s A level in the filter.
+ * \param [in] first Whether \p s is the first level, where \c all and
+ *             \c * select every level rather than every prefix.
+ * \returns The levels selected by \p s.
+ */
+constexpr uint32_t
+Level (const char *s, bool first)
+{
+  return IsLevel (s, "error") || IsLevel (s, "level_error") ? LOG_LEVEL_ERROR
+    : IsLevel (s, "warn") ? LOG_WARN
+    : IsLevel (s, "debug") ? LOG_DEBUG
+    : IsLevel (s, "info") ? LOG_INFO
+    : IsLevel (s, "function") ? LOG_FUNCTION
+    : IsLevel (s, "logic") ? LOG_LOGIC
+    : IsLevel (s, "level_warn") ? LOG_LEVEL_WARN
+    : IsLevel (s, "level_debug") ? LOG_LEVEL_DEBUG
+    : IsLevel (s, "level_info") ? LOG_LEVEL_INFO
+    : IsLevel (s, "level_function") ? LOG_LEVEL_FUNCTION
+    : IsLevel (s, "level_logic") ? LOG_LEVEL_LOGIC
+    : IsLevel (s, "level_all") || IsLevel (s, "**") ? LOG_LEVEL_ALL
+    : first && (IsLevel (s, "all") || IsLevel (s, "*")) ? LOG_LEVEL_ALL
+    : 0;
+}
+
+/**
+ * \param [in] s A level in the filter.
+ * \param [in] first Whether \p s is the first level.
+ * \returns The levels selected by \p s and the levels following it.
+ */
+constexpr uint32_t
+Levels (const char *s, bool first)
+{
+  return Level (s, first)
+    | (*SkipLevel (s) == '|' ? Levels (SkipLevel (s) + 1, false) : 0);
+}
+
+/**
+ * \param [in] s A component in the filter.
+ * \returns The end of the component name.
+ */
+constexpr const char *
+SkipName (const char *s)
+{
+  return IsNameEnd (*s) ? s : SkipName (s + 1);
+}
+
+/**
+ * \param [in] s A component in the filter.
+ * \param [in] name A component name.
+ * \returns The levels the component selects for \p name.
+ */
+constexpr uint32_t
+ComponentLevels (const char *s, const char *name)
+{
+  return *SkipName (s) == '='
+    ? ((IsName (s, name) || IsName (s, "*")) ? Levels (SkipName (s) + 1, true) : 0)
+    : ((IsName (s, name) || IsName (s, "*") || IsName (s, "***")) ? LOG_LEVEL_ALL : 0);
+}
+
+/**
+ * \param [in] name A component name.
+ * \param [in] filter The filter.
+ * \returns The levels of \p name compiled in.
+ */
+constexpr uint32_t
+Select (const char *name, const char *filter)
+{
+  return ComponentLevels (filter, name)
+    | (*SkipComponent (filter) == ':' ? Select (name, SkipComponent (filter) + 1) : 0);
+}
+
+} // namespace LogFilter
+// <M>
+
 
 } // namespace ns3
 
 
+// <M>
+#ifdef NS3_LOG_FILTER
+/**
+ * \internal
+ * Define the levels of a component compiled in, \c g_logFilter.
+ *
+ * \param [in] name The log component name.
+ */
+#define NS_LOG_FILTER_DEFINE(name)                              \
+  static const uint32_t g_logFilter =                           \
+    ns3::LogFilter::Select (name, NS3_LOG_FILTER)
+#else
+#define NS_LOG_FILTER_DEFINE(name)                              \
+  static const uint32_t g_logFilter = ns3::LOG_LEVEL_ALL
+#endif
+// <M>
+
 /**
  * Define a Log component with a specific name.
  *
@@ -192,6 +371,7 @@ void LogComponentDisableAll (enum LogLevel level);
  *   } // namespace ns3
  *
  *   using ns3::g_log;
+ *   using ns3::g_logFilter;
  *
  *   // Further definitions outside of the ns3 namespace
  *\endcode
@@ -199,6 +379,7 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] name The log component name.
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
+  NS_LOG_FILTER_DEFINE (name);                                  \
   static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__)
 
 /**
@@ -210,6 +391,7 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] mask The default mask.
  */
 #define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
+  NS_LOG_FILTER_DEFINE (name);                                  \
   static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__, mask)
 
 /**
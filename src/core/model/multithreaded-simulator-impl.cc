@@ -0,0 +1,859 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+#include "map-scheduler.h"
+#include "list-scheduler.h"
+#include "delay-explorer.h"
+#include "simulator.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "abort.h"
+#include "log.h"
+
+#include <algorithm>
+#include <limits>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+__thread MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+/** Timestamp after the timestamp of any event. */
+static const uint64_t LAST_TS = std::numeric_limits<uint64_t>::max ();
+
+/** Number of MultithreadedSimulatorImpl instances. */
+static uint32_t g_instances = 0;
+/** Whether a Run is using more than one thread. */
+static bool g_runningThreads = false;
+
+/**
+ * Check for the ListScheduler, whose local lists are static members
+ * driven by the DefaultSimulatorImpl.
+ * \param [in] tid The scheduler type.
+ * \return \c true for the ListScheduler or a subclass.
+ */
+static bool
+IsListScheduler (TypeId tid)
+{
+  return tid == ListScheduler::GetTypeId () || tid.IsChildOf (ListScheduler::GetTypeId ());
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("Threads",
+                   "Number of threads running the nodes, 0 for one per "
+                   "processor. Only one thread is used when ns-3 is not "
+                   "configured with --enable-node-threads.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadsAttribute),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NodeSchedulerType",
+                   "The scheduler of the node event lists. The scheduler of "
+                   "the simulator events is set by SchedulerType.",
+                   TypeIdValue (MapScheduler::GetTypeId ()),
+                   MakeTypeIdAccessor (&MultithreadedSimulatorImpl::m_nodeSchedulerType),
+                   MakeTypeIdChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_simulator.context = 0xffffffff;
+  m_simulator.currentTs = 0;
+  m_simulator.currentUid = 0;
+  // uids are allocated from 4, as in DefaultSimulatorImpl
+  m_simulator.uid = 4;
+  m_simulator.next = LAST_TS;
+  m_simulator.thread = 0;
+  m_stop = false;
+  m_stopTs = LAST_TS;
+  m_stopTsReached = false;
+  m_threadsAttribute = 0;
+  m_threads = 1;
+  m_nextThread = 1;
+  m_running = false;
+  m_concurrent = false;
+  m_done = false;
+  m_window = false;
+  m_isLookaheadSet = false;
+  m_gvt = 0;
+  m_cap = LAST_TS;
+  m_waiting = 0;
+  m_generation = 0;
+  pthread_mutex_init (&m_barrierMutex, 0);
+  pthread_cond_init (&m_barrierCond, 0);
+  m_main = SystemThread::Self ();
+  g_instances++;
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  g_instances--;
+  pthread_cond_destroy (&m_barrierCond);
+  pthread_mutex_destroy (&m_barrierMutex);
+}
+
+bool
+MultithreadedSimulatorImpl::IsInUse (void)
+{
+  return g_instances > 0;
+}
+
+bool
+MultithreadedSimulatorImpl::IsRunningThreads (void)
+{
+  return g_runningThreads;
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Message>::iterator i = m_orphans.begin (); i != m_orphans.end (); i++)
+    {
+      i->ev.impl->Unref ();
+    }
+  m_orphans.clear ();
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      Partition *p = *i;
+      Deliver (p);
+      while (!p->events->IsEmpty ())
+        {
+          p->events->RemoveNext ().impl->Unref ();
+        }
+      delete p;
+    }
+  m_partitions.clear ();
+  m_byContext.clear ();
+  m_threadPartitions.clear ();
+  if (m_simulator.events != 0)
+    {
+      while (!m_simulator.events->IsEmpty ())
+        {
+          m_simulator.events->RemoveNext ().impl->Unref ();
+        }
+    }
+  m_simulator.events = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  if (IsListScheduler (schedulerFactory.GetTypeId ()))
+    {
+      // the first scheduler is the SchedulerType global value, whose
+      // default is the ListScheduler
+      NS_ABORT_MSG_IF (m_simulator.events != 0, "The ListScheduler is not supported by the MultithreadedSimulatorImpl");
+      schedulerFactory.SetTypeId (MapScheduler::GetTypeId ());
+    }
+  Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+
+  if (m_simulator.events != 0)
+    {
+      while (!m_simulator.events->IsEmpty ())
+        {
+          Scheduler::Event next = m_simulator.events->RemoveNext ();
+          scheduler->Insert (next);
+        }
+    }
+  m_simulator.events = scheduler;
+}
+
+void
+MultithreadedSimulatorImpl::SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency)
+{
+  NS_LOG_FUNCTION (this << impactLatency.size ());
+  NS_ASSERT_MSG (!m_concurrent, "The impact latency can only be set from the simulator context");
+  m_isLookaheadSet = true;
+  SetLookahead (impactLatency);
+}
+
+void
+MultithreadedSimulatorImpl::SetLookahead (std::vector<std::vector<uint64_t> > impactLatency)
+{
+  m_lookahead = impactLatency;
+  m_roundTrip.assign (m_lookahead.size (), std::numeric_limits<uint64_t>::max ());
+  for (uint32_t i = 0; i < m_lookahead.size (); i++)
+    {
+      for (uint32_t j = 0; j < m_lookahead.size (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          uint64_t there = GetLookahead (i, j);
+          uint64_t roundTrip = there + GetLookahead (j, i);
+          if (roundTrip >= there)
+            {
+              m_roundTrip[i] = std::min (m_roundTrip[i], roundTrip);
+            }
+        }
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context)
+{
+  if (context == 0xffffffff)
+    {
+      return &m_simulator;
+    }
+  NS_ASSERT (!m_concurrent);
+  if (context >= m_byContext.size ())
+    {
+      m_byContext.resize (context + 1, 0);
+    }
+  Partition *p = m_byContext[context];
+  if (p == 0)
+    {
+      NS_LOG_LOGIC ("new partition for context " << context);
+      NS_ABORT_MSG_IF (IsListScheduler (m_nodeSchedulerType),
+                       "The ListScheduler is not supported by the MultithreadedSimulatorImpl");
+      ObjectFactory factory;
+      factory.SetTypeId (m_nodeSchedulerType);
+      p = new Partition ();
+      p->context = context;
+      p->events = factory.Create<Scheduler> ();
+      p->currentTs = m_simulator.currentTs;
+      p->currentUid = 0;
+      p->uid = 4;
+      p->next = LAST_TS;
+      p->thread = m_partitions.size () % m_threads;
+      m_byContext[context] = p;
+      m_partitions.push_back (p);
+      if (m_running)
+        {
+          m_threadPartitions[p->thread].push_back (p);
+        }
+    }
+  return p;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::LookupPartition (uint32_t context) const
+{
+  if (context == 0xffffffff)
+    {
+      return const_cast<Partition *> (&m_simulator);
+    }
+  if (context >= m_byContext.size ())
+    {
+      return 0;
+    }
+  return m_byContext[context];
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  if (m_current != 0)
+    {
+      return m_current;
+    }
+  return const_cast<Partition *> (&m_simulator);
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetLookahead (uint32_t from, uint32_t to) const
+{
+  if (from >= m_lookahead.size () || to >= m_lookahead[from].size ())
+    {
+      return 0;
+    }
+  return m_lookahead[from][to];
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetRoundTrip (uint32_t context) const
+{
+  if (context >= m_roundTrip.size ())
+    {
+      return 0;
+    }
+  return m_roundTrip[context];
+}
+
+bool
+MultithreadedSimulatorImpl::IsSentBefore (Message const &a, Message const &b)
+{
+  return a.from < b.from || (a.from == b.from && a.ev.key.m_uid < b.ev.key.m_uid);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *p, Scheduler::Event ev)
+{
+  ev.key.m_uid = p->uid++;
+  p->events->Insert (ev);
+  // while the nodes are stopped, the next timestamps are kept up to date
+  if (!m_concurrent)
+    {
+      p->next = std::min (p->next, ev.key.m_ts);
+    }
+  return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::Send (Partition *from, Scheduler::Event ev)
+{
+  uint32_t context = ev.key.m_context;
+  if (context == from->context)
+    {
+      Insert (from, ev);
+      return;
+    }
+  if (!m_concurrent)
+    {
+      Insert (GetPartition (context), ev);
+      return;
+    }
+  NS_ABORT_MSG_IF (context == 0xffffffff,
+                   "Events of the simulator context can only be scheduled from the simulator context");
+  NS_ABORT_MSG_IF (ev.key.m_ts < from->currentTs + GetLookahead (from->context, context),
+                   "Event for node " << context << " scheduled by node " << from->context <<
+                   " before the impact latency between them");
+  // the uid of the sender orders the messages, the receiver gives the
+  // event its own uid on delivery
+  Message message;
+  message.from = from->context;
+  message.ev = ev;
+  message.ev.key.m_uid = from->uid++;
+  Partition *to = LookupPartition (context);
+  if (to == 0)
+    {
+      CriticalSection cs (m_mutex);
+      m_orphans.push_back (message);
+      return;
+    }
+  CriticalSection cs (to->inboxMutex);
+  to->inbox.push_back (message);
+}
+
+void
+MultithreadedSimulatorImpl::Deliver (Partition *p)
+{
+  std::vector<Message> inbox;
+  {
+    CriticalSection cs (p->inboxMutex);
+    inbox.swap (p->inbox);
+  }
+  // the messages arrive in the order the threads ran, but the uids, and
+  // thus the order of simultaneous events, do not depend on it
+  std::sort (inbox.begin (), inbox.end (), &MultithreadedSimulatorImpl::IsSentBefore);
+  for (std::vector<Message>::const_iterator i = inbox.begin (); i != inbox.end (); i++)
+    {
+      NS_ASSERT (i->ev.key.m_ts >= p->currentTs);
+      Insert (p, i->ev);
+    }
+  p->next = p->events->IsEmpty () ? LAST_TS : p->events->PeekNext ().key.m_ts;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *p)
+{
+  Scheduler::Event next = p->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= p->currentTs);
+  NS_LOG_LOGIC ("handle " << next.key.m_ts << " in context " << p->context);
+  p->currentTs = next.key.m_ts;
+  p->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Cancel ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Plan (void)
+{
+  std::sort (m_orphans.begin (), m_orphans.end (), &MultithreadedSimulatorImpl::IsSentBefore);
+  for (std::vector<Message>::const_iterator i = m_orphans.begin (); i != m_orphans.end (); i++)
+    {
+      Insert (GetPartition (i->ev.key.m_context), i->ev);
+    }
+  m_orphans.clear ();
+
+  m_window = false;
+  while (!m_stop)
+    {
+      uint64_t first = LAST_TS;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+        {
+          first = std::min (first, (*i)->next);
+        }
+      uint64_t global = m_simulator.events->IsEmpty () ?
+        LAST_TS : m_simulator.events->PeekNext ().key.m_ts;
+
+      // the simulator events run alone, before the node events of the
+      // same timestamp; they may schedule events for any node
+      if (global != LAST_TS && global <= first)
+        {
+          if (global >= m_stopTs)
+            {
+              break;
+            }
+          m_current = &m_simulator;
+          ProcessOneEvent (&m_simulator);
+          m_current = 0;
+          continue;
+        }
+      if (first >= m_stopTs)
+        {
+          break;
+        }
+      m_gvt = first;
+      m_cap = std::min (global, m_stopTs);
+      m_window = true;
+      return;
+    }
+  m_stopTsReached = !m_stop && m_stopTs != LAST_TS;
+  m_done = true;
+}
+
+void
+MultithreadedSimulatorImpl::Execute (Partition *p)
+{
+  if (p->next >= m_cap)
+    {
+      return;
+    }
+  // another node may send an event for its next timestamp plus the
+  // impact latency, and the events this node sends during the round may
+  // come back after a round trip; the events before that are safe
+  uint64_t bound = p->next + GetRoundTrip (p->context);
+  if (bound < p->next)
+    {
+      bound = std::numeric_limits<uint64_t>::max ();
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      Partition *q = *i;
+      if (q == p || q->next >= bound)
+        {
+          continue;
+        }
+      uint64_t earliest = q->next + GetLookahead (q->context, p->context);
+      if (earliest < q->next)
+        {
+          // unreachable
+          continue;
+        }
+      bound = std::min (bound, earliest);
+    }
+
+  m_current = p;
+  while (!p->events->IsEmpty () && !__atomic_load_n (&m_stop, __ATOMIC_RELAXED))
+    {
+      uint64_t ts = p->events->PeekNext ().key.m_ts;
+      if ((ts >= bound && ts != m_gvt) || ts >= m_cap)
+        {
+          break;
+        }
+      ProcessOneEvent (p);
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  if (m_threads == 1)
+    {
+      return;
+    }
+  pthread_mutex_lock (&m_barrierMutex);
+  uint32_t generation = m_generation;
+  m_waiting++;
+  if (m_waiting == m_threads)
+    {
+      m_waiting = 0;
+      m_generation++;
+      pthread_cond_broadcast (&m_barrierCond);
+    }
+  else
+    {
+      while (generation == m_generation)
+        {
+          pthread_cond_wait (&m_barrierCond, &m_barrierMutex);
+        }
+    }
+  pthread_mutex_unlock (&m_barrierMutex);
+}
+
+void
+MultithreadedSimulatorImpl::Work (uint32_t thread)
+{
+  NS_LOG_FUNCTION (this << thread);
+  std::vector<Partition *> &mine = m_threadPartitions[thread];
+  while (true)
+    {
+      for (uint32_t i = 0; i < mine.size (); i++)
+        {
+          Deliver (mine[i]);
+        }
+      Barrier ();
+      if (thread == 0)
+        {
+          m_concurrent = false;
+          Plan ();
+          m_concurrent = m_window;
+        }
+      Barrier ();
+      if (m_done)
+        {
+          break;
+        }
+      if (m_window)
+        {
+          for (uint32_t i = 0; i < mine.size (); i++)
+            {
+              Execute (mine[i]);
+            }
+        }
+      Barrier ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::WorkerMain (void)
+{
+  uint32_t thread;
+  {
+    CriticalSection cs (m_mutex);
+    thread = m_nextThread++;
+  }
+  Work (thread);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  m_stop = false;
+  m_done = false;
+  NS_ABORT_MSG_IF (DelayExplorer::IsEnabled (), "Symbolic delays are not supported by the MultithreadedSimulatorImpl");
+
+  m_threads = m_threadsAttribute;
+#ifdef NS3_NODE_THREADS
+  if (m_threads == 0)
+    {
+      long processors = sysconf (_SC_NPROCESSORS_ONLN);
+      m_threads = processors > 0 ? processors : 1;
+    }
+#else
+  NS_ABORT_MSG_IF (m_threads > 1, "Several node threads need ns-3 configured with --enable-node-threads");
+  m_threads = 1;
+#endif
+  m_threads = std::max<uint32_t> (1, std::min<uint32_t> (m_threads, m_partitions.size ()));
+  if (!m_isLookaheadSet)
+    {
+      // the topology is built by now
+      SetLookahead (Simulator::GetTopologyImpactLatency ());
+    }
+  NS_LOG_LOGIC ("running " << m_partitions.size () << " nodes on " << m_threads << " threads");
+
+  m_threadPartitions.assign (m_threads, std::vector<Partition *> ());
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      m_partitions[i]->thread = i % m_threads;
+      m_threadPartitions[i % m_threads].push_back (m_partitions[i]);
+    }
+
+  m_running = true;
+  g_runningThreads = m_threads > 1;
+  m_nextThread = 1;
+  m_waiting = 0;
+  for (uint32_t i = 1; i < m_threads; i++)
+    {
+      Ptr<SystemThread> worker = Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::WorkerMain, this));
+      worker->Start ();
+      m_workers.push_back (worker);
+    }
+  Work (0);
+  for (uint32_t i = 0; i < m_workers.size (); i++)
+    {
+      m_workers[i]->Join ();
+    }
+  m_workers.clear ();
+  m_running = false;
+  g_runningThreads = false;
+
+  // the simulator clock catches up with the nodes
+  uint64_t ts = m_simulator.currentTs;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      ts = std::max (ts, (*i)->currentTs);
+    }
+  if (m_stopTsReached)
+    {
+      ts = std::max (ts, m_stopTs);
+      m_stopTs = LAST_TS;
+      m_stopTsReached = false;
+    }
+  m_simulator.currentTs = ts;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop || !m_simulator.events->IsEmpty () || !m_orphans.empty ())
+    {
+      return m_stop;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      if (!(*i)->events->IsEmpty () || !(*i)->inbox.empty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  __atomic_store_n (&m_stop, true, __ATOMIC_RELAXED);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  uint64_t ts = GetCurrent ()->currentTs + delay.GetTimeStep ();
+  CriticalSection cs (m_mutex);
+  m_stopTs = std::min (m_stopTs, ts);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main), "Simulator::Schedule Thread-unsafe invocation!");
+  Partition *p = GetCurrent ();
+
+  Time tAbsolute = delay + TimeStep (p->currentTs);
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (p->currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = p->context;
+  ev.key.m_eventType = event->GetEventType ();
+  uint32_t uid = Insert (p, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, uid, ev.key.m_eventType);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main), "Simulator::ScheduleWithContext Thread-unsafe invocation!");
+  Partition *from = GetCurrent ();
+
+  Time tAbsolute = delay + TimeStep (from->currentTs);
+  NS_ASSERT (tAbsolute >= TimeStep (from->currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = context;
+  ev.key.m_eventType = event->GetEventType ();
+  Send (from, ev);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t prevContext, uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << prevContext << context << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main), "Simulator::ScheduleWithContext Thread-unsafe invocation!");
+  // the clock of the sending node is the clock of the current event
+  Partition *from = GetCurrent ();
+  event->SetEventType (Scheduler::OUTGOING);
+
+  Time tAbsolute = delay + TimeStep (from->currentTs);
+  NS_ASSERT (tAbsolute >= TimeStep (from->currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = context;
+  ev.key.m_prevContext = prevContext;
+  ev.key.m_eventType = event->GetEventType ();
+  Send (from, ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), m_simulator.currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_mutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrent ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  Partition *p = LookupPartition (id.GetContext ());
+  uint64_t currentTs = p != 0 ? p->currentTs : m_simulator.currentTs;
+  return TimeStep (id.GetTs () - currentTs);
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_mutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (id.GetUid () == 0)
+    {
+      return;
+    }
+  // the event may still be on its way to another node: it stays in the
+  // lists and is skipped, as a cancelled event
+  id.PeekEventImpl ()->Cancel ();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_mutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *p = LookupPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  if (p == 0)
+    {
+      // not delivered yet
+      return false;
+    }
+  return id.GetTs () < p->currentTs ||
+         (id.GetTs () == p->currentTs && id.GetUid () <= p->currentUid);
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ()->context;
+}
+
+} // namespace ns3
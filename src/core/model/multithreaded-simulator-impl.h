@@ -0,0 +1,328 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "ns3/system-mutex.h"
+#include "object-factory.h"
+#include "type-id.h"
+
+#include "ptr.h"
+
+#include <list>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * A single process simulator implementation running the nodes on
+ * several threads.
+ *
+ * Like the local lists and clocks of the DefaultSimulatorImpl, each node
+ * has its own event list and its own clock. The events of the simulator
+ * context (0xffffffff) are kept in a list of their own.
+ *
+ * The simulation advances in rounds. At the start of a round, every node
+ * publishes the timestamp of its next event. A node may then execute its
+ * events up to the earliest time another node could still send it an
+ * event: the next event of that node plus the impact latency between the
+ * two, as given by Simulator::SetImpactLatency or else by the source
+ * registered with Simulator::SetImpactLatencySource, or its own next
+ * event plus the shortest round trip to another node. The impact latency
+ * is expected to be a shortest path distance, as computed by the
+ * ChannelList. The node with the earliest event can always execute it,
+ * so a round never stalls. Events sent to another node are queued and
+ * inserted in its list at the start of the next round. This is the
+ * conservative synchronisation of the null message algorithm, the
+ * published timestamps playing the part of the null messages.
+ *
+ * The events of the simulator context are executed alone, between two
+ * rounds, before the node events of the same timestamp.
+ *
+ * The uids of the events are given by the node executing them, the
+ * events received from the other nodes being numbered in the order of
+ * their sender. Simultaneous events thus run in the same order whatever
+ * the number of threads, and so do the simulations.
+ *
+ * The nodes are shared between the "Threads" threads, the thread calling
+ * Simulator::Run being one of them. Running more than one thread needs
+ * ns-3 to be configured with --enable-node-threads, which makes the
+ * reference counts, the packet uids and the buffer allocation safe to
+ * share. PacketMetadata::Enable, the ListScheduler and the symbolic
+ * execution features abort with this implementation, and so do the
+ * CSMA and Wi-Fi channels, which share their state between the nodes,
+ * when run by several threads.
+ *
+ * An event scheduled for another node must be at least the impact
+ * latency away, and an event can only be scheduled in the simulator
+ * context from the simulator context. Simulator::Stop (delay) stops the
+ * simulation before the events of its timestamp; called by a node, it is
+ * honoured at the end of the current round.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  /**
+   * Check whether an instance of this implementation exists, for the
+   * features it does not support to refuse to be enabled.
+   * \return \c true if a MultithreadedSimulatorImpl exists.
+   */
+  static bool IsInUse (void);
+  /**
+   * Check whether the nodes are being run by several threads, for the
+   * state shared by the nodes of a channel to refuse to be changed.
+   * \return \c true during a Run with more than one thread.
+   */
+  static bool IsRunningThreads (void);
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t prevContext, uint32_t context, Time const &delay, EventImpl *event);
+  virtual void SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to another node during a round. */
+  struct Message
+  {
+    /** The sending node. */
+    uint32_t from;
+    /** The event, its uid given by the sending node. */
+    Scheduler::Event ev;
+  };
+
+  /** The event list and the clock of a node, or of the simulator. */
+  struct Partition
+  {
+    /** The node id, 0xffffffff for the simulator. */
+    uint32_t context;
+    /** The event list. */
+    Ptr<Scheduler> events;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Next event unique id, uids are only compared within a partition. */
+    uint32_t uid;
+    /** Timestamp of the next event at the start of the round. */
+    uint64_t next;
+    /** Thread executing the events. */
+    uint32_t thread;
+    /** Events sent by the other nodes during the round. */
+    std::vector<Message> inbox;
+    /** Protects the inbox. */
+    SystemMutex inboxMutex;
+  };
+
+  /**
+   * Execute the rounds, until the end of the simulation.
+   * \param [in] thread The index of the calling thread.
+   */
+  void Work (uint32_t thread);
+  /** Entry point of the other threads. */
+  void WorkerMain (void);
+  /** Wait until every thread has called Barrier. */
+  void Barrier (void);
+  /**
+   * Between two rounds: execute the due events of the simulator and
+   * decide what the next round may execute. Called by the main thread.
+   */
+  void Plan (void);
+  /**
+   * Execute the events of a node allowed in this round.
+   * \param [in] p The node.
+   */
+  void Execute (Partition *p);
+  /**
+   * Insert the events sent to a partition, and publish its next event.
+   * \param [in] p The partition.
+   */
+  void Deliver (Partition *p);
+  /**
+   * Remove and invoke the next event of a partition.
+   * \param [in] p The partition.
+   */
+  void ProcessOneEvent (Partition *p);
+
+  /**
+   * \param [in] context A node id.
+   * \returns The partition of the node, created if needed. Only called
+   * while the nodes are not running.
+   */
+  Partition *GetPartition (uint32_t context);
+  /**
+   * \param [in] context A node id, or 0xffffffff.
+   * \returns The partition, 0 if it does not exist yet.
+   */
+  Partition *LookupPartition (uint32_t context) const;
+  /** \returns The partition of the current event. */
+  Partition *GetCurrent (void) const;
+  /**
+   * Queue an event for a partition.
+   * \param [in] from The partition scheduling the event.
+   * \param [in] ev The event, its context set.
+   */
+  void Send (Partition *from, Scheduler::Event ev);
+  /**
+   * Give an event the next uid of a partition and insert it in its list.
+   * \param [in] p The partition.
+   * \param [in] ev The event.
+   * \returns The uid given to the event.
+   */
+  uint32_t Insert (Partition *p, Scheduler::Event ev);
+  /**
+   * \param [in] from The sending node.
+   * \param [in] to The receiving node.
+   * \returns The impact latency between the nodes, 0 if unknown.
+   */
+  uint64_t GetLookahead (uint32_t from, uint32_t to) const;
+  /**
+   * \param [in] context A node id.
+   * \returns The shortest impact latency from the node to another node
+   * and back, 0 if unknown.
+   */
+  uint64_t GetRoundTrip (uint32_t context) const;
+  /**
+   * Set the impact latency between the nodes and their round trips.
+   * \param [in] impactLatency The impact latency matrix.
+   */
+  void SetLookahead (std::vector<std::vector<uint64_t> > impactLatency);
+  /**
+   * Order the messages received by a node independently of the threads.
+   * \param [in] a The first message.
+   * \param [in] b The second message.
+   * \returns \c true if \c a is delivered before \c b.
+   */
+  static bool IsSentBefore (Message const &a, Message const &b);
+
+  /** Partition of the current event, in each thread. */
+  static __thread Partition *m_current;
+
+  /** The events of the simulator context. */
+  Partition m_simulator;
+  /** The node partitions, in creation order. */
+  std::vector<Partition *> m_partitions;
+  /** The node partitions, by node id. */
+  std::vector<Partition *> m_byContext;
+  /** Events sent to nodes without a partition during a round. */
+  std::vector<Message> m_orphans;
+  /** Type of the node event lists. */
+  TypeId m_nodeSchedulerType;
+  /** Impact latency between the nodes, by node id. */
+  std::vector<std::vector<uint64_t> > m_lookahead;
+  /** Shortest round trip from each node, by node id. */
+  std::vector<uint64_t> m_roundTrip;
+  /**
+   * \c true if the impact latency was given by SetImpactLatency, else it
+   * is fetched from Simulator::GetTopologyImpactLatency() at each Run.
+   */
+  bool m_isLookaheadSet;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Protects the destroy events, the orphans and the stop time. */
+  mutable SystemMutex m_mutex;
+
+  /** Flag calling for the end of the simulation. */
+  bool m_stop;
+  /** Events from this timestamp on are not executed. */
+  uint64_t m_stopTs;
+  /** \c true if the last round ended at the stop time. */
+  bool m_stopTsReached;
+
+  /** Number of threads asked for, 0 for one per processor. */
+  uint32_t m_threadsAttribute;
+  /** Number of threads of the current run. */
+  uint32_t m_threads;
+  /** Next index given to a thread. */
+  uint32_t m_nextThread;
+  /** The threads other than the main one. */
+  std::vector<Ptr<SystemThread> > m_workers;
+  /** The node partitions of each thread. */
+  std::vector<std::vector<Partition *> > m_threadPartitions;
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+  /** \c true while Run executes. */
+  bool m_running;
+  /** \c true while the nodes execute their events. */
+  bool m_concurrent;
+  /** \c true when the simulation is over. */
+  bool m_done;
+  /** \c true if the nodes may execute events this round. */
+  bool m_window;
+  /** Smallest timestamp of the next node events. */
+  uint64_t m_gvt;
+  /** The nodes execute the events before this timestamp this round. */
+  uint64_t m_cap;
+
+  /** Threads waiting in Barrier. */
+  uint32_t m_waiting;
+  /** Number of times every thread reached Barrier. */
+  uint32_t m_generation;
+  /** Protects the barrier. */
+  pthread_mutex_t m_barrierMutex;
+  /** Signalled when every thread reached Barrier. */
+  pthread_cond_t m_barrierCond;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -127,6 +127,27 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
     }
   return true;
 }
+// <M>
+bool
+ObjectPtrContainerAccessor::GetByIndex (const ObjectBase * object, uint32_t index, Ptr<Object> &item) const
+{
+  NS_LOG_FUNCTION (this << object << index);
+  uint32_t n;
+  if (!DoGetN (object, &n) || index >= n)
+    {
+      return false;
+    }
+  // An ObjectMap may hold another key at this position
+  uint32_t found;
+  Ptr<Object> o = DoGet (object, index, &found);
+  if (found != index)
+    {
+      return false;
+    }
+  item = o;
+  return true;
+}
+// <M>
 bool 
 ObjectPtrContainerAccessor::HasGetter (void) const
 {
@@ -220,6 +220,19 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  // <M>
+  /**
+   * Get the instance with a given index without copying the container,
+   * when the container is indexed by position, like an ObjectVector.
+   *
+   * \param [in] object The container object.
+   * \param [in] index The index of the instance.
+   * \param [out] item The instance with that index.
+   * \returns \c true if \p item is the instance with that index, \c false
+   *          if the index must be searched in the whole container.
+   */
+  bool GetByIndex (const ObjectBase * object, uint32_t index, Ptr<Object> &item) const;
+  // <M>
 private:
   /**
    * Get the number of instances in the container.
@@ -24,6 +24,9 @@
 #include "ptr.h"
 #include "attribute.h"
 #include "object-ptr-container.h"
+// <M>
+#include <iterator>
+// <M>
 
 /**
  * \file
@@ -93,21 +96,14 @@ MakeObjectVectorAccessor (U T::*memberVector)
     }
     virtual Ptr<Object> DoGet (const ObjectBase *object, uint32_t i, uint32_t *index) const {
       const T *obj = static_cast<const T *> (object);
-      typename U::const_iterator begin = (obj->*m_memberVector).begin ();
-      typename U::const_iterator end = (obj->*m_memberVector).end ();
-      uint32_t k = 0;
-      for (typename U::const_iterator j = begin; j != end; j++, k++)
-        {
-          if (k == i)
-            {
-              *index = k;
-              return *j;
-              break;
-            }
-        }
-      NS_ASSERT (false);
-      // quiet compiler.
-      return 0;
+      // <M>
+      // constant time on a std::vector
+      NS_ASSERT (i < (obj->*m_memberVector).size ());
+      typename U::const_iterator j = (obj->*m_memberVector).begin ();
+      std::advance (j, i);
+      *index = i;
+      return *j;
+      // <M>
     }
     U T::*m_memberVector;
   } *spec = new MemberStdContainer ();
@@ -97,11 +97,12 @@ Object::Object ()
   : m_tid (Object::GetTypeId ()),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
+    // <M>
+    m_aggregates (AllocateAggregates (1)),
+    // <M>
     m_getObjectCount (0)
 {
   NS_LOG_FUNCTION (this);
-  m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object () 
@@ -120,6 +121,10 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // <M>
+  // the lookups of the remaining objects may have found this one
+  std::memset (m_aggregates->cache, 0, sizeof (m_aggregates->cache));
+  // <M>
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
@@ -132,10 +137,11 @@ Object::Object (const Object &o)
   : m_tid (o.m_tid),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
+    // <M>
+    m_aggregates (AllocateAggregates (1)),
+    // <M>
     m_getObjectCount (0)
 {
-  m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -151,6 +157,15 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  // <M>
+  uint16_t uid = tid.GetUid ();
+  struct AggregatesCache *cached = &m_aggregates->cache[uid % AGGREGATES_CACHE_SIZE];
+  if (cached->tid == uid)
+    {
+      return cached->object;
+    }
+  // <M>
+
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -173,6 +188,11 @@ Object::DoGetObject (TypeId tid) const
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
+          // <M>
+          // and remember it until the aggregation changes
+          cached->tid = uid;
+          cached->object = current;
+          // <M>
           // finally, return the match
           return const_cast<Object *> (current);
         }
@@ -229,6 +249,18 @@ restart:
         }
     }
 }
+// <M>
+struct Object::Aggregates *
+Object::AllocateAggregates (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  struct Aggregates *aggregates =
+    (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(n-1)*sizeof(Object*));
+  aggregates->n = n;
+  std::memset (aggregates->cache, 0, sizeof (aggregates->cache));
+  return aggregates;
+}
+// <M>
 void
 Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
 {
@@ -261,9 +293,9 @@ Object::AggregateObject (Ptr<Object> o)
   Object *other = PeekPointer (o);
   // first create the new aggregate buffer.
   uint32_t total = m_aggregates->n + other->m_aggregates->n;
-  struct Aggregates *aggregates = 
-    (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
-  aggregates->n = total;
+  // <M>
+  struct Aggregates *aggregates = AllocateAggregates (total);
+  // <M>
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0], 
@@ -328,12 +328,39 @@ private:
    * variable sized buffer whose size is indicated by the element
    * \c n
    */
+  // <M>
+  /** A GetObject lookup which found an Object of the aggregates. */
+  struct AggregatesCache {
+    /** Uid of the TypeId looked up, 0 if the entry is empty. */
+    uint16_t tid;
+    /** The Object found. */
+    Object *object;
+  };
+  /** Number of entries of the lookup cache, indexed by TypeId uid. */
+  enum { AGGREGATES_CACHE_SIZE = 8 };
+  // <M>
   struct Aggregates {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    // <M>
+    /**
+     * The lookups found by DoGetObject, direct-mapped by TypeId uid.
+     * A new aggregation allocates new Aggregates, with an empty cache.
+     */
+    struct AggregatesCache cache[AGGREGATES_CACHE_SIZE];
+    // <M>
     /** The array of Objects. */
     Object *buffer[1];
   };
+  // <M>
+  /**
+   * Allocate Aggregates with an empty lookup cache.
+   *
+   * \param [in] n The number of entries in \c buffer.
+   * \return The Aggregates, to be freed with std::free.
+   */
+  static struct Aggregates * AllocateAggregates (uint32_t n);
+  // <M>
 
   /**
    * Find an Object of TypeId tid in the aggregates of this Object.
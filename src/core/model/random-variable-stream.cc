@@ -35,6 +35,9 @@
 #include "rng-seed-manager.h"
 #include <cmath>
 #include <iostream>
+// <M>
+#include <algorithm>
+// <M>
 
 /**
  * \file
@@ -137,6 +140,18 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+// <M>
+void
+RandomVariableStream::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; i++)
+    {
+      values[i] = GetValue ();
+    }
+}
+// <M>
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -207,6 +222,28 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+// <M>
+void
+UniformRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  Peek ()->RandU01 (values, n);
+  // Separate loops, without branches, for the compiler to vectorize
+  double min = m_min;
+  double max = m_max;
+  for (std::size_t i = 0; i < n; i++)
+    {
+      values[i] = min + values[i] * (max - min);
+    }
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; i++)
+        {
+          values[i] = min + (max - values[i]);
+        }
+    }
+}
+// <M>
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -444,6 +481,36 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+// <M>
+void
+ExponentialRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double mean = m_mean;
+  double bound = m_bound;
+  bool antithetic = IsAntithetic ();
+  std::size_t done = 0;
+  while (done < n)
+    {
+      // Each value takes at least one uniform: draw one per value missing,
+      // the values accepted are written over the uniforms in order
+      Peek ()->RandU01 (values + done, n - done);
+      for (std::size_t i = done; i < n; i++)
+        {
+          double v = values[i];
+          if (antithetic)
+            {
+              v = (1 - v);
+            }
+          double r = -mean*std::log (v);
+          if (bound == 0 || r <= bound)
+            {
+              values[done++] = r;
+            }
+        }
+    }
+}
+// <M>
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -709,16 +776,13 @@ NormalRandomVariable::GetValue (double mean, double variance, double bound)
           u1 = (1 - u1);
           u2 = (1 - u2);
         }
-      double v1 = 2 * u1 - 1;
-      double v2 = 2 * u2 - 1;
-      double w = v1 * v1 + v2 * v2;
-      if (w <= 1.0)
+      // <M>
+      double x1;
+      if (Transform (u1, u2, mean, variance, x1, m_next))
         { // Got good pair
-          double y = std::sqrt ((-2 * std::log (w)) / w);
-          m_next = mean + v2 * y * std::sqrt (variance);
           // if next is in bounds, it is valid
           m_nextValid = std::fabs (m_next - mean) <= bound;
-          double x1 = mean + v1 * y * std::sqrt (variance);
+      // <M>
           // if x1 is in bounds, return it
           if (std::fabs (x1 - mean) <= bound)
             {
@@ -754,6 +818,86 @@ NormalRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
+// <M>
+bool
+NormalRandomVariable::Transform (double u1, double u2, double mean, double variance,
+                                 double &x1, double &x2) const
+{
+  double v1 = 2 * u1 - 1;
+  double v2 = 2 * u2 - 1;
+  double w = v1 * v1 + v2 * v2;
+  if (w > 1.0)
+    {
+      return false;
+    }
+  double y = std::sqrt ((-2 * std::log (w)) / w);
+  x2 = mean + v2 * y * std::sqrt (variance);
+  x1 = mean + v1 * y * std::sqrt (variance);
+  return true;
+}
+
+void
+NormalRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  /* Pairs of uniforms drawn at once. */
+  const std::size_t PAIRS = 128;
+  double u[2 * PAIRS];
+  std::size_t i = 0;
+  if (n > 0 && m_nextValid)
+    { // use previously generated
+      m_nextValid = false;
+      values[i++] = m_next;
+    }
+  bool antithetic = IsAntithetic ();
+  while (i < n)
+    {
+      // A pair gives at most two values: GetValue would draw every pair
+      // needed for the values missing, and these only
+      std::size_t pairs = std::min ((n - i + 1) / 2, PAIRS);
+      Peek ()->RandU01 (u, 2 * pairs);
+      if (antithetic)
+        {
+          for (std::size_t j = 0; j < 2 * pairs; j++)
+            {
+              u[j] = (1 - u[j]);
+            }
+        }
+      for (std::size_t j = 0; j < pairs; j++)
+        {
+          double x1;
+          double x2;
+          if (!Transform (u[2 * j], u[2 * j + 1], m_mean, m_variance, x1, x2))
+            {
+              continue;
+            }
+          bool valid1 = std::fabs (x1 - m_mean) <= m_bound;
+          bool valid2 = std::fabs (x2 - m_mean) <= m_bound;
+          if (valid1)
+            {
+              values[i++] = x1;
+            }
+          else if (valid2)
+            {
+              values[i++] = x2;
+              valid2 = false;
+            }
+          if (valid2)
+            {
+              if (i < n)
+                {
+                  values[i++] = x2;
+                }
+              else
+                {
+                  m_next = x2;
+                  m_nextValid = true;
+                }
+            }
+        }
+    }
+}
+// <M>
 
 NS_OBJECT_ENSURE_REGISTERED(LogNormalRandomVariable);
 
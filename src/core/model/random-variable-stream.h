@@ -30,6 +30,9 @@
 #include "object.h"
 #include "attribute-helper.h"
 #include <stdint.h>
+// <M>
+#include <cstddef>
+// <M>
 
 /**
  * \file
@@ -149,6 +152,20 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  // <M>
+  /**
+   * \brief Get the next random values as doubles drawn from the distribution.
+   *
+   * The values are the ones \p n calls to GetValue (void) would return.
+   * This implementation makes these calls, the Uniform, Exponential and
+   * Normal distributions draw all their uniforms at once.
+   *
+   * \param [out] values The random values.
+   * \param [in] n The number of random values.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+  // <M>
+
 protected:
   /**
    * \brief Get the pointer to the underlying RNG stream.
@@ -293,6 +310,9 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  // <M>
+  virtual void GetValues (double *values, std::size_t n);
+  // <M>
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -585,6 +605,9 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  // <M>
+  virtual void GetValues (double *values, std::size_t n);
+  // <M>
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -1243,7 +1266,29 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  // <M>
+  // Inherited from RandomVariableStream
+  virtual void GetValues (double *values, std::size_t n);
+  // <M>
+
 private:
+  // <M>
+  /**
+   * Transform a pair of uniforms into a pair of values, the x1 and x2
+   * of GetInteger (void).
+   *
+   * \param [in] u1 The first uniform.
+   * \param [in] u2 The second uniform.
+   * \param [in] mean Mean value for the normal distribution.
+   * \param [in] variance Variance value for the normal distribution.
+   * \param [out] x1 The first value.
+   * \param [out] x2 The second value.
+   * \return \c false if the pair is rejected.
+   */
+  bool Transform (double u1, double u2, double mean, double variance,
+                  double &x1, double &x2) const;
+  // <M>
+
   /** The mean value for the normal distribution returned by this RNG stream. */
   double m_mean;
 
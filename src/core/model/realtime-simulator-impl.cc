@@ -529,6 +529,9 @@ RealtimeSimulatorImpl::Schedule (Time const &delay, EventImpl *impl)
     ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
     ev.key.m_context = GetContext ();
     ev.key.m_uid = m_uid;
+    // <M>
+    ev.key.m_eventType = impl->GetEventType ();
+    // <M>
     m_uid++;
     m_unscheduledEvents++;
     m_events->Insert (ev);
@@ -567,6 +570,9 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     ev.key.m_ts = ts;
     ev.key.m_context = context;
     ev.key.m_uid = m_uid;
+    // <M>
+    ev.key.m_eventType = impl->GetEventType ();
+    // <M>
     m_uid++;
     m_unscheduledEvents++;
     m_events->Insert (ev);
@@ -586,6 +592,9 @@ RealtimeSimulatorImpl::ScheduleNow (EventImpl *impl)
     ev.key.m_ts = m_currentTs;
     ev.key.m_context = GetContext ();
     ev.key.m_uid = m_uid;
+    // <M>
+    ev.key.m_eventType = impl->GetEventType ();
+    // <M>
     m_uid++;
     m_unscheduledEvents++;
     m_events->Insert (ev);
@@ -618,6 +627,9 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
     ev.impl = impl;
     ev.key.m_ts = ts;
     ev.key.m_uid = m_uid;
+    // <M>
+    ev.key.m_eventType = impl->GetEventType ();
+    // <M>
     m_uid++;
     m_unscheduledEvents++;
     m_events->Insert (ev);
@@ -650,6 +662,9 @@ RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventIm
     ev.impl = impl;
     ev.key.m_ts = ts;
     ev.key.m_uid = m_uid;
+    // <M>
+    ev.key.m_eventType = impl->GetEventType ();
+    // <M>
     ev.key.m_context = context;
     m_uid++;
     m_unscheduledEvents++;
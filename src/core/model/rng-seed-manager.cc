@@ -23,6 +23,9 @@
 #include "integer.h"
 #include "config.h"
 #include "log.h"
+// <M>
+#include "atomic-count.h"
+// <M>
 
 /**
  * \file
@@ -94,9 +97,10 @@ uint64_t RngSeedManager::GetRun ()
 uint64_t RngSeedManager::GetNextStreamIndex (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint64_t next = g_nextStreamIndex;
-  g_nextStreamIndex++;
-  return next;
+  // <M>
+  // sockets, and their streams, may be created by several nodes at once
+  return AtomicIncrement (g_nextStreamIndex) - 1;
+  // <M>
 }
 
 } // namespace ns3
@@ -21,6 +21,9 @@
 #define RNGSTREAM_H
 #include <string>
 #include <stdint.h>
+// <M>
+#include <cstddef>
+// <M>
 
 /**
  * \file
@@ -70,6 +73,21 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  // <M>
+  /**
+   * Generate the next \p n random numbers for this stream, the same as
+   * \p n calls to RandU01 (void).
+   *
+   * The state stays in registers through the loop. The recurrence
+   * carries a dependency from one number to the next, so the numbers
+   * are not computed side by side: jumping each lane ahead would need a
+   * full modular matrix product per number.
+   *
+   * \param [out] values The random numbers.
+   * \param [in] n The number of random numbers.
+   */
+  void RandU01 (double *values, std::size_t n);
+  // <M>
 
 private:
   /**
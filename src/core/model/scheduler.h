@@ -94,6 +94,7 @@ public:
      bool m_isWaiting;
      std::vector<uint32_t> m_interface;	/**< Interface number for connected nodes. */
      std::vector<uint32_t> m_inPackets; /**< Incoming packets at each interface*/	  
+     uint32_t m_emptyInterfaces; /**< Interfaces with no incoming packet. */
   };
   // <M>
 
@@ -107,11 +108,12 @@ public:
     uint32_t m_uid;        /**< Event unique id. */
     uint32_t m_context;    /**< Event context. */
     // <M>
-    uint32_t m_prevContext;	/**< For transmission event. */
+    // Widest members first, the key is copied with every event
     uint64_t m_originalTs; /**< Original time stamp before making symbolic. */
-    bool m_isTransEvent;   /**< True if event is a transmission event. */
+    uint32_t m_prevContext;	/**< For transmission event. */
     uint32_t m_packetSize;
     EventSchedulers_t m_eventType;
+    bool m_isTransEvent;   /**< True if event is a transmission event. */
     // <M>
   };
   /**
@@ -123,10 +125,19 @@ public:
    */
   struct Event
   {
+    // <M>
+    /** Constructor, with no implementation and nothing waiting. */
+    Event ();
+    // <M>
     EventImpl *impl;       /**< Pointer to the event implementation. */
     EventKey key;          /**< Key for sorting and ordering Events. */
     // <M>
-    std::list<Event> pendingEvents;
+    /**
+     * First node of the events waiting on this one in the arena of the
+     * ListScheduler, 0 if none. Every Event is built with none, the
+     * ListScheduler::Insert of a copied Event resets it as well.
+     */
+    uint32_t pending;
     // <M>
   };
 
@@ -260,6 +271,15 @@ inline bool operator < (const Scheduler::Event &a,
   return a.key < b.key;
 }
 
+// <M>
+inline
+Scheduler::Event::Event ()
+  : impl (0),
+    pending (0)
+{
+}
+// <M>
+
 
 } // namespace ns3
 
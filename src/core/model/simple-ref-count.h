@@ -25,6 +25,9 @@
 #include "empty.h"
 #include "default-deleter.h"
 #include "assert.h"
+// <M>
+#include "atomic-count.h"
+// <M>
 #include <stdint.h>
 #include <limits>
 
@@ -100,7 +103,9 @@ public:
   inline void Ref (void) const
   {
     NS_ASSERT (m_count < std::numeric_limits<uint32_t>::max());
-    m_count++;
+    // <M>
+    AtomicIncrement (m_count);
+    // <M>
   }
   /**
    * Decrement the reference count. This method should not be called
@@ -110,8 +115,9 @@ public:
    */
   inline void Unref (void) const
   {
-    m_count--;
-    if (m_count == 0)
+    // <M>
+    if (AtomicDecrement (m_count) == 0)
+    // <M>
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
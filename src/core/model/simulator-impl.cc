@@ -66,5 +66,20 @@ void
 SimulatorImpl::SetInterfaceInfo (std::vector<std::vector<uint32_t> > interfaces)
 {
 }
+
+void
+SimulatorImpl::SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency)
+{
+}
+
+void
+SimulatorImpl::SetNativeFastForward (std::string forkReportFile, std::vector<uint64_t> intervals)
+{
+}
+
+void
+SimulatorImpl::SetImplementations (std::vector<bool> implementations)
+{
+}
 	
 } // namespace ns3
@@ -73,6 +73,9 @@ public:
   virtual void SetNumberSymPackets (uint32_t numpackets);
   virtual void SetFirstSymPacket (uint64_t firstSymPacket);
   virtual void SetInterfaceInfo (std::vector<std::vector<uint32_t> > interfaces);
+  virtual void SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency);
+  virtual void SetNativeFastForward (std::string forkReportFile, std::vector<uint64_t> intervals);
+  virtual void SetImplementations (std::vector<bool> implementations);
   // <M>
   /** \copydoc Simulator::ScheduleNow(const Ptr<EventImpl>&) */
   virtual EventId ScheduleNow (EventImpl *event) = 0;
@@ -208,6 +208,52 @@ Simulator::SetInterfaceInfo (std::vector<std::vector<uint32_t> > interfaces)
 {
   GetImpl ()->SetInterfaceInfo (interfaces);	
 }
+
+void
+Simulator::SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency)
+{
+  GetImpl ()->SetImpactLatency (impactLatency);
+}
+
+/**
+ * \ingroup simulator
+ * \brief Get the impact latency source.
+ * \return The source registered by Simulator::SetImpactLatencySource().
+ */
+static Callback<std::vector<std::vector<uint64_t> > > *PeekImpactLatencySource (void)
+{
+  static Callback<std::vector<std::vector<uint64_t> > > source;
+  return &source;
+}
+
+void
+Simulator::SetImpactLatencySource (Callback<std::vector<std::vector<uint64_t> > > source)
+{
+  *PeekImpactLatencySource () = source;
+}
+
+std::vector<std::vector<uint64_t> >
+Simulator::GetTopologyImpactLatency (void)
+{
+  Callback<std::vector<std::vector<uint64_t> > > source = *PeekImpactLatencySource ();
+  if (source.IsNull ())
+    {
+      return std::vector<std::vector<uint64_t> > ();
+    }
+  return source ();
+}
+
+void
+Simulator::SetNativeFastForward (std::string forkReportFile, std::vector<uint64_t> intervals)
+{
+  GetImpl ()->SetNativeFastForward (forkReportFile, intervals);
+}
+
+void
+Simulator::SetImplementations (std::vector<bool> implementations)
+{
+  GetImpl ()->SetImplementations (implementations);
+}
 // <M>
 
 void
@@ -274,6 +320,21 @@ Simulator::ScheduleNow (const Ptr<EventImpl> &ev)
 {
   return DoScheduleNow (GetPointer (ev));
 }
+// <M>
+EventId
+Simulator::Schedule (Time const &delay, Scheduler::EventSchedulers_t type, EventImpl *event)
+{
+  event->SetEventType (type);
+  return DoSchedule (delay, event);
+}
+
+EventId
+Simulator::ScheduleNow (Scheduler::EventSchedulers_t type, EventImpl *event)
+{
+  event->SetEventType (type);
+  return DoScheduleNow (event);
+}
+// <M>
 void
 Simulator::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *impl)
 {
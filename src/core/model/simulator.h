@@ -27,6 +27,7 @@
 #include "nstime.h"
 
 #include "object-factory.h"
+#include "callback.h"
 
 #include <stdint.h>
 #include <string>
@@ -75,6 +76,55 @@ public:
   static void SetNumberSymPackets (uint32_t numpackets);
   static void SetFirstSymPacket (uint64_t firstSymPacket);
   static void SetInterfaceInfo (std::vector<std::vector<uint32_t> > interfaces);
+  /**
+   * Set the impact latency matrix used by the local lists: entry [i][j] is
+   * the shortest delay, in time steps, for an event at node i to affect node j.
+   */
+  static void SetImpactLatency (std::vector<std::vector<uint64_t> > impactLatency);
+  /**
+   * Register the function computing the impact latency matrix of the
+   * topology. Nothing is computed here: the simulator implementations
+   * that need the matrix ask GetTopologyImpactLatency() for it, once the
+   * topology is built.
+   *
+   * \param [in] source The function returning the matrix.
+   */
+  static void SetImpactLatencySource (Callback<std::vector<std::vector<uint64_t> > > source);
+  /**
+   * \returns The impact latency matrix of the registered source, empty
+   * if no source is registered.
+   */
+  static std::vector<std::vector<uint64_t> > GetTopologyImpactLatency (void);
+  /**
+   * Run concretely until the default SymbolicInjectionPolicy selects its
+   * first packet. Once the event that selected it is over, one native
+   * child process is forked per interval, each running the rest of the
+   * simulation with that interval as the policy default, the first packet
+   * included. The children run on the DelayExplorer workers, see
+   * DelayExplorer::SetWorkers, and the DelayExplorer must be enabled: the
+   * explorations continue from the memory of this process, which S2E
+   * runs cannot restart from, so they replay the concrete prefix.
+   * In the parent, Simulator::Run returns once all the children are done.
+   *
+   * A text report of the fork point (the packet, the clocks and the
+   * scheduled events) is written to forkReportFile for inspection; it
+   * cannot be loaded back.
+   *
+   * \param [in] forkReportFile The file the report is written to.
+   * \param [in] intervals The symbolic intervals to explore, in time steps.
+   */
+  static void SetNativeFastForward (std::string forkReportFile, std::vector<uint64_t> intervals);
+  /**
+   * Select the optimisations of the DefaultSimulatorImpl and the
+   * ListScheduler, before any event is scheduled. Entry i enables
+   * implementation i: path reduction, removal of inactive events,
+   * waiting list, local lists and clocks, end of simulation, local
+   * lists v2, indexed lists, head heap, symbolic window and path cache.
+   * Missing entries keep their current value.
+   *
+   * \param [in] implementations The flags, in that order.
+   */
+  static void SetImplementations (std::vector<bool> implementations);
   // <M>
 
   /**
@@ -1150,6 +1200,18 @@ public:
    */
   static EventId Schedule (Time const &delay, const Ptr<EventImpl> &event);
 
+  /**
+   * <M>
+   * Schedule a future event execution (in the same context), tagging it
+   * with the type used by the ListScheduler.
+   *
+   * @param [in] delay Delay until the event expires.
+   * @param [in] type The type of the event.
+   * @param [in] event The event to schedule.
+   * @returns A unique identifier for the newly-scheduled event.
+   */
+  static EventId Schedule (Time const &delay, Scheduler::EventSchedulers_t type, EventImpl *event);
+
   /**
    * Schedule a future event execution (in a different context).
    * This method is thread-safe: it can be called from any thread.
@@ -1184,6 +1246,17 @@ public:
    */
   static EventId ScheduleNow (const Ptr<EventImpl> &event);
 
+  /**
+   * <M>
+   * Schedule an event to run at the current virtual time, tagging it with
+   * the type used by the ListScheduler.
+   *
+   * @param [in] type The type of the event.
+   * @param [in] event The event to schedule.
+   * @returns A unique identifier for the newly-scheduled event.
+   */
+  static EventId ScheduleNow (Scheduler::EventSchedulers_t type, EventImpl *event);
+
   /**
    * Get the system id of this simulator.
    *
@@ -0,0 +1,320 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "symbolic-injection-policy.h"
+#include "list-scheduler.h"
+#include "symbolic-trace.h"
+#include "string.h"
+#include "uinteger.h"
+#include "enum.h"
+#include "trace-source-accessor.h"
+#include "log.h"
+#include "abort.h"
+#include <sstream>
+#include <algorithm>
+#include "s2e.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::SymbolicInjectionPolicy class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SymbolicInjectionPolicy");
+
+NS_OBJECT_ENSURE_REGISTERED (SymbolicInjectionPolicy);
+
+TypeId
+SymbolicInjectionPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SymbolicInjectionPolicy")
+    .SetParent<Object> ()
+    .SetGroupName ("Core")
+    .AddConstructor<SymbolicInjectionPolicy> ()
+    .AddAttribute ("Links",
+                   "The symbolic links, separated by spaces. A link is written "
+                   "node1-node2, optionally followed by :interval to override "
+                   "the Interval attribute, or by :minimum-interval to override "
+                   "the MinimumDelay attribute as well. Links work in both "
+                   "directions.",
+                   StringValue ("0-2"),
+                   MakeStringAccessor (&SymbolicInjectionPolicy::SetLinks,
+                                       &SymbolicInjectionPolicy::GetLinks),
+                   MakeStringChecker ())
+    .AddAttribute ("Packets",
+                   "The ranks of the symbolic packets on each link, counting "
+                   "from 1, as ranges first-last separated by spaces.",
+                   StringValue (""),
+                   MakeStringAccessor (&SymbolicInjectionPolicy::SetPackets,
+                                       &SymbolicInjectionPolicy::GetPackets),
+                   MakeStringChecker ())
+    .AddAttribute ("Interval",
+                   "The range of the symbolic values, in time steps.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&SymbolicInjectionPolicy::m_interval),
+                   MakeUintegerChecker<uint64_t> (1))
+    .AddAttribute ("MinimumDelay",
+                   "The smallest symbolic value, in time steps, for instance "
+                   "a minimum propagation delay. At most the interval.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&SymbolicInjectionPolicy::m_minimum),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Target",
+                   "What is made symbolic for the selected packets.",
+                   EnumValue (SymbolicInjectionPolicy::DELAY),
+                   MakeEnumAccessor (&SymbolicInjectionPolicy::m_target),
+                   MakeEnumChecker (SymbolicInjectionPolicy::DELAY, "Delay",
+                                    SymbolicInjectionPolicy::DROP, "Drop",
+                                    SymbolicInjectionPolicy::REORDER, "Reorder"))
+    .AddTraceSource ("SymbolicPacket",
+                     "A packet has been selected, its symbolic value is "
+                     "injected once the trace returns.",
+                     MakeTraceSourceAccessor (&SymbolicInjectionPolicy::m_symbolicPacketTrace),
+                     "ns3::SymbolicInjectionPolicy::SymbolicPacketCallback")
+  ;
+  return tid;
+}
+
+SymbolicInjectionPolicy::SymbolicInjectionPolicy ()
+  : m_firstPacket (0),
+    m_numberPackets (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SymbolicInjectionPolicy::~SymbolicInjectionPolicy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<SymbolicInjectionPolicy>
+SymbolicInjectionPolicy::GetDefault (void)
+{
+  static Ptr<SymbolicInjectionPolicy> policy = CreateObject<SymbolicInjectionPolicy> ();
+  return policy;
+}
+
+void
+SymbolicInjectionPolicy::SetInterval (uint64_t interval)
+{
+  NS_LOG_FUNCTION (this << interval);
+  m_interval = interval;
+}
+
+void
+SymbolicInjectionPolicy::SetFirstPacket (uint64_t first)
+{
+  NS_LOG_FUNCTION (this << first);
+  m_firstPacket = first;
+  m_packets.clear ();
+  if (m_numberPackets > 0)
+    {
+      // the packets are counted from 1, the first packet being selected
+      // from 0 on as by the former ListScheduler counter
+      uint64_t rank = std::max<uint64_t> (m_firstPacket, 1);
+      m_packets.push_back (Range (rank, rank + m_numberPackets - 1));
+    }
+}
+
+void
+SymbolicInjectionPolicy::SetNumberPackets (uint64_t number)
+{
+  NS_LOG_FUNCTION (this << number);
+  m_numberPackets = number;
+  SetFirstPacket (m_firstPacket);
+}
+
+void
+SymbolicInjectionPolicy::SetLinks (std::string links)
+{
+  NS_LOG_FUNCTION (this << links);
+  m_links.clear ();
+  std::istringstream iss (links);
+  std::string entry;
+  while (iss >> entry)
+    {
+      Link link;
+      char dash;
+      char colon = ':';
+      char range = '-';
+      link.interval = 0;
+      link.minimum = 0;
+      link.hasMinimum = false;
+      link.packets = 0;
+      std::istringstream is (entry);
+      is >> link.node1 >> dash >> link.node2;
+      if (!is.eof ())
+        {
+          is >> colon >> link.interval;
+        }
+      if (!is.fail () && !is.eof ())
+        {
+          // the first value was the minimum
+          link.minimum = link.interval;
+          link.hasMinimum = true;
+          is >> range >> link.interval;
+        }
+      NS_ABORT_MSG_IF (is.fail () || dash != '-' || colon != ':' || range != '-' || !is.eof ()
+                       || (link.hasMinimum && (link.interval == 0 || link.minimum > link.interval)),
+                       "Invalid symbolic link \"" << entry << "\"");
+      m_links.push_back (link);
+    }
+}
+
+std::string
+SymbolicInjectionPolicy::GetLinks (void) const
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_links.size (); i++)
+    {
+      oss << (i == 0 ? "" : " ") << m_links[i].node1 << "-" << m_links[i].node2;
+      if (m_links[i].hasMinimum)
+        {
+          oss << ":" << m_links[i].minimum << "-" << m_links[i].interval;
+        }
+      else if (m_links[i].interval != 0)
+        {
+          oss << ":" << m_links[i].interval;
+        }
+    }
+  return oss.str ();
+}
+
+void
+SymbolicInjectionPolicy::SetPackets (std::string packets)
+{
+  NS_LOG_FUNCTION (this << packets);
+  m_packets.clear ();
+  std::istringstream iss (packets);
+  std::string entry;
+  while (iss >> entry)
+    {
+      Range range;
+      char dash;
+      std::istringstream is (entry);
+      is >> range.first >> dash >> range.second;
+      NS_ABORT_MSG_IF (is.fail () || dash != '-' || !is.eof () || range.first > range.second,
+                       "Invalid symbolic packet range \"" << entry << "\"");
+      m_packets.push_back (range);
+    }
+}
+
+std::string
+SymbolicInjectionPolicy::GetPackets (void) const
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_packets.size (); i++)
+    {
+      oss << (i == 0 ? "" : " ") << m_packets[i].first << "-" << m_packets[i].second;
+    }
+  return oss.str ();
+}
+
+const SymbolicInjectionPolicy::Link *
+SymbolicInjectionPolicy::FindLink (uint32_t src, uint32_t dst) const
+{
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); i++)
+    {
+      if ((i->node1 == src && i->node2 == dst) || (i->node1 == dst && i->node2 == src))
+        {
+          return &(*i);
+        }
+    }
+  return 0;
+}
+
+uint64_t
+SymbolicInjectionPolicy::GetInterval (uint32_t src, uint32_t dst) const
+{
+  const Link *link = FindLink (src, dst);
+  if (link == 0)
+    {
+      return 0;
+    }
+  return link->interval != 0 ? link->interval : m_interval;
+}
+
+uint64_t
+SymbolicInjectionPolicy::GetMinimum (uint32_t src, uint32_t dst) const
+{
+  const Link *link = FindLink (src, dst);
+  if (link == 0)
+    {
+      return 0;
+    }
+  return link->hasMinimum ? link->minimum : m_minimum;
+}
+
+bool
+SymbolicInjectionPolicy::IsSymbolicPacket (uint64_t rank) const
+{
+  for (std::vector<Range>::const_iterator i = m_packets.begin (); i != m_packets.end (); i++)
+    {
+      if (rank >= i->first && rank <= i->second)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+SymbolicInjectionPolicy::Inject (uint32_t src, uint32_t dst, uint64_t maxAdvance)
+{
+  NS_LOG_FUNCTION (this << src << dst << maxAdvance);
+  Link *link = const_cast<Link *> (FindLink (src, dst));
+  if (link == 0)
+    {
+      return true;
+    }
+  link->packets++;
+  if (!IsSymbolicPacket (link->packets))
+    {
+      return true;
+    }
+  m_symbolicPacketTrace (src, dst, link->packets);
+
+  uint64_t interval = GetInterval (src, dst);
+  uint64_t minimum = GetMinimum (src, dst);
+  NS_ABORT_MSG_IF (minimum > interval, "Minimum symbolic value " << minimum
+                   << " above the interval " << interval << " of link " << src << "-" << dst);
+  switch (m_target)
+    {
+    case DELAY:
+      ListScheduler::SetSymbolicDelay (interval, false, minimum);
+      return true;
+    case REORDER:
+      {
+        uint64_t advance = std::min (interval, maxAdvance);
+        ListScheduler::SetSymbolicDelay (advance, true, std::min (minimum, advance));
+        return true;
+      }
+    case DROP:
+      {
+        uint8_t drop;
+        s2e_enable_forking ();
+        s2e_make_symbolic (&drop, sizeof (drop), "Symbolic Drop");
+        SymbolicTrace::Symbolic (SymbolicTrace::SYMBOLIC_DROP, 0, src,
+                                 "Symbolic Drop", drop, 0);
+        return drop == 0;
+      }
+    }
+  return true;
+}
+
+} // namespace ns3
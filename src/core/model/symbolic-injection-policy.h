@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SYMBOLIC_INJECTION_POLICY_H
+#define SYMBOLIC_INJECTION_POLICY_H
+
+#include "object.h"
+#include "ptr.h"
+#include "traced-callback.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::SymbolicInjectionPolicy class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief Decide which transmissions get a symbolic value under S2E.
+ *
+ * Channels consult the policy for every packet they deliver. A packet is
+ * made symbolic when it crosses one of the configured links and its rank
+ * on that link, counting from 1, falls in one of the packet ranges. The
+ * target then says what is symbolic:
+ *
+ * - Delay: the arrival time is delayed by a symbolic amount in
+ *   [minimum, interval] time steps (inserted by the ListScheduler),
+ * - Drop: whether the packet is delivered at all,
+ * - Reorder: the arrival time is advanced by a symbolic amount in
+ *   [minimum, interval] time steps, bounded by the transmission delay, so
+ *   that the packet may overtake packets still in flight.
+ *
+ * The minimum, 0 by default, is for instance a minimum propagation
+ * delay. The symbolic value is only constrained to its range, values out
+ * of it are never explored.
+ *
+ * Channels without their own policy use GetDefault(), whose attributes
+ * can be set through Config::SetDefault.
+ */
+class SymbolicInjectionPolicy : public Object
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** What is made symbolic. */
+  enum Target
+  {
+    DELAY,   /**< Symbolic extra delay. */
+    DROP,    /**< Symbolic loss. */
+    REORDER  /**< Symbolic advance of the arrival. */
+  };
+
+  SymbolicInjectionPolicy ();
+  virtual ~SymbolicInjectionPolicy ();
+
+  /**
+   * \returns The policy shared by the channels that have none of their own.
+   */
+  static Ptr<SymbolicInjectionPolicy> GetDefault (void);
+
+  /**
+   * \param [in] interval The interval of links without their own.
+   */
+  void SetInterval (uint64_t interval);
+  /**
+   * Make the packets in [first, first + number) symbolic, replacing
+   * the packet ranges.
+   * \param [in] first The rank of the first symbolic packet, 0 standing
+   *        for 1 as the packets are counted from 1.
+   */
+  void SetFirstPacket (uint64_t first);
+  /**
+   * \param [in] number The number of symbolic packets from the first one.
+   */
+  void SetNumberPackets (uint64_t number);
+
+  /**
+   * \param [in] src The sending node.
+   * \param [in] dst The receiving node.
+   * \returns The interval of the link in time steps, 0 if it is not symbolic.
+   */
+  uint64_t GetInterval (uint32_t src, uint32_t dst) const;
+  /**
+   * \param [in] src The sending node.
+   * \param [in] dst The receiving node.
+   * \returns The smallest symbolic value of the link in time steps.
+   */
+  uint64_t GetMinimum (uint32_t src, uint32_t dst) const;
+  /**
+   * \param [in] rank The rank of a packet on its link.
+   * \returns \c true if the packet falls in one of the packet ranges.
+   */
+  bool IsSymbolicPacket (uint64_t rank) const;
+
+  /**
+   * Count a packet sent from src to dst and, if it is symbolic, inject
+   * the symbolic value. For a delay or a reordering the value goes to the
+   * next event inserted in the ListScheduler, that is the reception the
+   * channel schedules right after this call.
+   *
+   * \param [in] src The sending node.
+   * \param [in] dst The receiving node.
+   * \param [in] maxAdvance The largest advance of the arrival, in time
+   *             steps, that keeps it after the transmission.
+   * \returns \c false if the packet must be dropped.
+   */
+  bool Inject (uint32_t src, uint32_t dst, uint64_t maxAdvance);
+
+  /**
+   * TracedCallback signature for selected packets.
+   *
+   * \param [in] src The sending node.
+   * \param [in] dst The receiving node.
+   * \param [in] rank The rank of the packet on its link.
+   */
+  typedef void (* SymbolicPacketCallback)(uint32_t src, uint32_t dst, uint64_t rank);
+
+private:
+  /** A symbolic link, in both directions. */
+  struct Link
+  {
+    uint32_t node1;     /**< One end. */
+    uint32_t node2;     /**< The other end. */
+    uint64_t interval;  /**< Interval of the link, 0 for the default one. */
+    uint64_t minimum;   /**< Smallest value of the link, if hasMinimum. */
+    bool hasMinimum;    /**< \c false to use the default minimum. */
+    uint64_t packets;   /**< Packets sent on the link so far. */
+  };
+  /** A range of packet ranks, both ends included. */
+  typedef std::pair<uint64_t, uint64_t> Range;
+
+  void SetLinks (std::string links);
+  std::string GetLinks (void) const;
+  void SetPackets (std::string packets);
+  std::string GetPackets (void) const;
+  /**
+   * \param [in] src The sending node.
+   * \param [in] dst The receiving node.
+   * \returns The link between src and dst, 0 if it is not symbolic.
+   */
+  const Link *FindLink (uint32_t src, uint32_t dst) const;
+
+  std::vector<Link> m_links;     //!< Symbolic links.
+  std::vector<Range> m_packets;  //!< Symbolic packet ranks.
+  uint64_t m_interval;           //!< Default interval in time steps.
+  uint64_t m_minimum;            //!< Default smallest value in time steps.
+  uint64_t m_firstPacket;        //!< Last value given to SetFirstPacket.
+  uint64_t m_numberPackets;      //!< Last value given to SetNumberPackets.
+  enum Target m_target;          //!< What is made symbolic.
+
+  /** Fired for a selected packet, before its symbolic value is injected. */
+  TracedCallback<uint32_t, uint32_t, uint64_t> m_symbolicPacketTrace;
+};
+
+} // namespace ns3
+
+#endif /* SYMBOLIC_INJECTION_POLICY_H */
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "symbolic-trace.h"
+#include "log.h"
+#include "s2e.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::SymbolicTrace.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SymbolicTrace");
+
+uint32_t SymbolicTrace::m_constraints = 0;
+
+void
+SymbolicTrace::Symbolic (enum Kind kind, uint32_t uid, uint32_t node,
+                         const char *name, uint64_t expression, uint32_t value)
+{
+  NS_LOG_FUNCTION (kind << uid << node << name << value);
+  Record record;
+  record.kind = kind;
+  record.uid = uid;
+  record.node = node;
+  record.flags = s2e_is_symbolic (&expression, sizeof (expression)) ? SYMBOLIC : 0;
+  record.value = value;
+  // Each s2e_print_expression adds the expression to the state, the
+  // plugin solves them in that order
+  s2e_print_expression (name, expression);
+  record.constraint = m_constraints++;
+  Emit (record);
+}
+
+void
+SymbolicTrace::Terminate (enum Outcome outcome, const char *message)
+{
+  NS_LOG_FUNCTION (outcome << message);
+  Record record;
+  record.kind = OUTCOME;
+  record.uid = 0;
+  record.node = 0;
+  record.constraint = m_constraints;
+  record.flags = 0;
+  record.value = outcome;
+  Emit (record);
+  s2e_kill_state (0, message);
+}
+
+void
+SymbolicTrace::Emit (Record record)
+{
+  // The plugin reads the record concretely, every field must be concrete
+  s2e_invoke_plugin ("TestCaseGenerator", &record, sizeof (record));
+}
+
+} // namespace ns3
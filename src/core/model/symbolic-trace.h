@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SYMBOLIC_TRACE_H
+#define SYMBOLIC_TRACE_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::SymbolicTrace.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * Binary trace of the symbolic values of a path explored by S2E.
+ *
+ * Each symbolic value of interest (a symbolic delay, a symbolic drop, the
+ * time a routing table converged) is printed with s2e_print_expression,
+ * which keeps its expression in the state, and described by a fixed size
+ * Record sent to the TestCaseGenerator plugin with s2e_invoke_plugin.
+ * The Record refers to the expression by its index in the state, the
+ * constraint id. Terminate sends an OUTCOME record and kills the state.
+ *
+ * When a state terminates, the plugin appends a PathHeader, the records of
+ * the path and the Range of each expression solved under the constraints
+ * of the path to symbolic-trace.dat in the S2E output directory, and an
+ * IndexEntry to symbolic-trace.idx. Both files start with a FileHeader.
+ * utils/read-symbolic-trace aggregates these files on the host.
+ *
+ * The structures are mirrored by the plugin, which cannot include this
+ * header: any change must be made to both.
+ */
+class SymbolicTrace
+{
+public:
+  /** What a Record describes. */
+  enum Kind
+  {
+    SYMBOLIC_DELAY = 1,  //!< Symbolic timestamp of a transmit event.
+    SYMBOLIC_DROP = 2,   //!< Symbolic drop of a packet.
+    ROUTES_UPDATED = 3,  //!< Local time every route of a node changed at.
+    OUTCOME = 4          //!< End of the path, the value is an Outcome.
+  };
+  /** How a path ended. */
+  enum Outcome
+  {
+    UNFINISHED = 0,       //!< State killed before an OUTCOME record.
+    END_OF_SIMULATION = 1 //!< Simulator::Run returned.
+  };
+  /** Record flags. */
+  enum Flags
+  {
+    SYMBOLIC = 1 //!< The expression is symbolic.
+  };
+
+  /** A symbolic value, as sent by the guest. */
+  struct Record
+  {
+    uint32_t kind;       //!< The Kind.
+    uint32_t uid;        //!< Uid of the event, 0 if none.
+    uint32_t node;       //!< Node id.
+    uint32_t constraint; //!< Index of the expression in the state.
+    uint32_t flags;      //!< The Flags.
+    uint32_t value;      //!< Concrete value, low 32 bits.
+  };
+
+  /** Start of symbolic-trace.dat and symbolic-trace.idx. */
+  struct FileHeader
+  {
+    char magic[8];    //!< "NS3SYMTR" or "NS3SYMIX".
+    uint32_t version; //!< VERSION.
+    uint32_t size;    //!< sizeof (Record).
+  };
+  /** A terminated path in symbolic-trace.dat. */
+  struct PathHeader
+  {
+    uint32_t state;   //!< S2E state id.
+    uint32_t outcome; //!< The Outcome.
+    uint32_t records; //!< Number of Record following.
+    uint32_t ranges;  //!< Number of Range following the records.
+  };
+  /** Solved range of an expression, by constraint id. */
+  struct Range
+  {
+    uint64_t lo; //!< Smallest value.
+    uint64_t hi; //!< Largest value.
+  };
+  /** A terminated path in symbolic-trace.idx. */
+  struct IndexEntry
+  {
+    uint32_t state;   //!< S2E state id.
+    uint32_t outcome; //!< The Outcome.
+    uint64_t offset;  //!< Offset of the PathHeader in symbolic-trace.dat.
+  };
+
+  /** Version of the files. */
+  static const uint32_t VERSION = 1;
+
+  /**
+   * Trace a value, symbolic or not.
+   * \param [in] kind The Kind.
+   * \param [in] uid Uid of the event, 0 if none.
+   * \param [in] node The node id.
+   * \param [in] name Name given to the expression.
+   * \param [in] expression The value, printed with s2e_print_expression.
+   * \param [in] value A concrete value for the record, such as the lower
+   *             bound of a symbolic timestamp.
+   */
+  static void Symbolic (enum Kind kind, uint32_t uid, uint32_t node,
+                        const char *name, uint64_t expression, uint32_t value);
+  /**
+   * End the path.
+   * \param [in] outcome The Outcome.
+   * \param [in] message The message of s2e_kill_state.
+   */
+  static void Terminate (enum Outcome outcome, const char *message);
+
+private:
+  /**
+   * Send a record to the TestCaseGenerator plugin.
+   * \param [in] record The record.
+   */
+  static void Emit (Record record);
+
+  /** Expressions printed on this path, forked with the guest memory. */
+  static uint32_t m_constraints;
+};
+
+} // namespace ns3
+
+#endif /* SYMBOLIC_TRACE_H */
@@ -33,6 +33,8 @@
 
 
 #include <sstream>
+#include <iostream>
+#include <ctime>
 
 using namespace ns3;
 
@@ -669,6 +671,58 @@ ObjectVectorTraceConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/1/Source", "Trace 1 did not provide expected context");
 }
 
+// ===========================================================================
+// Test that an index in a path finds the same objects, with the same
+// context, as a search of the whole vector.
+// ===========================================================================
+class IndexedVectorConfigTestCase : public TestCase
+{
+public:
+  IndexedVectorConfigTestCase ();
+  virtual ~IndexedVectorConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+IndexedVectorConfigTestCase::IndexedVectorConfigTestCase ()
+  : TestCase ("Check lookups of a single index of a vector of Object")
+{
+}
+
+void
+IndexedVectorConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  std::vector<Ptr<ConfigTestObject> > nodes;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      nodes.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeA (nodes.back ());
+    }
+
+  Config::MatchContainer m = Config::LookupMatches ("/NodesA/2");
+  NS_TEST_ASSERT_MSG_EQ (m.GetN (), 1, "Expected one match of /NodesA/2");
+  NS_TEST_ASSERT_MSG_EQ (m.Get (0), nodes[2], "Unexpected object for /NodesA/2");
+  NS_TEST_ASSERT_MSG_EQ (m.GetMatchedPath (0), "/NodesA/2/", "Unexpected context for /NodesA/2");
+
+  // the index is parsed as a number, the context is the index in the vector
+  m = Config::LookupMatches ("/NodesA/03");
+  NS_TEST_ASSERT_MSG_EQ (m.GetN (), 1, "Expected one match of /NodesA/03");
+  NS_TEST_ASSERT_MSG_EQ (m.Get (0), nodes[3], "Unexpected object for /NodesA/03");
+  NS_TEST_ASSERT_MSG_EQ (m.GetMatchedPath (0), "/NodesA/3/", "Unexpected context for /NodesA/03");
+
+  m = Config::LookupMatches ("/NodesA/4");
+  NS_TEST_ASSERT_MSG_EQ (m.GetN (), 0, "Unexpected match of /NodesA/4");
+
+  m = Config::LookupMatches ("/NodesA/1|2");
+  NS_TEST_ASSERT_MSG_EQ (m.GetN (), 2, "Expected two matches of /NodesA/1|2");
+  NS_TEST_ASSERT_MSG_EQ (m.GetMatchedPath (1), "/NodesA/2/", "Unexpected context for /NodesA/1|2");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 // ===========================================================================
 // Test for the ability to search attributes of parent classes
 // when Resolver searches for attributes in a derived class object.
@@ -737,6 +791,112 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new IndexedVectorConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
+
+
+// ===========================================================================
+// Performance test: the startup of a scenario which configures and hooks
+// the traces of each node of a large topology.
+// ===========================================================================
+class BulkConfigTimeTestCase : public TestCase
+{
+public:
+  BulkConfigTimeTestCase ();
+  virtual ~BulkConfigTimeTestCase () {}
+
+  void Trace (int16_t oldValue, int16_t newValue) { m_traces++; }
+
+private:
+  virtual void DoRun (void);
+  void Report (const std::string how, uint32_t calls, clock_t delta) const;
+
+  enum { NODES = 10000 };
+  uint32_t m_traces;
+};
+
+BulkConfigTimeTestCase::BulkConfigTimeTestCase ()
+  : TestCase ("Measure the Config time on a large topology"),
+    m_traces (0)
+{
+}
+
+void
+BulkConfigTimeTestCase::DoRun (void)
+{
+  //
+  // Like the NodeList and the DeviceList of each node: /NodesA/i/NodesB/0
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  std::vector<Ptr<ConfigTestObject> > devices;
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      Ptr<ConfigTestObject> node = CreateObject<ConfigTestObject> ();
+      Ptr<ConfigTestObject> device = CreateObject<ConfigTestObject> ();
+      node->AddNodeB (device);
+      root->AddNodeA (node);
+      devices.push_back (device);
+    }
+
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      std::ostringstream oss;
+      oss << "/NodesA/" << i << "/NodesB/0/Source";
+      Config::ConnectWithoutContext (oss.str (), MakeCallback (&BulkConfigTimeTestCase::Trace, this));
+    }
+  Report ("Connect per node", NODES, clock () - start);
+
+  start = clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      std::ostringstream oss;
+      oss << "/NodesA/" << i << "/NodesB/0/A";
+      Config::Set (oss.str (), IntegerValue (3));
+    }
+  Report ("Set per node", NODES, clock () - start);
+
+  start = clock ();
+  Config::Set ("/NodesA/*/NodesB/0/B", IntegerValue (4));
+  Report ("Set on all nodes", 1, clock () - start);
+
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      devices[i]->SetAttribute ("Source", IntegerValue (i % 100));
+      IntegerValue a, b;
+      devices[i]->GetAttribute ("A", a);
+      devices[i]->GetAttribute ("B", b);
+      NS_TEST_ASSERT_MSG_EQ (a.Get (), 3, "Attribute A not set on node " << i);
+      NS_TEST_ASSERT_MSG_EQ (b.Get (), 4, "Attribute B not set on node " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_traces, (uint32_t) NODES, "Some traces were not connected");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
+void
+BulkConfigTimeTestCase::Report (const std::string how, uint32_t calls, clock_t delta) const
+{
+  double per = 1E6 * double (delta) / (double (calls) * double (CLOCKS_PER_SEC));
+  std::cout << "config-perf: " << how << ": nodes: " << NODES
+            << ", ticks: " << delta
+            << "\tper call: " << per << " microsec"
+            << std::endl;
+}
+
+class ConfigPerformanceTestSuite : public TestSuite
+{
+public:
+  ConfigPerformanceTestSuite ();
+};
+
+ConfigPerformanceTestSuite::ConfigPerformanceTestSuite ()
+  : TestSuite ("config-perf", PERFORMANCE)
+{
+  AddTestCase (new BulkConfigTimeTestCase, TestCase::QUICK);
+}
+
+static ConfigPerformanceTestSuite configPerformanceTestSuite;
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/delay-explorer.h"
+#include <vector>
+#include <limits>
+#include <unistd.h>
+
+using namespace ns3;
+
+class DelayExplorerPathsTestCase : public TestCase
+{
+public:
+  DelayExplorerPathsTestCase (uint32_t workers);
+  virtual void DoRun (void);
+  Scheduler::EventKey MakeKey (uint32_t uid, uint64_t ts);
+
+  uint32_t m_workers;
+};
+
+DelayExplorerPathsTestCase::DelayExplorerPathsTestCase (uint32_t workers)
+  : TestCase ("Check that every feasible ordering is explored once"),
+    m_workers (workers)
+{
+}
+
+Scheduler::EventKey
+DelayExplorerPathsTestCase::MakeKey (uint32_t uid, uint64_t ts)
+{
+  Scheduler::EventKey key;
+  key.m_ts = ts;
+  key.m_uid = uid;
+  key.m_context = 0;
+  return key;
+}
+
+void
+DelayExplorerPathsTestCase::DoRun (void)
+{
+  DelayExplorer::SetWorkers (m_workers);
+  DelayExplorer::Enable (true);
+  Scheduler::EventKey a = MakeKey (1, 0);
+  Scheduler::EventKey b = MakeKey (2, 15);
+  Scheduler::EventKey c = MakeKey (3, 0);
+  Scheduler::EventKey d = MakeKey (4, 40);
+  DelayExplorer::MakeSymbolic (a, 10, 20);
+  DelayExplorer::MakeSymbolic (c, 12, 30);
+
+  // a <= 15 or a > 15, then a <= c or a > c: four paths
+  bool beforeB = DelayExplorer::IsBefore (a, b);
+  bool beforeC = DelayExplorer::IsBefore (a, c);
+  // always true, no new path
+  bool beforeD = DelayExplorer::IsBefore (c, d);
+  // implied by the first comparison, no new path
+  bool stillBeforeB = DelayExplorer::IsBefore (a, 0, b, true);
+
+  DelayExplorer::Concretise (a);
+  DelayExplorer::Concretise (c);
+  bool ok = beforeB == (a.m_ts <= 15) && beforeC == (a.m_ts <= c.m_ts)
+    && beforeD && stillBeforeB == beforeB
+    && a.m_ts >= 10 && a.m_ts <= 20 && c.m_ts >= 12 && c.m_ts <= 30;
+  bool isFirstPath = DelayExplorer::IsFirstPath ();
+  DelayExplorer::Wait ();
+  if (!isFirstPath)
+    {
+      // the other paths report through their exit status only
+      _exit (ok ? 0 : 1);
+    }
+  DelayExplorer::Enable (false);
+  DelayExplorer::SetWorkers (1);
+
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "The first path does not follow its outcomes");
+  NS_TEST_ASSERT_MSG_EQ (beforeB && beforeC, false, "The first path takes the false branches");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetPaths (), 4, "Orderings are not all explored");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetFailedPaths (), 0, "A path does not follow its outcomes");
+}
+
+class DelayExplorerBoundsTestCase : public TestCase
+{
+public:
+  DelayExplorerBoundsTestCase ();
+  virtual void DoRun (void);
+};
+
+DelayExplorerBoundsTestCase::DelayExplorerBoundsTestCase ()
+  : TestCase ("Check that executed events leave the explorer with their bounds kept")
+{
+}
+
+void
+DelayExplorerBoundsTestCase::DoRun (void)
+{
+  DelayExplorer::SetWorkers (1);
+  DelayExplorer::Enable (true);
+  Scheduler::EventKey a;
+  a.m_uid = 1;
+  a.m_ts = 0;
+  a.m_context = 0;
+  Scheduler::EventKey b = a;
+  b.m_uid = 2;
+  Scheduler::EventKey c = a;
+  c.m_uid = 3;
+  DelayExplorer::MakeSymbolic (a, 10, 20);
+  DelayExplorer::MakeSymbolic (b, 0, 100);
+  DelayExplorer::MakeSymbolic (c, 12, 30);
+
+  // an unreachable offset neither overflows nor forks
+  bool unreachable = DelayExplorer::IsBefore (a, std::numeric_limits<int64_t>::max (), c, true);
+  // c < a or c >= a, then b is cancelled and c runs
+  bool cFirst = DelayExplorer::IsBefore (c, a);
+  DelayExplorer::Forget (b);
+  DelayExplorer::Concretise (c);
+  // a keeps the bound given by c
+  bool peek = DelayExplorer::PeekBefore (c, 0, a, false);
+  DelayExplorer::Concretise (a);
+  bool ok = !unreachable && !DelayExplorer::IsSymbolic (b) && !DelayExplorer::IsSymbolic (c)
+    && peek == cFirst && c.m_ts == 12 && a.m_ts == (cFirst ? 13 : 10);
+  bool isFirstPath = DelayExplorer::IsFirstPath ();
+  DelayExplorer::Wait ();
+  if (!isFirstPath)
+    {
+      _exit (ok ? 0 : 1);
+    }
+  DelayExplorer::Enable (false);
+
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "The first path lost a bound");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetPaths (), 2, "Only the order of a and c forks");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetFailedPaths (), 0, "A path lost a bound");
+}
+
+/** Time a of DelayExplorerMergeTestCase runs at, as a node state. */
+static uint64_t g_runTime = 0;
+
+static uint64_t
+GetRunTime (void)
+{
+  return g_runTime;
+}
+
+class DelayExplorerMergeTestCase : public TestCase
+{
+public:
+  DelayExplorerMergeTestCase (bool stateHash);
+  virtual void DoRun (void);
+
+  bool m_stateHash;
+};
+
+DelayExplorerMergeTestCase::DelayExplorerMergeTestCase (bool stateHash)
+  : TestCase (stateHash ? "Check that paths whose nodes differ are not merged"
+              : "Check that paths reaching the same state are merged"),
+    m_stateHash (stateHash)
+{
+}
+
+void
+DelayExplorerMergeTestCase::DoRun (void)
+{
+  // one worker: the first path reaches each state before the other ones
+  DelayExplorer::SetWorkers (1);
+  DelayExplorer::Enable (true);
+  if (m_stateHash)
+    {
+      DelayExplorer::AddStateHash (MakeCallback (&GetRunTime));
+    }
+  Scheduler::EventKey a;
+  a.m_uid = 1;
+  a.m_context = 0;
+  a.m_eventType = Scheduler::UNDEFINED;
+  Scheduler::EventKey b = a;
+  b.m_uid = 2;
+  b.m_ts = 15;
+  Scheduler::EventKey c = a;
+  c.m_uid = 3;
+  c.m_ts = 40;
+  DelayExplorer::MakeSymbolic (a, 10, 20);
+  DelayExplorer::AddScheduled (a);
+  DelayExplorer::AddScheduled (b);
+  DelayExplorer::AddScheduled (c);
+
+  // a runs at 10 or at 16, with b and c still scheduled
+  DelayExplorer::IsBefore (a, b);
+  DelayExplorer::RemoveScheduled (a);
+  DelayExplorer::Concretise (a);
+  g_runTime = a.m_ts;
+  bool mergedAtA = DelayExplorer::Visit (a);
+  bool mergedAtB = false;
+  if (!mergedAtA)
+    {
+      // c is then reached in a new state
+      DelayExplorer::RemoveScheduled (b);
+      mergedAtB = DelayExplorer::Visit (b);
+    }
+
+  bool isFirstPath = DelayExplorer::IsFirstPath ();
+  DelayExplorer::Wait ();
+  if (!isFirstPath)
+    {
+      _exit (mergedAtA != m_stateHash && !mergedAtB ? 0 : 1);
+    }
+  DelayExplorer::Enable (false);
+
+  NS_TEST_ASSERT_MSG_EQ (mergedAtA || mergedAtB, false, "The first path is merged");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetPaths (), 2, "The delay of a does not fork");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetMergedPaths (), m_stateHash ? 0 : 1,
+                         "The paths are not merged as their state");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetFailedPaths (), 0, "A merged path went on");
+}
+
+class DelayExplorerTestSuite : public TestSuite
+{
+public:
+  DelayExplorerTestSuite ();
+};
+
+DelayExplorerTestSuite::DelayExplorerTestSuite ()
+  : TestSuite ("delay-explorer", UNIT)
+{
+  AddTestCase (new DelayExplorerPathsTestCase (1), TestCase::QUICK);
+  AddTestCase (new DelayExplorerPathsTestCase (4), TestCase::QUICK);
+  AddTestCase (new DelayExplorerBoundsTestCase, TestCase::QUICK);
+  AddTestCase (new DelayExplorerMergeTestCase (false), TestCase::QUICK);
+  AddTestCase (new DelayExplorerMergeTestCase (true), TestCase::QUICK);
+}
+
+static DelayExplorerTestSuite delayExplorerTestSuite;
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/log-ring-buffer.h"
+#include "ns3/system-thread.h"
+#endif
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup logging-tests
+ * Check the levels selected by a filter of \c --log-filter.
+ */
+class LogFilterTestCase : public TestCase
+{
+public:
+  LogFilterTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LogFilterTestCase::LogFilterTestCase ()
+  : TestCase ("Check the compile-time log filter")
+{
+}
+
+void
+LogFilterTestCase::DoRun (void)
+{
+  // The filter is evaluated by the compiler
+  static const uint32_t channel = LogFilter::Select ("PointToPointChannel",
+                                                     "PointToPointChannel=info|function:ListScheduler");
+  static const uint32_t scheduler = LogFilter::Select ("ListScheduler",
+                                                       "PointToPointChannel=info|function:ListScheduler");
+  static const uint32_t other = LogFilter::Select ("PointToPointNetDevice",
+                                                   "PointToPointChannel=info|function:ListScheduler");
+  NS_TEST_EXPECT_MSG_EQ (channel, (uint32_t) (LOG_INFO | LOG_FUNCTION), "levels of a component");
+  NS_TEST_EXPECT_MSG_EQ (scheduler, (uint32_t) LOG_LEVEL_ALL, "component without levels");
+  NS_TEST_EXPECT_MSG_EQ (other, 0, "component not selected");
+
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("A", "A=level_info|prefix_time"), (uint32_t) LOG_LEVEL_INFO,
+                         "prefixes are selected at run time");
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("A", "A=all"), (uint32_t) LOG_LEVEL_ALL,
+                         "all as first level");
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("A", "A=warn|all"), (uint32_t) LOG_WARN,
+                         "all as a prefix");
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("A", "AB=warn:B"), 0, "name prefix");
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("AB", "A=warn:B"), 0, "longer name");
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("A", "*=error:A=debug"), (uint32_t) (LOG_ERROR | LOG_DEBUG),
+                         "wildcard and component");
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("A", "***"), (uint32_t) LOG_LEVEL_ALL, "all components");
+  NS_TEST_EXPECT_MSG_EQ (LogFilter::Select ("A", ""), 0, "empty filter");
+}
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \ingroup logging-tests
+ * Check that the lines written to a LogRingBuffer by several threads
+ * reach the output whole and in order.
+ */
+class LogRingBufferTestCase : public TestCase
+{
+public:
+  LogRingBufferTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Write the lines of a thread.
+   * \param [in] os The stream on the ring.
+   * \param [in] thread The thread number.
+   */
+  static void Write (std::ostream *os, uint32_t thread);
+  /**
+   * \param [in] thread The thread number.
+   * \param [in] line The line number.
+   * \returns The text of a line, longer than a slot for one line in 7.
+   */
+  static std::string Line (uint32_t thread, uint32_t line);
+
+  static const uint32_t THREADS = 4; //!< Writing threads.
+  static const uint32_t LINES = 2000; //!< Lines per thread.
+};
+
+LogRingBufferTestCase::LogRingBufferTestCase ()
+  : TestCase ("Check the lines written to a LogRingBuffer by several threads")
+{
+}
+
+std::string
+LogRingBufferTestCase::Line (uint32_t thread, uint32_t line)
+{
+  std::ostringstream oss;
+  oss << "thread " << thread << " line " << line;
+  if (line % 7 == 0)
+    {
+      oss << " " << std::string (100 + (line % 800), 'x');
+    }
+  return oss.str ();
+}
+
+void
+LogRingBufferTestCase::Write (std::ostream *os, uint32_t thread)
+{
+  for (uint32_t i = 0; i < LINES; i++)
+    {
+      // Like NS_LOG, with a few insertions and std::endl
+      std::string line = Line (thread, i);
+      *os << line.substr (0, 5) << line.substr (5) << std::endl;
+    }
+}
+
+void
+LogRingBufferTestCase::DoRun (void)
+{
+  std::stringbuf output;
+  LogRingBuffer *ring = new LogRingBuffer (&output, 16);
+  std::ostream os (ring);
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < THREADS; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&LogRingBufferTestCase::Write, &os, i)));
+      threads.back ()->Start ();
+    }
+  for (uint32_t i = 0; i < THREADS; i++)
+    {
+      threads[i]->Join ();
+    }
+  os << "last";
+  ring->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (output.str ().substr (output.str ().size () - 4), "last",
+                         "Flush writes the current line");
+  delete ring;
+
+  std::istringstream is (output.str ());
+  std::vector<uint32_t> next (THREADS, 0);
+  std::string line;
+  uint32_t lines = 0;
+  while (std::getline (is, line) && line != "last")
+    {
+      std::istringstream fields (line);
+      std::string word;
+      uint32_t thread = THREADS;
+      fields >> word >> thread;
+      NS_TEST_ASSERT_MSG_LT (thread, THREADS, "line " << lines << " mixed up");
+      NS_TEST_ASSERT_MSG_EQ (line, Line (thread, next[thread]), "line " << lines << " mixed up");
+      next[thread]++;
+      lines++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (lines, THREADS * LINES, "lines lost");
+}
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * \ingroup logging-tests
+ * The log test suite.
+ */
+class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ();
+};
+
+LogTestSuite::LogTestSuite ()
+  : TestSuite ("log", UNIT)
+{
+  AddTestCase (new LogFilterTestCase, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new LogRingBufferTestCase, TestCase::QUICK);
+#endif
+}
+
+static LogTestSuite g_logTestSuite;
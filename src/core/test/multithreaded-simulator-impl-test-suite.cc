@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Nodes on a ring pass messages to their successor, each message being
+ * checked against the time it was expected at.
+ */
+class MultithreadedSimulatorRingTestCase : public TestCase
+{
+public:
+  /**
+   * \param [in] threads The number of node threads.
+   */
+  MultithreadedSimulatorRingTestCase (uint32_t threads);
+  /**
+   * Receive a message.
+   * \param [in] node The receiving node.
+   * \param [in] expected Timestamp the message should arrive at.
+   * \param [in] hops Number of nodes the message still visits.
+   */
+  void Receive (uint32_t node, uint64_t expected, uint32_t hops);
+  /**
+   * A local event of a node.
+   * \param [in] node The node.
+   * \param [in] expected Timestamp the event should run at.
+   */
+  void Tick (uint32_t node, uint64_t expected);
+  /** An event of the simulator context, sending a message to node 0. */
+  void Inject (void);
+  /**
+   * Run the ring.
+   * \param [in] threads The number of node threads.
+   * \returns The timestamps of the messages received by each node.
+   */
+  std::vector<std::vector<uint64_t> > RunRing (uint32_t threads);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_threads;                          //!< Number of node threads.
+  std::vector<std::vector<uint64_t> > m_trace; //!< Messages of each node.
+  std::vector<uint32_t> m_errors;              //!< Errors of each node.
+};
+
+/** Number of nodes on the ring. */
+static const uint32_t RING_NODES = 8;
+/** Impact latency between two nodes. */
+static const uint64_t RING_LATENCY = 100;
+
+MultithreadedSimulatorRingTestCase::MultithreadedSimulatorRingTestCase (uint32_t threads)
+  : TestCase ("Check message passing between nodes with " +
+              std::string (threads == 1 ? "one thread" : "several threads")),
+    m_threads (threads)
+{
+}
+
+void
+MultithreadedSimulatorRingTestCase::Receive (uint32_t node, uint64_t expected, uint32_t hops)
+{
+  if (Simulator::GetContext () != node ||
+      (uint64_t) Simulator::Now ().GetTimeStep () != expected)
+    {
+      m_errors[node]++;
+    }
+  m_trace[node].push_back (expected);
+  if (hops == 0)
+    {
+      return;
+    }
+  uint64_t delay = RING_LATENCY + hops % 7;
+  Simulator::ScheduleWithContext ((node + 1) % RING_NODES, TimeStep (delay),
+                                  &MultithreadedSimulatorRingTestCase::Receive, this,
+                                  (node + 1) % RING_NODES, expected + delay, hops - 1);
+  Simulator::Schedule (TimeStep (hops % 5), &MultithreadedSimulatorRingTestCase::Tick, this,
+                       node, expected + hops % 5);
+}
+
+void
+MultithreadedSimulatorRingTestCase::Tick (uint32_t node, uint64_t expected)
+{
+  if (Simulator::GetContext () != node ||
+      (uint64_t) Simulator::Now ().GetTimeStep () != expected)
+    {
+      m_errors[node]++;
+    }
+}
+
+void
+MultithreadedSimulatorRingTestCase::Inject (void)
+{
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  Simulator::ScheduleWithContext (0, TimeStep (3), &MultithreadedSimulatorRingTestCase::Receive,
+                                  this, 0, now + 3, 20);
+}
+
+std::vector<std::vector<uint64_t> >
+MultithreadedSimulatorRingTestCase::RunRing (uint32_t threads)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Threads", UintegerValue (threads));
+  m_trace.assign (RING_NODES, std::vector<uint64_t> ());
+  m_errors.assign (RING_NODES, 0);
+
+  std::vector<std::vector<uint64_t> > latency (RING_NODES, std::vector<uint64_t> (RING_NODES, RING_LATENCY));
+  Simulator::SetImpactLatency (latency);
+  for (uint32_t i = 0; i < RING_NODES; i++)
+    {
+      Simulator::ScheduleWithContext (i, TimeStep (i), &MultithreadedSimulatorRingTestCase::Receive,
+                                      this, i, i, 50 + i);
+    }
+  Simulator::Schedule (TimeStep (1234), &MultithreadedSimulatorRingTestCase::Inject, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Threads", UintegerValue (0));
+
+  for (uint32_t i = 0; i < RING_NODES; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_errors[i], 0, "Event of node " << i << " run at the wrong time");
+    }
+  return m_trace;
+}
+
+void
+MultithreadedSimulatorRingTestCase::DoRun (void)
+{
+  std::vector<std::vector<uint64_t> > reference = RunRing (1);
+  uint32_t messages = 0;
+  for (uint32_t i = 0; i < RING_NODES; i++)
+    {
+      messages += reference[i].size ();
+    }
+  // each node starts a message visiting 51 + i nodes, Inject one of 21
+  NS_TEST_ASSERT_MSG_EQ (messages, 8 * 51 + 28 + 21, "Messages lost");
+  if (m_threads > 1)
+    {
+      std::vector<std::vector<uint64_t> > trace = RunRing (m_threads);
+      for (uint32_t i = 0; i < RING_NODES; i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ ((trace[i] == reference[i]), true,
+                                 "Node " << i << " got different messages with " << m_threads << " threads");
+        }
+    }
+}
+
+/**
+ * Simulator::Stop with a delay, and the clock at the end of the run.
+ */
+class MultithreadedSimulatorStopTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorStopTestCase ();
+  /**
+   * Count an event and schedule the next one.
+   * \param [in] node The node.
+   */
+  void Count (uint32_t node);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_count; //!< Number of events run.
+};
+
+MultithreadedSimulatorStopTestCase::MultithreadedSimulatorStopTestCase ()
+  : TestCase ("Check Simulator::Stop with a delay"),
+    m_count (0)
+{
+}
+
+void
+MultithreadedSimulatorStopTestCase::Count (uint32_t node)
+{
+  m_count++;
+  Simulator::Schedule (MilliSeconds (1), &MultithreadedSimulatorStopTestCase::Count, this, node);
+}
+
+void
+MultithreadedSimulatorStopTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Threads", UintegerValue (1));
+  Simulator::ScheduleWithContext (3, MilliSeconds (1), &MultithreadedSimulatorStopTestCase::Count, this, 3);
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 99, "Events after the stop time were run");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (100), "Clock not at the stop time");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsFinished (), false, "Events left");
+  // a second run continues where the first one stopped
+  Simulator::Stop (MilliSeconds (10));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 109, "Second run did not continue");
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Threads", UintegerValue (0));
+}
+
+/**
+ * The MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    AddTestCase (new MultithreadedSimulatorRingTestCase (1), TestCase::QUICK);
+#ifdef NS3_NODE_THREADS
+    AddTestCase (new MultithreadedSimulatorRingTestCase (4), TestCase::QUICK);
+#endif
+    AddTestCase (new MultithreadedSimulatorStopTestCase (), TestCase::QUICK);
+  }
+};
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite;
@@ -23,6 +23,10 @@
 #include "ns3/object-factory.h"
 #include "ns3/assert.h"
 
+#include <iostream>
+#include <sstream>
+#include <ctime>
+
 namespace {
 
 class BaseA : public ns3::Object
@@ -118,6 +122,33 @@ NS_OBJECT_ENSURE_REGISTERED (DerivedA);
 NS_OBJECT_ENSURE_REGISTERED (BaseB);
 NS_OBJECT_ENSURE_REGISTERED (DerivedB);
 
+/**
+ * Objects aggregated together like the protocols of a node, for the
+ * GetObject performance test.
+ */
+template <int N>
+class Protocol : public ns3::Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static ns3::TypeId GetTypeId (void)
+  {
+    std::ostringstream oss;
+    oss << "ObjectTest:Protocol" << N;
+    static ns3::TypeId tid = ns3::TypeId (oss.str ().c_str ())
+      .SetParent<Object> ()
+      .SetGroupName ("Core")
+      .HideFromDocumentation ()
+      .AddConstructor<Protocol<N> > ();
+    return tid;
+  }
+  Protocol ()
+  {}
+};
+
 } // namespace anonymous
 
 using namespace ns3;
@@ -359,6 +390,63 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+// ===========================================================================
+// Test case to make sure that repeated lookups follow the aggregation
+// ===========================================================================
+class RepeatedGetObjectTestCase : public TestCase
+{
+public:
+  RepeatedGetObjectTestCase ();
+  virtual ~RepeatedGetObjectTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RepeatedGetObjectTestCase::RepeatedGetObjectTestCase ()
+  : TestCase ("Check repeated GetObject across aggregations")
+{
+}
+
+RepeatedGetObjectTestCase::~RepeatedGetObjectTestCase ()
+{
+}
+
+void
+RepeatedGetObjectTestCase::DoRun (void)
+{
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  Ptr<BaseB> baseB = CreateObject<DerivedB> ();
+  baseA->AggregateObject (baseB);
+
+  //
+  // The same lookup, twice, by the type and by its parent.
+  //
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), baseB, "GetObject<DerivedB> returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), baseB, "GetObject<BaseB> returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedA> (), 0, "Unexpectedly found a DerivedA");
+    }
+
+  //
+  // Aggregating another aggregation must not hide it from the lookups
+  // made before.
+  //
+  Ptr<Protocol<1> > p1 = CreateObject<Protocol<1> > ();
+  Ptr<Protocol<2> > p2 = CreateObject<Protocol<2> > ();
+  p1->AggregateObject (p2);
+  NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<Protocol<2> > (), 0, "Unexpectedly found a Protocol<2>");
+  baseB->AggregateObject (p1);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<Protocol<2> > (), p2, "GetObject<Protocol<2> > returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (p2->GetObject<BaseB> (), baseB, "GetObject<BaseB> returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (p2->GetObject<BaseA> (), baseA, "GetObject<BaseA> returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<Protocol<1> > (), p1, "GetObject<Protocol<1> > returns a different Ptr");
+    }
+}
+
 // ===========================================================================
 // Test case to make sure that an Object factory can create Objects
 // ===========================================================================
@@ -445,7 +533,83 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase, TestCase::QUICK);
   AddTestCase (new AggregateObjectTestCase, TestCase::QUICK);
+  AddTestCase (new RepeatedGetObjectTestCase, TestCase::QUICK);
   AddTestCase (new ObjectFactoryTestCase, TestCase::QUICK);
 }
 
 static ObjectTestSuite objectTestSuite;
+
+
+// ===========================================================================
+// Performance test: the GetObject calls made for each packet by the
+// protocols aggregated to a node.
+// ===========================================================================
+class GetObjectTimeTestCase : public TestCase
+{
+public:
+  GetObjectTimeTestCase ();
+  virtual ~GetObjectTimeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  enum { PACKETS = 1000000 };
+};
+
+GetObjectTimeTestCase::GetObjectTimeTestCase ()
+  : TestCase ("Measure the GetObject time per packet")
+{
+}
+
+GetObjectTimeTestCase::~GetObjectTimeTestCase ()
+{
+}
+
+void
+GetObjectTimeTestCase::DoRun (void)
+{
+  Ptr<Protocol<0> > node = CreateObject<Protocol<0> > ();
+  node->AggregateObject (CreateObject<Protocol<1> > ());
+  node->AggregateObject (CreateObject<Protocol<2> > ());
+  node->AggregateObject (CreateObject<Protocol<3> > ());
+  node->AggregateObject (CreateObject<Protocol<4> > ());
+  node->AggregateObject (CreateObject<DerivedA> ());
+  node->AggregateObject (CreateObject<DerivedB> ());
+  Ptr<Protocol<4> > device = node->GetObject<Protocol<4> > ();
+
+  // Like a packet received by a device and going up the stack, looking up
+  // the node, the protocols, and the parent type of a protocol
+  uint32_t found = 0;
+  int start = clock ();
+  for (uint32_t i = 0; i < PACKETS; i++)
+    {
+      found += device->GetObject<Protocol<0> > () != 0;
+      found += device->GetObject<Protocol<1> > () != 0;
+      found += device->GetObject<Protocol<2> > () != 0;
+      found += device->GetObject<BaseB> () != 0;
+      found += device->GetObject<Protocol<3> > () != 0;
+    }
+  int stop = clock ();
+  NS_TEST_ASSERT_MSG_EQ (found, 5 * PACKETS, "Some lookups failed");
+
+  double per = 1E9 * double (stop - start) / (double (PACKETS) * double (CLOCKS_PER_SEC));
+  std::cout << "object-perf: GetObject time: packets: " << PACKETS
+            << ", lookups per packet: 5"
+            << ", ticks: " << stop - start
+            << "\tper: " << per << " ns/packet"
+            << std::endl;
+}
+
+class ObjectPerformanceTestSuite : public TestSuite
+{
+public:
+  ObjectPerformanceTestSuite ();
+};
+
+ObjectPerformanceTestSuite::ObjectPerformanceTestSuite ()
+  : TestSuite ("object-perf", PERFORMANCE)
+{
+  AddTestCase (new GetObjectTimeTestCase, TestCase::QUICK);
+}
+
+static ObjectPerformanceTestSuite objectPerformanceTestSuite;
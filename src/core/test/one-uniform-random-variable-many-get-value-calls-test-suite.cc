@@ -73,6 +73,58 @@ OneUniformRandomVariableManyGetValueCallsTestCase::DoRun (void)
     }
 }
 
+// <M>
+// ===========================================================================
+// Test case for one uniform distribution random variable stream generator
+// read with GetValues
+// ===========================================================================
+
+class OneUniformRandomVariableManyGetValuesCallsTestCase : public TestCase
+{
+public:
+  OneUniformRandomVariableManyGetValuesCallsTestCase ();
+  virtual ~OneUniformRandomVariableManyGetValuesCallsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+OneUniformRandomVariableManyGetValuesCallsTestCase::OneUniformRandomVariableManyGetValuesCallsTestCase ()
+  : TestCase ("One Uniform Random Variable with Many GetValues() Calls")
+{
+}
+
+OneUniformRandomVariableManyGetValuesCallsTestCase::~OneUniformRandomVariableManyGetValuesCallsTestCase ()
+{
+}
+
+void
+OneUniformRandomVariableManyGetValuesCallsTestCase::DoRun (void)
+{
+  double min = 0.0;
+  double max = 10.0;
+
+  Config::SetDefault ("ns3::UniformRandomVariable::Min", DoubleValue (min));
+  Config::SetDefault ("ns3::UniformRandomVariable::Max", DoubleValue (max));
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+
+  // Get as many values as above, a block at a time.
+  std::vector<double> values (1024);
+  int count = 100000000;
+  for (int i = 0; i < count; i += values.size ())
+    {
+      uniform->GetValues (&values[0], values.size ());
+
+      for (uint32_t j = 0; j < values.size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_GT (values[j], min, "Value less than minimum.");
+          NS_TEST_ASSERT_MSG_LT (values[j], max, "Value greater than maximum.");
+        }
+    }
+}
+// <M>
+
 class OneUniformRandomVariableManyGetValueCallsTestSuite : public TestSuite
 {
 public:
@@ -83,6 +135,9 @@ OneUniformRandomVariableManyGetValueCallsTestSuite::OneUniformRandomVariableMany
   : TestSuite ("one-uniform-random-variable-many-get-value-calls", PERFORMANCE)
 {
   AddTestCase (new OneUniformRandomVariableManyGetValueCallsTestCase, TestCase::QUICK);
+  // <M>
+  AddTestCase (new OneUniformRandomVariableManyGetValuesCallsTestCase, TestCase::QUICK);
+  // <M>
 }
 
 static OneUniformRandomVariableManyGetValueCallsTestSuite oneUniformRandomVariableManyGetValueCallsTestSuite;
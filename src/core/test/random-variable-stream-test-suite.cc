@@ -28,6 +28,10 @@
 #include <ctime>
 #include <fstream>
 #include <cmath>
+// <M>
+#include <vector>
+#include <algorithm>
+// <M>
 
 #include "ns3/boolean.h"
 #include "ns3/double.h"
@@ -37,6 +41,9 @@
 #include "ns3/log.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/random-variable-stream.h"
+// <M>
+#include "ns3/object-factory.h"
+// <M>
 
 using namespace ns3;
 
@@ -2886,6 +2893,93 @@ RandomVariableStreamEmpiricalAntitheticTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (valueMean, expectedMean, TOLERANCE, "Wrong mean value."); 
 }
 
+// <M>
+// ===========================================================================
+// Test case for the values drawn at once by GetValues
+// ===========================================================================
+class RandomVariableStreamGetValuesTestCase : public TestCase
+{
+public:
+  static const uint32_t N_MEASUREMENTS = 100000;
+
+  RandomVariableStreamGetValuesTestCase ();
+  virtual ~RandomVariableStreamGetValuesTestCase ();
+
+  /**
+   * Check that GetValues returns the values of GetValue, bit for bit.
+   * \param [in] name The distribution.
+   * \param [in] a The stream read with GetValue.
+   * \param [in] b A stream with the same number, read with GetValues.
+   */
+  void Compare (std::string name, Ptr<RandomVariableStream> a, Ptr<RandomVariableStream> b);
+
+private:
+  virtual void DoRun (void);
+};
+
+RandomVariableStreamGetValuesTestCase::RandomVariableStreamGetValuesTestCase ()
+  : TestCase ("GetValues Random Variable Stream Generator")
+{
+}
+
+RandomVariableStreamGetValuesTestCase::~RandomVariableStreamGetValuesTestCase ()
+{
+}
+
+void
+RandomVariableStreamGetValuesTestCase::Compare (std::string name, Ptr<RandomVariableStream> a,
+                                                Ptr<RandomVariableStream> b)
+{
+  a->SetStream (1);
+  b->SetStream (1);
+  std::vector<double> values (N_MEASUREMENTS);
+  // Odd sizes, so that a Normal value is left over between calls
+  uint32_t sizes[] = { 1, 7, 0, 1001 };
+  uint32_t done = 0;
+  for (uint32_t i = 0; done < N_MEASUREMENTS; i++)
+    {
+      uint32_t n = std::min (sizes[i % 4], N_MEASUREMENTS - done);
+      b->GetValues (&values[done], n);
+      done += n;
+    }
+  for (uint32_t i = 0; i < N_MEASUREMENTS; i++)
+    {
+      double value = a->GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (values[i], value, name << " value " << i << " differs");
+    }
+}
+
+void
+RandomVariableStreamGetValuesTestCase::DoRun (void)
+{
+  Compare ("uniform", CreateObject<UniformRandomVariable> (),
+           CreateObject<UniformRandomVariable> ());
+  Compare ("antithetic uniform",
+           CreateObjectWithAttributes<UniformRandomVariable> ("Min", DoubleValue (-3), "Max", DoubleValue (5),
+                                                              "Antithetic", BooleanValue (true)),
+           CreateObjectWithAttributes<UniformRandomVariable> ("Min", DoubleValue (-3), "Max", DoubleValue (5),
+                                                              "Antithetic", BooleanValue (true)));
+  Compare ("exponential", CreateObject<ExponentialRandomVariable> (),
+           CreateObject<ExponentialRandomVariable> ());
+  Compare ("bounded antithetic exponential",
+           CreateObjectWithAttributes<ExponentialRandomVariable> ("Bound", DoubleValue (0.5),
+                                                                  "Antithetic", BooleanValue (true)),
+           CreateObjectWithAttributes<ExponentialRandomVariable> ("Bound", DoubleValue (0.5),
+                                                                  "Antithetic", BooleanValue (true)));
+  Compare ("normal", CreateObject<NormalRandomVariable> (),
+           CreateObject<NormalRandomVariable> ());
+  Compare ("bounded antithetic normal",
+           CreateObjectWithAttributes<NormalRandomVariable> ("Mean", DoubleValue (2), "Variance", DoubleValue (3),
+                                                             "Bound", DoubleValue (1.5),
+                                                             "Antithetic", BooleanValue (true)),
+           CreateObjectWithAttributes<NormalRandomVariable> ("Mean", DoubleValue (2), "Variance", DoubleValue (3),
+                                                             "Bound", DoubleValue (1.5),
+                                                             "Antithetic", BooleanValue (true)));
+  Compare ("pareto", CreateObject<ParetoRandomVariable> (),
+           CreateObject<ParetoRandomVariable> ());
+}
+// <M>
+
 class RandomVariableStreamTestSuite : public TestSuite
 {
 public:
@@ -2930,6 +3024,9 @@ RandomVariableStreamTestSuite::RandomVariableStreamTestSuite ()
   AddTestCase (new RandomVariableStreamDeterministicTestCase, TestCase::QUICK);
   AddTestCase (new RandomVariableStreamEmpiricalTestCase, TestCase::QUICK);
   AddTestCase (new RandomVariableStreamEmpiricalAntitheticTestCase, TestCase::QUICK);
+  // <M>
+  AddTestCase (new RandomVariableStreamGetValuesTestCase, TestCase::QUICK);
+  // <M>
 }
 
 static RandomVariableStreamTestSuite randomVariableStreamTestSuite;
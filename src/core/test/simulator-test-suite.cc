@@ -23,6 +23,14 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/string.h"
+#include "ns3/symbolic-injection-policy.h"
+#include "ns3/delay-explorer.h"
+#include "ns3/system-thread.h"
+#include "ns3/core-config.h"
+#include <fstream>
+#include <set>
+#include <unistd.h>
 
 using namespace ns3;
 
@@ -168,6 +176,687 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+/**
+ * Impact latency between five nodes, in ns: an event may run before an
+ * earlier event of another node, up to the impact latency between them.
+ */
+static const char *g_impactLatency = "0 3000 5000 1000 2000;3000 0 2000 4000 6000;"
+  "5000 2000 0 3000 1000;1000 4000 3000 0 7000;2000 6000 1000 7000 0";
+
+/**
+ * Base of the ListScheduler test cases. Runs a scenario with the
+ * ListScheduler, recording the events executed, and compares the
+ * traces of two runs.
+ */
+class ListSchedulerTraceTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] name The name of the test case.
+   */
+  ListSchedulerTraceTestCase (std::string name);
+  /**
+   * Record an event executed, then call Follow.
+   * \param [in] id The id of the event.
+   */
+  void Record (uint32_t id);
+
+protected:
+  /**
+   * Called by Record once the event is recorded, to schedule more events.
+   * \param [in] id The id of the event.
+   */
+  virtual void Follow (uint32_t id);
+  /**
+   * Clear the trace and use a new ListScheduler.
+   * \param [in] impactLatency The ImpactLatency attribute of the scheduler.
+   */
+  void Start (std::string impactLatency = "");
+  /**
+   * Run the simulation until it stops and destroy it.
+   * \returns The trace of the run.
+   */
+  std::vector<uint64_t> Finish (void);
+  /**
+   * Schedule a Record event.
+   * \param [in] context The node of the event.
+   * \param [in] delay The delay of the event.
+   * \param [in] type The type of the event.
+   * \param [in] id The id of the event.
+   * \returns The event.
+   */
+  EventId ScheduleRecord (uint32_t context, Time delay, Scheduler::EventSchedulers_t type, uint32_t id);
+  /**
+   * Check that a trace is not empty and equal to another.
+   * \param [in] trace The trace.
+   * \param [in] expected The expected trace.
+   * \param [in] what What changed from the expected run.
+   */
+  void CheckTrace (const std::vector<uint64_t> &trace, const std::vector<uint64_t> &expected,
+                   std::string what);
+  /**
+   * Check that time never goes backwards in a trace.
+   * \param [in] trace The trace.
+   */
+  void CheckTimeOrder (const std::vector<uint64_t> &trace);
+
+  /** Events executed, (time in ns << 16) | id. */
+  std::vector<uint64_t> m_trace;
+  /** Events scheduled, by id. */
+  std::vector<EventId> m_ids;
+};
+
+ListSchedulerTraceTestCase::ListSchedulerTraceTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+ListSchedulerTraceTestCase::Record (uint32_t id)
+{
+  m_trace.push_back ((Simulator::Now ().GetNanoSeconds () << 16) | id);
+  Follow (id);
+}
+
+void
+ListSchedulerTraceTestCase::Follow (uint32_t id)
+{
+}
+
+void
+ListSchedulerTraceTestCase::Start (std::string impactLatency)
+{
+  m_trace.clear ();
+  m_ids.assign (200, EventId ());
+  ObjectFactory factory;
+  factory.SetTypeId (ListScheduler::GetTypeId ());
+  factory.Set ("ImpactLatency", StringValue (impactLatency));
+  Simulator::SetScheduler (factory);
+}
+
+std::vector<uint64_t>
+ListSchedulerTraceTestCase::Finish (void)
+{
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_trace;
+}
+
+EventId
+ListSchedulerTraceTestCase::ScheduleRecord (uint32_t context, Time delay,
+                                            Scheduler::EventSchedulers_t type, uint32_t id)
+{
+  EventImpl *event = MakeEvent (&ListSchedulerTraceTestCase::Record, this, id);
+  event->SetEventType (type);
+  if (context == Simulator::GetContext ())
+    {
+      return Simulator::Schedule (delay, type, event);
+    }
+  // only the events scheduled in the current context have an id
+  Simulator::ScheduleWithContext (context, delay, event);
+  return EventId ();
+}
+
+void
+ListSchedulerTraceTestCase::CheckTrace (const std::vector<uint64_t> &trace,
+                                        const std::vector<uint64_t> &expected,
+                                        std::string what)
+{
+  NS_TEST_ASSERT_MSG_EQ (expected.empty (), false, "No event was executed");
+  NS_TEST_ASSERT_MSG_EQ (trace.size (), expected.size (), what << " executed a different number of events");
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (trace[i], expected[i], what << " executed events in a different order");
+    }
+}
+
+void
+ListSchedulerTraceTestCase::CheckTimeOrder (const std::vector<uint64_t> &trace)
+{
+  for (uint32_t i = 1; i < trace.size (); i++)
+    {
+      uint64_t now = trace[i] >> 16;
+      uint64_t last = trace[i - 1] >> 16;
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (now, last, "Time went backwards");
+    }
+}
+
+class ListSchedulerIndexedTestCase : public ListSchedulerTraceTestCase
+{
+public:
+  ListSchedulerIndexedTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void Follow (uint32_t id);
+  std::vector<uint64_t> RunScenario (bool indexed, bool waiting);
+};
+
+ListSchedulerIndexedTestCase::ListSchedulerIndexedTestCase ()
+  : ListSchedulerTraceTestCase ("Check that indexed lists keep the ListScheduler event order")
+{
+}
+
+void
+ListSchedulerIndexedTestCase::Follow (uint32_t id)
+{
+  if (id % 3 == 0 && id < 1000)
+    {
+      ScheduleRecord (Simulator::GetContext (), MicroSeconds (7), Scheduler::UNDEFINED, id + 1000);
+    }
+}
+
+std::vector<uint64_t>
+ListSchedulerIndexedTestCase::RunScenario (bool indexed, bool waiting)
+{
+  Start ();
+  ListScheduler::SetIndexedList (indexed);
+  ListScheduler::SetWaitingList (waiting);
+
+  uint32_t seed = 12345;
+  for (uint32_t id = 0; id < 200; id++)
+    {
+      seed = seed * 1103515245 + 12345;
+      Scheduler::EventSchedulers_t type = id % 4 == 0 ? Scheduler::TIMEOUT : Scheduler::UNDEFINED;
+      m_ids[id] = ScheduleRecord (Simulator::GetContext (), MicroSeconds (1 + (seed >> 16) % 1000), type, id);
+    }
+  for (uint32_t id = 0; id < 200; id += 5)
+    {
+      Simulator::Remove (m_ids[id]);
+    }
+  Simulator::Stop (MicroSeconds (800));
+  std::vector<uint64_t> trace = Finish ();
+  ListScheduler::SetIndexedList (false);
+  ListScheduler::SetWaitingList (true);
+  return trace;
+}
+
+void
+ListSchedulerIndexedTestCase::DoRun (void)
+{
+  std::vector<uint64_t> linear = RunScenario (false, true);
+  std::vector<uint64_t> indexed = RunScenario (true, true);
+  CheckTrace (indexed, linear, "Indexed lists");
+  CheckTimeOrder (indexed);
+
+  // TIMEOUT events are ordinary events without waiting lists
+  linear = RunScenario (false, false);
+  indexed = RunScenario (true, false);
+  CheckTrace (indexed, linear, "Indexed lists without waiting lists");
+  CheckTimeOrder (indexed);
+}
+
+class ListSchedulerHeadHeapTestCase : public ListSchedulerTraceTestCase
+{
+public:
+  ListSchedulerHeadHeapTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void Follow (uint32_t id);
+  void Setup (uint32_t node);
+  void RemoveEvents (void);
+  std::vector<uint64_t> RunScenario (bool heap);
+};
+
+ListSchedulerHeadHeapTestCase::ListSchedulerHeadHeapTestCase ()
+  : ListSchedulerTraceTestCase ("Check that the head heap keeps the ListScheduler local list order")
+{
+}
+
+void
+ListSchedulerHeadHeapTestCase::Setup (uint32_t node)
+{
+  for (uint32_t id = node; id < 200; id += 5)
+    {
+      Scheduler::EventSchedulers_t type = id % 4 == 0 ? Scheduler::TIMEOUT : Scheduler::UNDEFINED;
+      // the nodes share timestamps
+      m_ids[id] = ScheduleRecord (node, NanoSeconds (1000 * (1 + (id * 7919) % 101)), type, id);
+    }
+}
+
+void
+ListSchedulerHeadHeapTestCase::RemoveEvents (void)
+{
+  for (uint32_t id = 3; id < 200; id += 7)
+    {
+      Simulator::Remove (m_ids[id]);
+    }
+}
+
+void
+ListSchedulerHeadHeapTestCase::Follow (uint32_t id)
+{
+  if (id % 3 == 0 && id < 1000)
+    {
+      ScheduleRecord (Simulator::GetContext (), NanoSeconds (1000 * (1 + id % 3)), Scheduler::UNDEFINED, id + 1000);
+    }
+}
+
+std::vector<uint64_t>
+ListSchedulerHeadHeapTestCase::RunScenario (bool heap)
+{
+  Start (g_impactLatency);
+  ListScheduler::SetLocalListv2 (false);
+  ListScheduler::SetHeadHeap (heap);
+
+  // events scheduled from the node contexts go to the node lists
+  for (uint32_t node = 0; node < 5; node++)
+    {
+      Simulator::ScheduleWithContext (node, Seconds (0), &ListSchedulerHeadHeapTestCase::Setup, this, node);
+    }
+  Simulator::Schedule (NanoSeconds (1), &ListSchedulerHeadHeapTestCase::RemoveEvents, this);
+  Simulator::Stop (MicroSeconds (800));
+  std::vector<uint64_t> trace = Finish ();
+  ListScheduler::SetHeadHeap (false);
+  ListScheduler::SetLocalListv2 (true);
+  return trace;
+}
+
+void
+ListSchedulerHeadHeapTestCase::DoRun (void)
+{
+  std::vector<uint64_t> scan = RunScenario (false);
+  std::vector<uint64_t> heap = RunScenario (true);
+  CheckTrace (heap, scan, "Head heap");
+  // the impact latencies do reorder the events, the earliest event first
+  // would not do
+  uint32_t early = 0;
+  for (uint32_t i = 1; i < scan.size (); i++)
+    {
+      early += (scan[i] >> 16) < (scan[i - 1] >> 16);
+    }
+  NS_TEST_EXPECT_MSG_GT (early, 0, "No event ran before an earlier one");
+}
+
+class ListSchedulerSymbolicWindowTestCase : public ListSchedulerTraceTestCase
+{
+public:
+  ListSchedulerSymbolicWindowTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void Follow (uint32_t id);
+  void Setup (uint32_t node);
+  std::vector<uint64_t> RunScenario (bool window, std::string impactLatency);
+};
+
+ListSchedulerSymbolicWindowTestCase::ListSchedulerSymbolicWindowTestCase ()
+  : ListSchedulerTraceTestCase ("Check that the symbolic window keeps the ListScheduler event order")
+{
+}
+
+void
+ListSchedulerSymbolicWindowTestCase::Setup (uint32_t node)
+{
+  for (uint32_t id = node; id < 200; id += 5)
+    {
+      EventImpl *event = MakeEvent (&ListSchedulerTraceTestCase::Record,
+                                    (ListSchedulerTraceTestCase *) this, id);
+      if (id % 2 == 0)
+        {
+          // symbolic delays are zero outside of S2E
+          event->SetTransmit (0);
+          ListScheduler::SetSymbolicDelay (1024, false);
+        }
+      m_ids[id] = Simulator::Schedule (NanoSeconds (1000 * (1 + (id * 7919) % 1009)),
+                                       Scheduler::UNDEFINED, event);
+    }
+  for (uint32_t id = node + 5 * (node % 2); id < 200; id += 35)
+    {
+      Simulator::Remove (m_ids[id]);
+    }
+}
+
+void
+ListSchedulerSymbolicWindowTestCase::Follow (uint32_t id)
+{
+  if (id % 3 == 0 && id < 1000)
+    {
+      EventImpl *event = MakeEvent (&ListSchedulerTraceTestCase::Record,
+                                    (ListSchedulerTraceTestCase *) this, id + 1000);
+      event->SetTransmit (0);
+      ListScheduler::SetSymbolicDelay (1, true);
+      Simulator::Schedule (NanoSeconds (1 + id), Scheduler::UNDEFINED, event);
+    }
+}
+
+std::vector<uint64_t>
+ListSchedulerSymbolicWindowTestCase::RunScenario (bool window, std::string impactLatency)
+{
+  Start (impactLatency);
+  ListScheduler::SetLocalListv2 (false);
+  ListScheduler::SetSymbolicWindow (window);
+
+  for (uint32_t node = 0; node < 5; node++)
+    {
+      Simulator::ScheduleWithContext (node, Seconds (0), &ListSchedulerSymbolicWindowTestCase::Setup, this, node);
+    }
+  Simulator::Stop (MicroSeconds (800));
+  std::vector<uint64_t> trace = Finish ();
+  ListScheduler::SetSymbolicWindow (false);
+  ListScheduler::SetLocalListv2 (true);
+  return trace;
+}
+
+void
+ListSchedulerSymbolicWindowTestCase::DoRun (void)
+{
+  std::vector<uint64_t> ordered = RunScenario (false, "");
+  std::vector<uint64_t> window = RunScenario (true, "");
+  CheckTrace (window, ordered, "Symbolic window");
+  // the next event stays in its list while symbolic events are released,
+  // the turn of the nodes does not move
+  ordered = RunScenario (false, g_impactLatency);
+  window = RunScenario (true, g_impactLatency);
+  CheckTrace (window, ordered, "Symbolic window with impact latencies");
+}
+
+class ListSchedulerDeadLockTestCase : public ListSchedulerTraceTestCase
+{
+public:
+  ListSchedulerDeadLockTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void Follow (uint32_t id);
+  /**
+   * Run 40 events on four nodes on a line.
+   * \param [in] packets Whether the events send a packet to each neighbour.
+   * \param [in] local Whether the local lists v2 are used, else the global list.
+   * \returns The trace of each node.
+   */
+  std::vector<std::vector<uint64_t> > RunScenario (bool packets, bool local);
+
+  /** Whether the first events send packets. */
+  bool m_packets;
+  /** Events executed by each node. */
+  std::vector<std::vector<uint64_t> > m_nodeTraces;
+};
+
+ListSchedulerDeadLockTestCase::ListSchedulerDeadLockTestCase ()
+  : ListSchedulerTraceTestCase ("Check that the ListScheduler resolves the deadlocks of local lists v2"),
+    m_packets (false)
+{
+}
+
+void
+ListSchedulerDeadLockTestCase::Follow (uint32_t id)
+{
+  uint32_t node = Simulator::GetContext ();
+  m_nodeTraces[node].push_back (m_trace.back ());
+  if (!m_packets || id >= 100)
+    {
+      return;
+    }
+  // a packet takes 1002 ns, so a node never gets two events at once
+  for (uint32_t neighbour = node == 0 ? 0 : node - 1; neighbour <= node + 1 && neighbour < 4; neighbour++)
+    {
+      if (neighbour != node)
+        {
+          EventImpl *event = MakeEvent (&ListSchedulerTraceTestCase::Record,
+                                        (ListSchedulerTraceTestCase *) this, id + 100);
+          Simulator::ScheduleWithContext (node, neighbour, NanoSeconds (1002), event);
+        }
+    }
+}
+
+std::vector<std::vector<uint64_t> >
+ListSchedulerDeadLockTestCase::RunScenario (bool packets, bool local)
+{
+  Start ();
+  ListScheduler::SetLocalList (local);
+  m_packets = packets;
+  m_nodeTraces.assign (4, std::vector<uint64_t> ());
+
+  // four nodes on a line, each node waits until its neighbours send it
+  // a packet
+  std::vector<std::vector<uint32_t> > interfaces (4);
+  for (uint32_t node = 0; node < 4; node++)
+    {
+      if (node > 0)
+        {
+          interfaces[node].push_back (node - 1);
+        }
+      if (node < 3)
+        {
+          interfaces[node].push_back (node + 1);
+        }
+    }
+  Simulator::SetInterfaceInfo (interfaces);
+
+  for (uint32_t id = 0; id < 40; id++)
+    {
+      ScheduleRecord (id % 4, NanoSeconds (4 * (1 + (id * 7919) % 101) + id % 4), Scheduler::UNDEFINED, id);
+    }
+  Finish ();
+  Simulator::SetInterfaceInfo (std::vector<std::vector<uint32_t> > ());
+  ListScheduler::SetLocalList (true);
+  return m_nodeTraces;
+}
+
+void
+ListSchedulerDeadLockTestCase::DoRun (void)
+{
+  // no packet ever arrives: a single deadlock, resolved for every event
+  uint32_t deadLocks = ListScheduler::GetDeadLocks ();
+  RunScenario (false, true);
+  NS_TEST_ASSERT_MSG_EQ (m_trace.size (), 40, "Events were not executed");
+  CheckTimeOrder (m_trace);
+  NS_TEST_EXPECT_MSG_EQ (ListScheduler::GetDeadLocks () - deadLocks, 1,
+                         "The deadlock should have been counted once");
+
+  // the packets forwarded by the resolver make the nodes ready again
+  std::vector<std::vector<uint64_t> > expected = RunScenario (true, false);
+  deadLocks = ListScheduler::GetDeadLocks ();
+  std::vector<std::vector<uint64_t> > traces = RunScenario (true, true);
+  NS_TEST_ASSERT_MSG_EQ (m_trace.size (), 40 + 60, "Events were not executed");
+  NS_TEST_EXPECT_MSG_GT (ListScheduler::GetDeadLocks () - deadLocks, 1,
+                         "No event ran between two deadlocks");
+  for (uint32_t node = 0; node < 4; node++)
+    {
+      CheckTrace (traces[node], expected[node], "Local lists v2");
+    }
+}
+
+class ListSchedulerPendingTestCase : public TestCase
+{
+public:
+  ListSchedulerPendingTestCase ();
+private:
+  virtual void DoRun (void);
+  static void Nothing (void);
+};
+
+ListSchedulerPendingTestCase::ListSchedulerPendingTestCase ()
+  : TestCase ("Check that the pending lists of TIMEOUT events keep their events")
+{
+}
+
+void
+ListSchedulerPendingTestCase::Nothing (void)
+{
+}
+
+void
+ListSchedulerPendingTestCase::DoRun (void)
+{
+  Ptr<ListScheduler> scheduler = CreateObject<ListScheduler> ();
+  Scheduler::Event none;
+  NS_TEST_ASSERT_MSG_EQ (none.pending, 0, "An event is built with a pending list");
+
+  uint32_t uid = 10;
+  // the second round reuses the arena nodes freed by the first one
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      // a TIMEOUT event, the events after it wait on it
+      std::vector<Scheduler::Event> events;
+      for (uint32_t i = 0; i < 6; i++)
+        {
+          Scheduler::Event ev;
+          ev.impl = MakeEvent (&ListSchedulerPendingTestCase::Nothing);
+          ev.key.m_ts = 100 * round + 10 * (i + 1);
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0xffffffff;
+          ev.key.m_originalTs = ev.key.m_ts;
+          ev.key.m_prevContext = 0;
+          ev.key.m_packetSize = 0;
+          ev.key.m_eventType = i == 0 ? Scheduler::TIMEOUT : Scheduler::UNDEFINED;
+          ev.key.m_isTransEvent = false;
+          if (i == 2)
+            {
+              // a copy of an event with a pending list does not bring it along
+              ev.pending = 1;
+            }
+          events.push_back (ev);
+          scheduler->Insert (ev);
+        }
+      scheduler->Remove (events[3]);
+      events[3].impl->Unref ();
+      events.erase (events.begin () + 3);
+
+      for (uint32_t i = 0; i < events.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "A pending event was lost");
+          Scheduler::Event next = scheduler->RemoveNext ();
+          NS_TEST_EXPECT_MSG_EQ (next.key.m_uid, events[i].key.m_uid, "A pending event is out of order");
+          next.impl->Unref ();
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "A removed event is still pending");
+    }
+}
+
+class ListSchedulerFastForwardTestCase : public ListSchedulerTraceTestCase
+{
+public:
+  ListSchedulerFastForwardTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void Follow (uint32_t id);
+};
+
+ListSchedulerFastForwardTestCase::ListSchedulerFastForwardTestCase ()
+  : ListSchedulerTraceTestCase ("Check that the fast-forward explorations fork between two events")
+{
+}
+
+void
+ListSchedulerFastForwardTestCase::Follow (uint32_t id)
+{
+  if (id < 3)
+    {
+      // a packet of link 0-1, received 100 ns later
+      SymbolicInjectionPolicy::GetDefault ()->Inject (0, 1, 0);
+      EventImpl *event = MakeEvent (&ListSchedulerTraceTestCase::Record,
+                                    (ListSchedulerTraceTestCase *) this, id + 100);
+      event->SetTransmit (0);
+      Simulator::Schedule (NanoSeconds (100), Scheduler::UNDEFINED, event);
+    }
+}
+
+void
+ListSchedulerFastForwardTestCase::DoRun (void)
+{
+  DelayExplorer::SetWorkers (1);
+  DelayExplorer::Enable (true);
+  Ptr<SymbolicInjectionPolicy> policy = SymbolicInjectionPolicy::GetDefault ();
+  policy->SetAttribute ("Links", StringValue ("0-1"));
+  policy->SetAttribute ("Packets", StringValue ("2-2"));
+  std::string forkReportFile = CreateTempDirFilename ("fast-forward.report");
+  std::vector<uint64_t> intervals;
+  intervals.push_back (20);
+  intervals.push_back (50);
+
+  Start ();
+  Simulator::SetNativeFastForward (forkReportFile, intervals);
+  for (uint32_t id = 0; id < 3; id++)
+    {
+      ScheduleRecord (0, NanoSeconds (10 * id), Scheduler::UNDEFINED, id);
+    }
+  std::vector<uint64_t> trace = Finish ();
+
+  if (!DelayExplorer::IsFirstPath ())
+    {
+      // the second packet, sent at 10 ns, is delayed within the interval
+      // of the exploration
+      uint64_t interval = policy->GetInterval (0, 1);
+      bool ok = false;
+      for (std::vector<uint64_t>::const_iterator i = trace.begin (); i != trace.end (); i++)
+        {
+          uint64_t ns = *i >> 16;
+          if ((*i & 0xffff) == 101)
+            {
+              ok = trace.size () == 6 && ns >= 110 && ns <= 110 + interval;
+            }
+        }
+      DelayExplorer::Wait ();
+      _exit (ok ? 0 : 1);
+    }
+  DelayExplorer::Enable (false);
+  policy->SetAttribute ("Links", StringValue ("0-2"));
+  policy->SetAttribute ("Packets", StringValue (""));
+  policy->SetInterval (1024);
+
+  std::ifstream report (forkReportFile.c_str ());
+  std::string line;
+  std::getline (report, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "packet 0 1 2", "The fork report does not record the selected packet");
+  // the event selecting the packet is over, no event runs after the fork
+  NS_TEST_ASSERT_MSG_EQ (trace.size (), 2, "The first path went on after the fork");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (DelayExplorer::GetPaths (), 3, "An interval was not explored");
+  NS_TEST_ASSERT_MSG_EQ (DelayExplorer::GetFailedPaths (), 0, "A packet is delayed out of its interval");
+}
+
+class SimulatorExpiredTestCase : public TestCase
+{
+public:
+  SimulatorExpiredTestCase ();
+  virtual void DoRun (void);
+  void First (void);
+  void Second (void);
+  EventId m_first;
+  EventId m_second;
+  bool m_firstExpired;
+  bool m_secondExpired;
+};
+
+SimulatorExpiredTestCase::SimulatorExpiredTestCase ()
+  : TestCase ("Check that an event expires once it is dequeued")
+{
+}
+
+void
+SimulatorExpiredTestCase::First (void)
+{
+  m_firstExpired = m_first.IsExpired ();
+  // same timestamp, not dequeued yet
+  m_secondExpired = m_second.IsExpired ();
+}
+
+void
+SimulatorExpiredTestCase::Second (void)
+{
+}
+
+void
+SimulatorExpiredTestCase::DoRun (void)
+{
+  m_first = Simulator::Schedule (MicroSeconds (5), &SimulatorExpiredTestCase::First, this);
+  m_second = Simulator::Schedule (MicroSeconds (5), &SimulatorExpiredTestCase::Second, this);
+  NS_TEST_EXPECT_MSG_EQ (m_first.IsExpired (), false, "Event expired before it ran");
+
+  // the new scheduler gets the events removed from the old one, which
+  // does not dequeue them
+  ObjectFactory factory;
+  factory.SetTypeId (MapScheduler::GetTypeId ());
+  Simulator::SetScheduler (factory);
+  NS_TEST_EXPECT_MSG_EQ (m_first.IsExpired (), false, "Event moved to another scheduler expired");
+  NS_TEST_EXPECT_MSG_EQ (m_second.IsExpired (), false, "Event moved to another scheduler expired");
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_firstExpired, true, "Running event not expired");
+  NS_TEST_EXPECT_MSG_EQ (m_secondExpired, false, "Event expired before it was dequeued");
+  NS_TEST_EXPECT_MSG_EQ (m_second.IsExpired (), true, "Event not expired after it ran");
+  Simulator::Destroy ();
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -459,12 +1148,90 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+#if !defined (NS3_NO_EVENT_POOL) && !defined (__SANITIZE_ADDRESS__)
+class EventPoolDepotTestCase : public TestCase
+{
+public:
+  EventPoolDepotTestCase ();
+private:
+  virtual void DoRun (void);
+  /** The event, never run. */
+  void Nothing (void);
+  /** Allocate and free events, then let the thread exit. */
+  void Release (void);
+  /** Allocate an event in a thread with no free event of its own. */
+  void Allocate (void);
+
+  /** The events freed by the first thread. */
+  std::set<EventImpl *> m_released;
+  /** The event allocated by the second thread. */
+  EventImpl *m_allocated;
+};
+
+EventPoolDepotTestCase::EventPoolDepotTestCase ()
+  : TestCase ("Check that the events freed by an exited thread are reused"),
+    m_allocated (0)
+{
+}
+
+void
+EventPoolDepotTestCase::Nothing (void)
+{
+}
+
+void
+EventPoolDepotTestCase::Release (void)
+{
+  std::vector<EventImpl *> events;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      events.push_back (MakeEvent (&EventPoolDepotTestCase::Nothing, this));
+    }
+  for (uint32_t i = 0; i < events.size (); i++)
+    {
+      m_released.insert (events[i]);
+      events[i]->Unref ();
+    }
+}
+
+void
+EventPoolDepotTestCase::Allocate (void)
+{
+  m_allocated = MakeEvent (&EventPoolDepotTestCase::Nothing, this);
+  m_allocated->Unref ();
+}
+
+void
+EventPoolDepotTestCase::DoRun (void)
+{
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&EventPoolDepotTestCase::Release, this));
+  thread->Start ();
+  thread->Join ();
+  // the free list of the exited thread is at the front of the depot
+  thread = Create<SystemThread> (MakeCallback (&EventPoolDepotTestCase::Allocate, this));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_EXPECT_MSG_EQ (m_released.count (m_allocated), 1, "The event was not taken from the depot");
+}
+#endif
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
   SimulatorTestSuite ()
     : TestSuite ("simulator")
   {
+    AddTestCase (new ListSchedulerIndexedTestCase (), TestCase::QUICK);
+    AddTestCase (new ListSchedulerHeadHeapTestCase (), TestCase::QUICK);
+    AddTestCase (new ListSchedulerSymbolicWindowTestCase (), TestCase::QUICK);
+    AddTestCase (new ListSchedulerDeadLockTestCase (), TestCase::QUICK);
+    AddTestCase (new ListSchedulerPendingTestCase (), TestCase::QUICK);
+    AddTestCase (new ListSchedulerFastForwardTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorExpiredTestCase (), TestCase::QUICK);
+#if !defined (NS3_NO_EVENT_POOL) && !defined (__SANITIZE_ADDRESS__)
+    AddTestCase (new EventPoolDepotTestCase (), TestCase::QUICK);
+#endif
+
     ObjectFactory factory;
     factory.SetTypeId (ListScheduler::GetTypeId ());
 
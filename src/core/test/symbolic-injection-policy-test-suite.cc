@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/symbolic-injection-policy.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/callback.h"
+#include <vector>
+
+using namespace ns3;
+
+class SymbolicInjectionPolicyLinksTestCase : public TestCase
+{
+public:
+  SymbolicInjectionPolicyLinksTestCase ();
+  virtual void DoRun (void);
+};
+
+SymbolicInjectionPolicyLinksTestCase::SymbolicInjectionPolicyLinksTestCase ()
+  : TestCase ("Check the symbolic links and packet ranges")
+{
+}
+
+void
+SymbolicInjectionPolicyLinksTestCase::DoRun (void)
+{
+  Ptr<SymbolicInjectionPolicy> policy = CreateObject<SymbolicInjectionPolicy> ();
+  NS_TEST_ASSERT_MSG_EQ (policy->GetInterval (0, 2), 1024, "The default link is 0-2");
+  NS_TEST_ASSERT_MSG_EQ (policy->GetInterval (2, 0), 1024, "Links work in both directions");
+  NS_TEST_ASSERT_MSG_EQ (policy->IsSymbolicPacket (1), false, "No symbolic packet by default");
+
+  policy->SetAttribute ("Links", StringValue ("0-1 3-2:64"));
+  policy->SetAttribute ("Packets", StringValue ("2-3 10-10"));
+  policy->SetAttribute ("Interval", UintegerValue (256));
+
+  StringValue links;
+  policy->GetAttribute ("Links", links);
+  NS_TEST_ASSERT_MSG_EQ (links.Get (), "0-1 3-2:64", "Links are not read back");
+  StringValue packets;
+  policy->GetAttribute ("Packets", packets);
+  NS_TEST_ASSERT_MSG_EQ (packets.Get (), "2-3 10-10", "Packet ranges are not read back");
+
+  NS_TEST_ASSERT_MSG_EQ (policy->GetInterval (1, 0), 256, "Link without an interval");
+  NS_TEST_ASSERT_MSG_EQ (policy->GetInterval (2, 3), 64, "Link with its own interval");
+  NS_TEST_ASSERT_MSG_EQ (policy->GetInterval (0, 2), 0, "0-2 is no longer symbolic");
+
+  NS_TEST_ASSERT_MSG_EQ (policy->IsSymbolicPacket (1), false, "Packet before the ranges");
+  NS_TEST_ASSERT_MSG_EQ (policy->IsSymbolicPacket (2), true, "First packet of a range");
+  NS_TEST_ASSERT_MSG_EQ (policy->IsSymbolicPacket (3), true, "Last packet of a range");
+  NS_TEST_ASSERT_MSG_EQ (policy->IsSymbolicPacket (4), false, "Packet between the ranges");
+  NS_TEST_ASSERT_MSG_EQ (policy->IsSymbolicPacket (10), true, "Single packet range");
+
+  NS_TEST_ASSERT_MSG_EQ (policy->GetMinimum (1, 0), 0, "No minimum by default");
+  policy->SetAttribute ("MinimumDelay", UintegerValue (16));
+  policy->SetAttribute ("Links", StringValue ("0-1 3-2:8-64"));
+  policy->GetAttribute ("Links", links);
+  NS_TEST_ASSERT_MSG_EQ (links.Get (), "0-1 3-2:8-64", "Link ranges are not read back");
+  NS_TEST_ASSERT_MSG_EQ (policy->GetMinimum (1, 0), 16, "Link without a minimum");
+  NS_TEST_ASSERT_MSG_EQ (policy->GetMinimum (2, 3), 8, "Link with its own minimum");
+  NS_TEST_ASSERT_MSG_EQ (policy->GetInterval (2, 3), 64, "Interval of a link range");
+
+  // the former Simulator::SetFirstSymPacket/SetNumberSymPackets settings
+  policy->SetNumberPackets (2);
+  policy->SetFirstPacket (5);
+  policy->GetAttribute ("Packets", packets);
+  NS_TEST_ASSERT_MSG_EQ (packets.Get (), "5-6", "First and number of packets");
+
+  // the default first packet, 0, is the first packet
+  Ptr<SymbolicInjectionPolicy> fresh = CreateObject<SymbolicInjectionPolicy> ();
+  fresh->SetNumberPackets (1);
+  NS_TEST_ASSERT_MSG_EQ (fresh->IsSymbolicPacket (1), true, "The default selects packet 1");
+  NS_TEST_ASSERT_MSG_EQ (fresh->IsSymbolicPacket (2), false, "The default selects one packet");
+  fresh->SetFirstPacket (0);
+  fresh->GetAttribute ("Packets", packets);
+  NS_TEST_ASSERT_MSG_EQ (packets.Get (), "1-1", "First packet 0 is packet 1");
+}
+
+class SymbolicInjectionPolicyDropTestCase : public TestCase
+{
+public:
+  SymbolicInjectionPolicyDropTestCase ();
+  virtual void DoRun (void);
+  void SymbolicPacket (uint32_t src, uint32_t dst, uint64_t rank);
+
+  std::vector<uint64_t> m_ranks;
+};
+
+SymbolicInjectionPolicyDropTestCase::SymbolicInjectionPolicyDropTestCase ()
+  : TestCase ("Check that symbolic drops deliver the packets outside of S2E")
+{
+}
+
+void
+SymbolicInjectionPolicyDropTestCase::SymbolicPacket (uint32_t src, uint32_t dst, uint64_t rank)
+{
+  NS_TEST_EXPECT_MSG_EQ (src, 0, "Only the link 0-2 is symbolic");
+  NS_TEST_EXPECT_MSG_EQ (dst, 2, "Only the link 0-2 is symbolic");
+  m_ranks.push_back (rank);
+}
+
+void
+SymbolicInjectionPolicyDropTestCase::DoRun (void)
+{
+  Ptr<SymbolicInjectionPolicy> policy = CreateObject<SymbolicInjectionPolicy> ();
+  policy->SetAttribute ("Target", EnumValue (SymbolicInjectionPolicy::DROP));
+  policy->SetAttribute ("Packets", StringValue ("1-2"));
+  policy->TraceConnectWithoutContext ("SymbolicPacket",
+                                      MakeCallback (&SymbolicInjectionPolicyDropTestCase::SymbolicPacket, this));
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (policy->Inject (0, 2, 0), true, "Symbolic drop outside of S2E");
+      NS_TEST_ASSERT_MSG_EQ (policy->Inject (1, 2, 0), true, "Packet on another link");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_ranks.size (), 2, "Selected packets are not traced");
+  NS_TEST_ASSERT_MSG_EQ (m_ranks.at (0), 1, "First selected packet");
+  NS_TEST_ASSERT_MSG_EQ (m_ranks.at (1), 2, "Second selected packet");
+}
+
+class SymbolicInjectionPolicyTestSuite : public TestSuite
+{
+public:
+  SymbolicInjectionPolicyTestSuite ();
+};
+
+SymbolicInjectionPolicyTestSuite::SymbolicInjectionPolicyTestSuite ()
+  : TestSuite ("symbolic-injection-policy", UNIT)
+{
+  AddTestCase (new SymbolicInjectionPolicyLinksTestCase, TestCase::QUICK);
+  AddTestCase (new SymbolicInjectionPolicyDropTestCase, TestCase::QUICK);
+}
+
+static SymbolicInjectionPolicyTestSuite symbolicInjectionPolicyTestSuite;
@@ -30,7 +30,11 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
-#include "ns3/list-scheduler.h"
+#include "ns3/pointer.h"
+// <M>
+#include "ns3/abort.h"
+#include "ns3/multithreaded-simulator-impl.h"
+// <M>
 //#include <stdio.h>
 
 namespace ns3 {
@@ -60,6 +64,12 @@ CsmaChannel::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&CsmaChannel::m_fullDuplex),
                    MakeBooleanChecker ())
+    .AddAttribute ("InjectionPolicy",
+                   "The policy selecting the symbolic packets, "
+                   "SymbolicInjectionPolicy::GetDefault () if null.",
+                   PointerValue (),
+                   MakePointerAccessor (&CsmaChannel::m_injectionPolicy),
+                   MakePointerChecker<SymbolicInjectionPolicy> ())
   ;
   return tid;
 }
@@ -199,6 +209,12 @@ CsmaChannel::TransmitStart (Ptr<Packet> p, uint32_t srcId)
 {
   NS_LOG_FUNCTION (this << p << srcId);
   NS_LOG_INFO ("UID is " << p->GetUid () << ")");
+  // <M>
+  // the channel state is shared by the nodes of the channel, which may
+  // run on different threads and at different times
+  NS_ABORT_MSG_IF (MultithreadedSimulatorImpl::IsRunningThreads (),
+                   "The CSMA channel is not supported by several node threads");
+  // <M>
 
   if (GetState (srcId) != IDLE)
     {
@@ -253,6 +269,13 @@ CsmaChannel::TransmitEnd (uint32_t srcId)
 
   NS_LOG_LOGIC ("Receive");
 
+  Ptr<SymbolicInjectionPolicy> policy = m_injectionPolicy;
+  if (policy == 0)
+    {
+      policy = SymbolicInjectionPolicy::GetDefault ();
+    }
+  uint32_t srcNode = m_deviceList[GetCurrentSrc (srcId)].devicePtr->GetNode ()->GetId ();
+
   std::vector<CsmaDeviceRec>::iterator it;
   uint32_t devId = 0;
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
@@ -262,20 +285,18 @@ CsmaChannel::TransmitEnd (uint32_t srcId)
       //
       if (!m_fullDuplex || (devId != GetCurrentSrc (srcId)))
         {
-          if (it->IsActive ())
+          if (it->IsActive ()
+              && policy->Inject (srcNode, it->devicePtr->GetNode ()->GetId (), m_delay.GetTimeStep ()))
             {
               // schedule reception events
               //printf ("CSMA - sending packet from node %u to node %u - arrive in %lu ms \n",
                   //m_deviceList[GetCurrentSrc (srcId)].devicePtr->GetNode ()->GetId (), 
                   //it->devicePtr->GetNode ()->GetId (), m_delay.GetMilliSeconds ());
-              ListScheduler::SetTransmitEvent (true);	   
-              ListScheduler::SetPacketSize (GetCurrentPkt (srcId)->GetSize ());
-              ListScheduler::SetSymLink (m_deviceList[GetCurrentSrc (srcId)].devicePtr->GetNode ()->GetId (),
-                                         it->devicePtr->GetNode ()->GetId ());
+              EventImpl *event = MakeEvent (&CsmaNetDevice::Receive, it->devicePtr,
+                                            GetCurrentPkt (srcId)->Copy (), m_deviceList[GetCurrentSrc (srcId)].devicePtr);
+              event->SetTransmit (GetCurrentPkt (srcId)->GetSize ());
               Simulator::ScheduleWithContext (m_deviceList[GetCurrentSrc (srcId)].devicePtr->GetNode ()->GetId (),
-                                              it->devicePtr->GetNode ()->GetId (), m_delay,
-                                              &CsmaNetDevice::Receive, it->devicePtr,
-                                              GetCurrentPkt (srcId)->Copy (), m_deviceList[GetCurrentSrc (srcId)].devicePtr);
+                                              it->devicePtr->GetNode ()->GetId (), m_delay, event);
             }
         }
       devId++;
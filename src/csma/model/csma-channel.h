@@ -32,6 +32,7 @@
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/boolean.h"
+#include "ns3/symbolic-injection-policy.h"
 
 namespace ns3 {
 
@@ -349,6 +350,11 @@ private:
    */
   Time          m_delay;
 
+  /**
+   * The policy selecting the symbolic packets, the default one if null
+   */
+  Ptr<SymbolicInjectionPolicy> m_injectionPolicy;
+
   /**
    * Whether the channel is in full-duplex mode.
    */
@@ -34,6 +34,9 @@
 #include "ns3/uinteger.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/loopback-net-device.h"
+#include "ns3/symbolic-trace.h"
+#include "ns3/delay-explorer.h"
+#include "ns3/hash.h"
 
 #include <stdio.h>
 #include "s2e.h"
@@ -51,10 +54,16 @@ Rip::Rip ()
   : m_ipv4 (0), m_splitHorizonStrategy (Rip::POISON_REVERSE), m_initialized (false)
 {
   m_rng = CreateObject<UniformRandomVariable> ();
+  // <M>
+  DelayExplorer::AddStateHash (MakeCallback (&Rip::GetStateHash, this));
+  // <M>
 }
 
 Rip::~Rip ()
 {
+  // <M>
+  DelayExplorer::RemoveStateHash (MakeCallback (&Rip::GetStateHash, this));
+  // <M>
 }
 
 TypeId
@@ -709,6 +718,30 @@ void Rip::DeleteRoute (RipRoutingTableEntry *route)
   NS_ABORT_MSG ("RIP::DeleteRoute - cannot find the route to delete");
 }
 
+// <M>
+uint64_t Rip::GetStateHash (void) const
+{
+  std::vector<uint32_t> state;
+  for (RoutesCI it = m_routes.begin (); it != m_routes.end (); it++)
+    {
+      RipRoutingTableEntry *route = it->first;
+      state.push_back (route->GetDestNetwork ().Get ());
+      state.push_back (route->GetDestNetworkMask ().Get ());
+      state.push_back (route->GetGateway ().Get ());
+      state.push_back (route->GetInterface ());
+      state.push_back (route->GetRouteMetric ());
+      state.push_back (route->GetRouteStatus ());
+      state.push_back (route->GetRouteTag ());
+      state.push_back (route->IsRouteChanged ());
+    }
+  if (state.empty ())
+    {
+      return 0;
+    }
+  return Hash64 (reinterpret_cast<const char *> (&state[0]), state.size () * sizeof (uint32_t));
+}
+// <M>
+
 
 void Rip::Receive (Ptr<Socket> socket)
 {
@@ -1139,7 +1172,9 @@ void Rip::HandleResponses (RipHeader hdr, Ipv4Address senderAddress, uint32_t in
 			  uint64_t now = GetObject<Node> ()->GetLocalTime ().GetTimeStep ();
 			  if (s2e_is_symbolic (&now, sizeof (uint64_t)))
 			    {
-			      s2e_print_expression ("Updated time", now);	
+			      SymbolicTrace::Symbolic (SymbolicTrace::ROUTES_UPDATED, 0,
+			                               GetObject<Node> ()->GetId (),
+			                               "Updated time", now, 0);
 		        }
 			}		                              	
 		}
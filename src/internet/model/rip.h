@@ -369,6 +369,17 @@ private:
    */
   void DeleteRoute (RipRoutingTableEntry *route);
 
+  // <M>
+  /**
+   * \brief Hash of the routes, registered with the DelayExplorer.
+   *
+   * The route timers are scheduled events, compared by the DelayExplorer.
+   *
+   * \returns the hash
+   */
+  uint64_t GetStateHash (void) const;
+  // <M>
+
   Routes m_routes; //!<  the forwarding table for network.
   Ptr<Ipv4> m_ipv4; //!< IPv4 reference
   Time m_startupDelay; //!< Random delay before protocol startup.
@@ -56,6 +56,8 @@
 
 #include "ns3/scheduler.h"
 #include "ns3/list-scheduler.h"
+#include "ns3/delay-explorer.h"
+#include "ns3/hash.h"
 
 namespace ns3 {
 
@@ -324,6 +326,9 @@ TcpSocketBase::TcpSocketBase (void)
   ok = m_tcb->TraceConnectWithoutContext ("CongState",
                                           MakeCallback (&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT (ok == true);
+  // <M>
+  DelayExplorer::AddStateHash (MakeCallback (&TcpSocketBase::GetStateHash, this));
+  // <M>
 }
 
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
@@ -413,6 +418,9 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   ok = m_tcb->TraceConnectWithoutContext ("CongState",
                                           MakeCallback (&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT (ok == true);
+  // <M>
+  DelayExplorer::AddStateHash (MakeCallback (&TcpSocketBase::GetStateHash, this));
+  // <M>
 }
 
 TcpSocketBase::~TcpSocketBase (void)
@@ -442,6 +450,9 @@ TcpSocketBase::~TcpSocketBase (void)
     }
   m_tcp = 0;
   CancelAllTimers ();
+  // <M>
+  DelayExplorer::RemoveStateHash (MakeCallback (&TcpSocketBase::GetStateHash, this));
+  // <M>
 }
 
 /* Associate a node with this TCP socket */
@@ -813,11 +824,10 @@ TcpSocketBase::Send (Ptr<Packet> p, uint32_t flags)
             {
               // <M>
 //              printf ("Scheduling in Send, event pointed to SendPendingData\n");
-              ListScheduler::SetEventType (Scheduler::NODE);
+              m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1), Scheduler::NODE,
+                                                            MakeEvent (&TcpSocketBase::SendPendingData, this,
+                                                                       m_connected));
               // <M>
-              m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1),
-                                                            &TcpSocketBase::SendPendingData,
-                                                            this, m_connected);
             }
         }
       return p->GetSize ();
@@ -1289,10 +1299,9 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                     (Simulator::Now () + m_persistTimeout).GetSeconds ());
       // <M>
 //      printf ("Scheduling persist timeout at %lu ms in DoForwardUp\n", (Simulator::Now () + m_persistTimeout).GetMilliSeconds());
-      ListScheduler::SetEventType (Scheduler::TIMEOUT);
+      m_persistEvent = Simulator::Schedule (m_persistTimeout, Scheduler::TIMEOUT,
+                                            MakeEvent (&TcpSocketBase::PersistTimeout, this));
       // <M>
-
-      m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
       NS_ASSERT (m_persistTimeout == Simulator::GetDelayLeft (m_persistEvent));
     }
 
@@ -1358,11 +1367,10 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
         {
           // <M>
 //          printf ("Scheduling in DoForwardUp, event pointed to SendPendingData\n");
-          ListScheduler::SetEventType (Scheduler::NODE);
+          m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1), Scheduler::NODE,
+                                                        MakeEvent (&TcpSocketBase::SendPendingData, this,
+                                                                   m_connected));
           // <M>
-          m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1),
-                                                        &TcpSocketBase::SendPendingData,
-                                                        this, m_connected);
         }
     }
 }
@@ -1683,11 +1691,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         {
           // <M>
 //          printf ("Scheduling in ReceiveAck, event pointed to SendPendingData\n");
-          ListScheduler::SetEventType (Scheduler::NODE);
+          m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1), Scheduler::NODE,
+                                                        MakeEvent (&TcpSocketBase::SendPendingData, this,
+                                                                   m_connected));
           // <M>
-          m_sendPendingDataEvent = Simulator::Schedule (TimeStep (1),
-                                                        &TcpSocketBase::SendPendingData,
-                                                        this, m_connected);
         }
     }
 
@@ -1726,10 +1733,10 @@ TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
   NS_LOG_LOGIC ("Cloned a TcpSocketBase " << newSock);
   
   // <M>
-  ListScheduler::SetEventType (Scheduler::NODE);
+  Simulator::ScheduleNow (Scheduler::NODE,
+                          MakeEvent (&TcpSocketBase::CompleteFork, newSock,
+                                     packet, tcpHeader, fromAddress, toAddress));
   // <M>
-  Simulator::ScheduleNow (&TcpSocketBase::CompleteFork, newSock,
-                          packet, tcpHeader, fromAddress, toAddress);
 }
 
 /* Received a packet upon SYN_SENT */
@@ -1751,9 +1758,9 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       ReceivedData (packet, tcpHeader);
       
       // <M>
-      ListScheduler::SetEventType (Scheduler::NODE);
+      Simulator::ScheduleNow (Scheduler::NODE,
+                              MakeEvent (&TcpSocketBase::ConnectionSucceeded, this));
       // <M>
-      Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
     }
   else if (tcpflags == TcpHeader::ACK)
     { // Ignore ACK in SYN_SENT
@@ -1785,10 +1792,9 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       SendPendingData (m_connected);
       
       // <M>
-      ListScheduler::SetEventType (Scheduler::NODE);
+      Simulator::ScheduleNow (Scheduler::NODE,
+                              MakeEvent (&TcpSocketBase::ConnectionSucceeded, this));
       // <M>
-      
-      Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
       // Always respond to first data packet to speed up the connection.
       // Remove to get the behaviour of old NS-3 code.
       m_delAckCount = m_delAckMaxCount;
@@ -2119,10 +2125,9 @@ TcpSocketBase::DoPeerClose (void)
       Time lastRto = m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4);
       // <M>
 //      printf ("Scheduling in DoPeerClose, event pointed to LastAckTimeout\n");
-      ListScheduler::SetEventType (Scheduler::TIMEOUT);
-//      ListScheduler::SetEventType (Scheduler::NODE);
+      m_lastAckEvent = Simulator::Schedule (lastRto, Scheduler::TIMEOUT,
+                                            MakeEvent (&TcpSocketBase::LastAckTimeout, this));
       // <M>
-      m_lastAckEvent = Simulator::Schedule (lastRto, &TcpSocketBase::LastAckTimeout, this);
     }
 }
 
@@ -2293,11 +2298,9 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
       // <M>
 //      printf ("Scheduling ReTxTimeout at %lu ms in SendEmptyPacket\n", (Simulator::Now () + m_rto.Get ()).ToInteger (Time::MS));
-      ListScheduler::SetEventType (Scheduler::TIMEOUT);
-//      ListScheduler::SetEventType (Scheduler::NODE);
+      m_retxEvent = Simulator::Schedule (m_rto, Scheduler::TIMEOUT,
+                                         MakeEvent (&TcpSocketBase::SendEmptyPacket, this, flags));
       // <M>
-
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
     }
 }
 
@@ -2551,10 +2554,9 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
       // <M>
 //      printf ("Scheduling ReTxTimeout at %lu ms in SendDataPacket\n", (Simulator::Now () + m_rto.Get ()).ToInteger (Time::MS));
-      ListScheduler::SetEventType (Scheduler::TIMEOUT);
-//     ListScheduler::SetEventType (Scheduler::NODE);
+      m_retxEvent = Simulator::Schedule (m_rto, Scheduler::TIMEOUT,
+                                         MakeEvent (&TcpSocketBase::ReTxTimeout, this));
       // <M>
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
   m_txTrace (p, header, this);
@@ -2582,10 +2584,10 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   if (seq + sz > m_highTxMark)
     {
 	  // <M>
-	  ListScheduler::SetEventType (Scheduler::NODE);
+      Simulator::ScheduleNow (Scheduler::NODE,
+                              MakeEvent (&TcpSocketBase::NotifyDataSent, this,
+                                         (seq + sz - m_highTxMark.Get ())));
 	  // <M>	
-		
-      Simulator::ScheduleNow (&TcpSocketBase::NotifyDataSent, this, (seq + sz - m_highTxMark.Get ()));
     }
   // Update highTxMark
   m_highTxMark = std::max (seq + sz, m_highTxMark.Get ());
@@ -2790,11 +2792,9 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
           // <M>
 //          printf ("Scheduling DelAckTimeout at %lu ms in ReceivedData\n", 
 //                  (Simulator::Now() + Simulator::GetDelayLeft (m_delAckEvent)).GetMilliSeconds ());
-          ListScheduler::SetEventType (Scheduler::TIMEOUT);
-//          ListScheduler::SetEventType (Scheduler::NODE);        
+          m_delAckEvent = Simulator::Schedule (m_delAckTimeout, Scheduler::TIMEOUT,
+                                               MakeEvent (&TcpSocketBase::DelAckTimeout, this));
           // <M>
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
                         (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
         }
@@ -2901,10 +2901,9 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
       // <M>
 //      printf ("Scheduling ReTxTimeout event in NewAck at %lu ms\n", (Simulator::Now() + m_rto.Get()).ToInteger (Time::MS));
-      ListScheduler::SetEventType (Scheduler::TIMEOUT);
-//      ListScheduler::SetEventType (Scheduler::NODE);
+      m_retxEvent = Simulator::Schedule (m_rto, Scheduler::TIMEOUT,
+                                         MakeEvent (&TcpSocketBase::ReTxTimeout, this));
       // <M>
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
   // Note the highest ACK and tell app to send more
@@ -3019,10 +3018,9 @@ TcpSocketBase::PersistTimeout ()
                 << (Simulator::Now () + m_persistTimeout).GetSeconds ());
   // <M>
 //  printf ("Scheduling in PersistTimeout at %lu ms in PersistTimeout\n", (Simulator::Now() + m_persistTimeout).GetMilliSeconds());
-  ListScheduler::SetEventType (Scheduler::TIMEOUT);
-//  ListScheduler::SetEventType (Scheduler::NODE);
+  m_persistEvent = Simulator::Schedule (m_persistTimeout, Scheduler::TIMEOUT,
+                                        MakeEvent (&TcpSocketBase::PersistTimeout, this));
   // <M>
-  m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
 }
 
 void
@@ -3157,11 +3155,9 @@ TcpSocketBase::TimeWait ()
   // according to RFC793, p.28
   
   // <M>
-  ListScheduler::SetEventType (Scheduler::SIMULATOR);
+  m_timewaitEvent = Simulator::Schedule (Seconds (2 * m_msl), Scheduler::SIMULATOR,
+                                         MakeEvent (&TcpSocketBase::CloseAndNotify, this));
   // <M>
-  
-  m_timewaitEvent = Simulator::Schedule (Seconds (2 * m_msl),
-                                         &TcpSocketBase::CloseAndNotify, this);
 }
 
 /* Below are the attribute get/set functions */
@@ -3561,6 +3557,54 @@ TcpSocketBase::SafeSubtraction (uint32_t a, uint32_t b)
   return 0;
 }
 
+// <M>
+uint64_t
+TcpSocketBase::GetStateHash (void) const
+{
+  std::vector<int64_t> state;
+  state.push_back (m_state.Get ());
+  state.push_back (m_nextTxSequence.Get ().GetValue ());
+  state.push_back (m_highTxMark.Get ().GetValue ());
+  state.push_back (m_highRxMark.Get ().GetValue ());
+  state.push_back (m_highRxAckMark.Get ().GetValue ());
+  state.push_back (m_highTxAck.GetValue ());
+  state.push_back (m_recover.GetValue ());
+  state.push_back (m_rxBuffer->NextRxSequence ().GetValue ());
+  state.push_back (m_rxBuffer->Size ());
+  state.push_back (m_rxBuffer->Available ());
+  state.push_back (m_txBuffer->HeadSequence ().GetValue ());
+  state.push_back (m_txBuffer->Size ());
+  state.push_back (m_tcb->m_cWnd.Get ());
+  state.push_back (m_tcb->m_ssThresh.Get ());
+  state.push_back (m_tcb->m_congState.Get ());
+  state.push_back (m_rWnd.Get ());
+  state.push_back (m_bytesInFlight.Get ());
+  state.push_back (m_bytesAckedNotProcessed);
+  state.push_back (m_dupAckCount);
+  state.push_back (m_delAckCount);
+  state.push_back (m_synCount);
+  state.push_back (m_dataRetrCount);
+  state.push_back (m_retransOut);
+  state.push_back (m_isFirstPartialAck);
+  state.push_back (m_timestampToEcho);
+  state.push_back (m_rto.Get ().GetTimeStep ());
+  state.push_back (m_lastRtt.Get ().GetTimeStep ());
+  if (m_rtt != 0)
+    {
+      state.push_back (m_rtt->GetEstimate ().GetTimeStep ());
+      state.push_back (m_rtt->GetVariation ().GetTimeStep ());
+    }
+  for (RttHistory_t::const_iterator i = m_history.begin (); i != m_history.end (); i++)
+    {
+      state.push_back (i->seq.GetValue ());
+      state.push_back (i->count);
+      state.push_back (i->time.GetTimeStep ());
+      state.push_back (i->retx);
+    }
+  return Hash64 (reinterpret_cast<const char *> (&state[0]), state.size () * sizeof (int64_t));
+}
+// <M>
+
 //RttHistory methods
 RttHistory::RttHistory (SequenceNumber32 s, uint32_t c, Time t)
   : seq (s),
@@ -906,6 +906,18 @@ protected:
    */
   static uint32_t SafeSubtraction (uint32_t a, uint32_t b);
 
+  // <M>
+  /**
+   * \brief Hash of the connection state, registered with the DelayExplorer
+   *
+   * The sequence numbers, buffers, congestion window, RTO and RTT samples.
+   * The timers are scheduled events, compared by the DelayExplorer.
+   *
+   * \return the hash
+   */
+  uint64_t GetStateHash (void) const;
+  // <M>
+
 protected:
   // Counters and events
   EventId           m_retxEvent;       //!< Retransmission event
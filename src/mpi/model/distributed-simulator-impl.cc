@@ -486,6 +486,9 @@ DistributedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
   ev.key.m_context = GetContext ();
   ev.key.m_uid = m_uid;
+  // <M>
+  ev.key.m_eventType = event->GetEventType ();
+  // <M>
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
@@ -502,6 +505,9 @@ DistributedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &del
   ev.key.m_ts = m_currentTs + delay.GetTimeStep ();
   ev.key.m_context = context;
   ev.key.m_uid = m_uid;
+  // <M>
+  ev.key.m_eventType = event->GetEventType ();
+  // <M>
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
@@ -517,6 +523,9 @@ DistributedSimulatorImpl::ScheduleNow (EventImpl *event)
   ev.key.m_ts = m_currentTs;
   ev.key.m_context = GetContext ();
   ev.key.m_uid = m_uid;
+  // <M>
+  ev.key.m_eventType = event->GetEventType ();
+  // <M>
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
@@ -413,6 +413,9 @@ NullMessageSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
   ev.key.m_context = GetContext ();
   ev.key.m_uid = m_uid;
+  // <M>
+  ev.key.m_eventType = event->GetEventType ();
+  // <M>
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
@@ -434,6 +437,9 @@ NullMessageSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &del
   ev.key.m_ts = tAbsolute.GetTimeStep ();
   ev.key.m_context = context;
   ev.key.m_uid = m_uid;
+  // <M>
+  ev.key.m_eventType = event->GetEventType ();
+  // <M>
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
@@ -449,6 +455,9 @@ NullMessageSimulatorImpl::ScheduleNow (EventImpl *event)
   ev.key.m_ts = m_currentTs;
   ev.key.m_context = GetContext ();
   ev.key.m_uid = m_uid;
+  // <M>
+  ev.key.m_eventType = event->GetEventType ();
+  // <M>
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
@@ -28,7 +28,6 @@
 #include "ns3/simulator.h"
 
 #include "ns3/scheduler.h"
-#include "ns3/list-scheduler.h"
 
 namespace ns3 {
 
@@ -99,8 +98,10 @@ Application::DoInitialize (void)
   m_startEvent = Simulator::Schedule (m_startTime, &Application::StartApplication, this);
   if (m_stopTime != TimeStep (0))
     {
-	  ListScheduler::SetEventType (Scheduler::STOP);	
-      m_stopEvent = Simulator::Schedule (m_stopTime, &Application::StopApplication, this);
+      // <M>
+      m_stopEvent = Simulator::Schedule (m_stopTime, Scheduler::STOP,
+                                         MakeEvent (&Application::StopApplication, this));
+      // <M>
     }
   Object::DoInitialize ();
 }
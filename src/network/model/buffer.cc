@@ -49,8 +49,13 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
-
+// <M>
+#ifdef NS3_NODE_THREADS
+__thread uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
+// <M>
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -262,13 +267,16 @@ Buffer::operator = (Buffer const&o)
   if (m_data != o.m_data) 
     {
       // not assignment to self.
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      // <M>
+      if (AtomicDecrement (m_data->m_count) == 0)
+      // <M>
         {
           Recycle (m_data);
         }
       m_data = o.m_data;
-      m_data->m_count++;
+      // <M>
+      AtomicIncrement (m_data->m_count);
+      // <M>
     }
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
@@ -285,8 +293,9 @@ Buffer::~Buffer ()
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  // <M>
+  if (AtomicDecrement (m_data->m_count) == 0)
+  // <M>
     {
       Recycle (m_data);
     }
@@ -310,7 +319,14 @@ Buffer::AddAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+  // <M>
+#ifdef NS3_NODE_THREADS
+  // another node may be writing to the shared data
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+#endif
+  // <M>
   if (m_start >= start && !isDirty)
     {
       /* enough space in the buffer and not dirty. 
@@ -328,8 +344,9 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      // <M>
+      if (AtomicDecrement (m_data->m_count) == 0)
+      // <M>
         {
           Buffer::Recycle (m_data);
         }
@@ -355,7 +372,14 @@ Buffer::AddAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  // <M>
+#ifdef NS3_NODE_THREADS
+  // another node may be writing to the shared data
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+#endif
+  // <M>
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
       /* enough space in buffer and not dirty
@@ -373,8 +397,9 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      // <M>
+      if (AtomicDecrement (m_data->m_count) == 0)
+      // <M>
         {
           Buffer::Recycle (m_data);
         }
@@ -24,8 +24,14 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+// <M>
+#include "ns3/atomic-count.h"
 
+// the free list is shared by all the nodes
+#ifndef NS3_NODE_THREADS
 #define BUFFER_FREE_LIST 1
+#endif
+// <M>
 
 namespace ns3 {
 
@@ -761,7 +767,14 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
+  // <M>
+#ifdef NS3_NODE_THREADS
+  // one per node thread, the buffers being created concurrently
+  static __thread uint32_t g_recommendedStart;
+#else
   static uint32_t g_recommendedStart;
+#endif
+  // <M>
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -1049,7 +1062,9 @@ Buffer::Buffer (Buffer const&o)
     m_start (o.m_start),
     m_end (o.m_end)
 {
-  m_data->m_count++;
+  // <M>
+  AtomicIncrement (m_data->m_count);
+  // <M>
   NS_ASSERT (CheckInternalState ());
 }
 
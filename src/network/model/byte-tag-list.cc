@@ -19,10 +19,18 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+// <M>
+#include "ns3/atomic-count.h"
+// <M>
 #include <vector>
 #include <cstring>
 
+// <M>
+// the free list is shared by all the nodes
+#ifndef NS3_NODE_THREADS
 #define USE_FREE_LIST 1
+#endif
+// <M>
 #define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (2147483647)
 
@@ -156,7 +164,9 @@ ByteTagList::ByteTagList (const ByteTagList &o)
   NS_LOG_FUNCTION (this << &o);
   if (m_data != 0)
     {
-      m_data->count++;
+      // <M>
+      AtomicIncrement (m_data->count);
+      // <M>
     }
 }
 ByteTagList &
@@ -175,7 +185,9 @@ ByteTagList::operator = (const ByteTagList &o)
   m_used = o.m_used;
   if (m_data != 0)
     {
-      m_data->count++;
+      // <M>
+      AtomicIncrement (m_data->count);
+      // <M>
     }
   return *this;
 }
@@ -199,7 +211,14 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_used = 0;
     } 
   else if (m_data->size < spaceNeeded ||
+// <M>
+#ifdef NS3_NODE_THREADS
+           // another node may be adding to the shared data
+           m_data->count != 1)
+#else
            (m_data->count != 1 && m_data->dirty != m_used))
+#endif
+// <M>
     {
       struct ByteTagListData *newData = Allocate (spaceNeeded);
       std::memcpy (&newData->data, &m_data->data, m_used);
@@ -375,8 +394,9 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
       return;
     }
   g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
+  // <M>
+  if (AtomicDecrement (data->count) == 0)
+  // <M>
     {
       if (g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
@@ -413,8 +433,9 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  data->count--;
-  if (data->count == 0)
+  // <M>
+  if (AtomicDecrement (data->count) == 0)
+  // <M>
     {
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
@@ -23,6 +23,14 @@
 #include "ns3/assert.h"
 #include "channel-list.h"
 #include "channel.h"
+// <M>
+#include "node-list.h"
+#include "node.h"
+#include "net-device.h"
+#include "ns3/nstime.h"
+#include <queue>
+#include <functional>
+// <M>
 
 namespace ns3 {
 
@@ -245,4 +253,85 @@ ChannelList::GetNChannels (void)
   return ChannelListPriv::Get ()->GetNChannels ();
 }
 
+// <M>
+std::vector<std::vector<uint64_t> >
+ChannelList::GetImpactLatency (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  typedef std::pair<uint64_t, uint32_t> Hop;
+  uint32_t nNodes = NodeList::GetNNodes ();
+  uint64_t unreachable = Simulator::GetMaximumSimulationTime ().GetTimeStep ();
+
+  // every channel connects all the nodes attached to it
+  std::vector<std::vector<Hop> > links (nNodes);
+  for (Iterator i = Begin (); i != End (); i++)
+    {
+      Ptr<Channel> channel = *i;
+      TimeValue delay;
+      uint64_t latency = 0;
+      if (channel->GetAttributeFailSafe ("Delay", delay))
+        {
+          latency = delay.Get ().GetTimeStep ();
+        }
+      std::vector<uint32_t> nodes;
+      for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> device = channel->GetDevice (j);
+          if (device != 0 && device->GetNode () != 0)
+            {
+              nodes.push_back (device->GetNode ()->GetId ());
+            }
+        }
+      for (uint32_t j = 0; j < nodes.size (); j++)
+        {
+          for (uint32_t k = 0; k < nodes.size (); k++)
+            {
+              if (nodes[j] != nodes[k])
+                {
+                  links.at (nodes[j]).push_back (Hop (latency, nodes[k]));
+                }
+            }
+        }
+    }
+
+  // shortest paths from every node
+  std::vector<std::vector<uint64_t> > impactLatency (nNodes);
+  for (uint32_t src = 0; src < nNodes; src++)
+    {
+      std::vector<uint64_t> &latency = impactLatency.at (src);
+      latency.assign (nNodes, unreachable);
+      latency.at (src) = 0;
+      std::priority_queue<Hop, std::vector<Hop>, std::greater<Hop> > queue;
+      queue.push (Hop (0, src));
+      while (!queue.empty ())
+        {
+          Hop hop = queue.top ();
+          queue.pop ();
+          if (hop.first > latency.at (hop.second))
+            {
+              continue;
+            }
+          for (std::vector<Hop>::const_iterator j = links.at (hop.second).begin ();
+               j != links.at (hop.second).end (); j++)
+            {
+              uint64_t through = hop.first + j->first;
+              if (through < latency.at (j->second))
+                {
+                  latency.at (j->second) = through;
+                  queue.push (Hop (through, j->second));
+                }
+            }
+        }
+    }
+  return impactLatency;
+}
+
+void
+ChannelList::UpdateImpactLatency (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Simulator::SetImpactLatency (GetImpactLatency ());
+}
+// <M>
+
 } // namespace ns3
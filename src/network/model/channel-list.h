@@ -20,6 +20,7 @@
 #define CHANNEL_LIST_H
 
 #include <vector>
+#include <stdint.h>
 #include "ns3/ptr.h"
 
 namespace ns3 {
@@ -68,6 +69,24 @@ public:
    * \returns the number of channels currently in the list.
    */
   static uint32_t GetNChannels (void);
+  // <M>
+  /**
+   * \returns the impact latency matrix of the topology: entry j of row i
+   *          is the shortest propagation delay, in time steps, from node i
+   *          to node j over the channels of this list.
+   *
+   * A channel without a "Delay" attribute counts as zero delay, and nodes
+   * that cannot reach each other get the maximum simulation time.
+   */
+  static std::vector<std::vector<uint64_t> > GetImpactLatency (void);
+  /**
+   * Hand GetImpactLatency() to the simulator now. The simulator otherwise
+   * calls GetImpactLatency() itself when it first needs the matrix, the
+   * NodeList registering it as the Simulator impact latency source when
+   * the first node is created.
+   */
+  static void UpdateImpactLatency (void);
+  // <M>
 };
 
 } // namespace ns3
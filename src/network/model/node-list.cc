@@ -26,6 +26,9 @@
 #include "ns3/assert.h"
 #include "node-list.h"
 #include "node.h"
+// <M>
+#include "channel-list.h"
+// <M>
 
 namespace ns3 {
 
@@ -178,6 +181,14 @@ NodeListPriv::Add (Ptr<Node> node)
   NS_LOG_FUNCTION (this << node);
   uint32_t index = m_nodes.size ();
   m_nodes.push_back (node);
+  // <M>
+  if (index == 0)
+    {
+      // computed when a simulator implementation needs it, once the
+      // topology is built
+      Simulator::SetImpactLatencySource (MakeCallback (&ChannelList::GetImpactLatency));
+    }
+  // <M>
   Simulator::ScheduleWithContext (index, TimeStep (0), &Node::Initialize, node);
   return index;
 
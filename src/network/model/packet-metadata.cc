@@ -22,6 +22,12 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+// <M>
+#include "ns3/abort.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/multithreaded-simulator-impl.h"
+// <M>
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -59,6 +65,14 @@ PacketMetadata::Enable (void)
                  "after sending any packets.  One way to fix this problem is "
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
+  // <M>
+  // the metadata of the packets shared between node threads is not locked
+  StringValue impl;
+  GlobalValue::GetValueByName ("SimulatorImplementationType", impl);
+  NS_ABORT_MSG_IF (MultithreadedSimulatorImpl::IsInUse ()
+                   || impl.Get () == "ns3::MultithreadedSimulatorImpl",
+                   "The packet metadata is not supported by the MultithreadedSimulatorImpl");
+  // <M>
   m_enable = true;
 }
 
@@ -77,8 +91,9 @@ PacketMetadata::ReserveCopy (uint32_t size)
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
   memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  // <M>
+  if (AtomicDecrement (m_data->m_count) == 0)
+  // <M>
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -597,7 +612,12 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
+  // <M>
+  // the free list is shared by all the nodes
+#ifndef NS3_NODE_THREADS
   if (!m_enable)
+#endif
+  // <M>
     {
       PacketMetadata::Deallocate (data);
       return;
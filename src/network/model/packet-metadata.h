@@ -26,6 +26,9 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
+// <M>
+#include "ns3/atomic-count.h"
+// <M>
 #include "buffer.h"
 
 namespace ns3 {
@@ -708,7 +711,9 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
 {
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  // <M>
+  AtomicIncrement (m_data->m_count);
+  // <M>
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -717,14 +722,17 @@ PacketMetadata::operator = (PacketMetadata const& o)
     {
       // not self assignment
       NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      // <M>
+      if (AtomicDecrement (m_data->m_count) == 0)
+      // <M>
         {
           PacketMetadata::Recycle (m_data);
         }
       m_data = o.m_data;
       NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      // <M>
+  AtomicIncrement (m_data->m_count);
+  // <M>
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -735,8 +743,9 @@ PacketMetadata::operator = (PacketMetadata const& o)
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  // <M>
+  if (AtomicDecrement (m_data->m_count) == 0)
+  // <M>
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -132,13 +132,13 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
     {
       NS_ASSERT (cur != 0);
       NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
+      AtomicDecrement (cur->count);       // unmerge cur
       struct TagData * copy = new struct TagData ();
       copy->tid = cur->tid;
       copy->count = 1;
       memcpy (copy->data, cur->data, TagData::MAX_SIZE);
       copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
+      AtomicIncrement (copy->next->count);  // mark new merge
       *prevNext = copy;                   // point prior list at copy
       prevNext = &copy->next;             // advance
       cur      =  copy->next;
@@ -183,11 +183,11 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
     {
       // cur is always a merge at this point
       // unmerge cur, since we linked around it already
-      cur->count--;
+      AtomicDecrement (cur->count);
       if (cur->next != 0)
         {
           // there's a next, so make it a merge
-          cur->next->count++;
+          AtomicIncrement (cur->next->count);
         }
     }
   return found;
@@ -224,7 +224,7 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
     {
       // cur is always a merge at this point
       // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
+      AtomicDecrement (cur->count);     // unmerge cur
       struct TagData * copy = new struct TagData ();
       copy->tid = tag.GetInstanceTypeId ();
       copy->count = 1;
@@ -233,7 +233,7 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
       copy->next = cur->next;           // merge into tail
       if (copy->next != 0)
         {
-          copy->next->count++;          // mark new merge
+          AtomicIncrement (copy->next->count);  // mark new merge
         }
       *prevNext = copy;                 // point prior list at copy
     }
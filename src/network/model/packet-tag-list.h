@@ -28,6 +28,9 @@
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+// <M>
+#include "ns3/atomic-count.h"
+// <M>
 
 namespace ns3 {
 
@@ -311,7 +314,9 @@ PacketTagList::PacketTagList (PacketTagList const &o)
 {
   if (m_next != 0)
     {
-      m_next->count++;
+      // <M>
+      AtomicIncrement (m_next->count);
+      // <M>
     }
 }
 
@@ -327,7 +332,9 @@ PacketTagList::operator = (PacketTagList const &o)
   m_next = o.m_next;
   if (m_next != 0) 
     {
-      m_next->count++;
+      // <M>
+      AtomicIncrement (m_next->count);
+      // <M>
     }
   return *this;
 }
@@ -343,8 +350,9 @@ PacketTagList::RemoveAll (void)
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
-      cur->count--;
-      if (cur->count > 0) 
+      // <M>
+      if (AtomicDecrement (cur->count) > 0)
+      // <M>
         {
           break;
         }
@@ -21,6 +21,9 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+// <M>
+#include "ns3/atomic-count.h"
+// <M>
 #include <string>
 #include <cstdarg>
 
@@ -137,10 +140,11 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    // <M>
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | (AtomicIncrement (m_globalUid) - 1), 0),
+    // <M>
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -179,10 +183,11 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    // <M>
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | (AtomicIncrement (m_globalUid) - 1), size),
+    // <M>
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -205,10 +210,11 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    // <M>
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | (AtomicIncrement (m_globalUid) - 1), size),
+    // <M>
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -23,7 +23,8 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 // <M>
-#include "ns3/list-scheduler.h"
+#include "ns3/symbolic-injection-policy.h"
+#include "ns3/pointer.h"
 #include "s2e.h"
 // <M>
 
@@ -44,6 +45,14 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    // <M>
+    .AddAttribute ("InjectionPolicy",
+                   "The policy selecting the symbolic packets, "
+                   "SymbolicInjectionPolicy::GetDefault () if null.",
+                   PointerValue (),
+                   MakePointerAccessor (&PointToPointChannel::m_injectionPolicy),
+                   MakePointerChecker<SymbolicInjectionPolicy> ())
+    // <M>
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -102,12 +111,21 @@ PointToPointChannel::TransmitStart (
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
   // <M>
-  ListScheduler::SetTransmitEvent (true);
-  //ListScheduler::SetEventType (Scheduler::NODE);
-  ListScheduler::SetPacketSize (p->GetSize ());
-  ListScheduler::SetSymLink (m_link[wire].m_src->GetNode ()->GetId (),
-                             m_link[wire].m_dst->GetNode ()->GetId ());
-  //ListScheduler::SetPacketId (p->GetUid ());
+  Ptr<SymbolicInjectionPolicy> policy = m_injectionPolicy;
+  if (policy == 0)
+    {
+      policy = SymbolicInjectionPolicy::GetDefault ();
+    }
+  if (!policy->Inject (m_link[wire].m_src->GetNode ()->GetId (),
+                       m_link[wire].m_dst->GetNode ()->GetId (),
+                       (txTime + m_delay).GetTimeStep ()))
+    {
+      // symbolically lost on the wire
+      m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+      return true;
+    }
+  EventImpl *event = MakeEvent (&PointToPointNetDevice::Receive, m_link[wire].m_dst, p);
+  event->SetTransmit (p->GetSize ());
   //char buf[64];
   //memset (buf, 0, sizeof(buf));
   //snprintf (buf, sizeof(buf), "Packet %llu, size %u, src %u, dst %u",
@@ -115,12 +133,11 @@ PointToPointChannel::TransmitStart (
     //m_link[wire].m_dst->GetNode()->GetId());
   //s2e_warning (buf);
   //memset (buf, 0, sizeof(buf));
-  // <M>
 
   Simulator::ScheduleWithContext (m_link[wire].m_src->GetNode ()->GetId (),
                                   m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p);
+                                  txTime + m_delay, event);
+  // <M>
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
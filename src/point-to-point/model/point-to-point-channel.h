@@ -25,6 +25,9 @@
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+// <M>
+#include "ns3/symbolic-injection-policy.h"
+// <M>
 
 namespace ns3 {
 
@@ -150,6 +153,9 @@ private:
   static const int N_DEVICES = 2;
 
   Time          m_delay;    //!< Propagation delay
+  // <M>
+  Ptr<SymbolicInjectionPolicy> m_injectionPolicy; //!< Symbolic packet selection
+  // <M>
   int32_t       m_nDevices; //!< Devices of this channel
 
   /**
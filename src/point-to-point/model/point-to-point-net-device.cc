@@ -30,7 +30,7 @@
 #include "ppp-header.h"
 
 // <M>
-#include "ns3/list-scheduler.h"
+#include "ns3/scheduler.h"
 // <M>
 
 namespace ns3 {
@@ -269,10 +269,9 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
   
   // <M>
-  ListScheduler::SetEventType (Scheduler::NODE);
+  Simulator::Schedule (txCompleteTime, Scheduler::NODE,
+                       MakeEvent (&PointToPointNetDevice::TransmitComplete, this));
   // <M>
-  
-  Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
 
   bool result = m_channel->TransmitStart (p, this, txTime);
   if (result == false)
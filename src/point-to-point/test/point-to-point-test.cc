@@ -23,6 +23,14 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+// <M>
+#include "ns3/channel-list.h"
+#include "ns3/node-list.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+// <M>
 
 using namespace ns3;
 
@@ -98,6 +106,246 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+// <M>
+/**
+ * \brief Test of the impact latency computed from point-to-point links
+ *
+ * It chains three nodes with links of different delays and checks the
+ * shortest delays reported by ChannelList::GetImpactLatency.
+ */
+class PointToPointImpactLatencyTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointImpactLatencyTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Connect two nodes with a point-to-point link
+   *
+   * \param a first node
+   * \param b second node
+   * \param delay propagation delay of the link
+   */
+  void Link (Ptr<Node> a, Ptr<Node> b, Time delay);
+};
+
+PointToPointImpactLatencyTest::PointToPointImpactLatencyTest ()
+  : TestCase ("PointToPoint impact latency")
+{
+}
+
+void
+PointToPointImpactLatencyTest::Link (Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (delay));
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devA->Attach (channel);
+  devB->Attach (channel);
+}
+
+void
+PointToPointImpactLatencyTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<Node> c = CreateObject<Node> ();
+  Ptr<Node> d = CreateObject<Node> ();
+
+  Link (a, b, MilliSeconds (2));
+  Link (b, c, MilliSeconds (3));
+  Link (a, c, MilliSeconds (10));
+
+  std::vector<std::vector<uint64_t> > latency = ChannelList::GetImpactLatency ();
+  NS_TEST_ASSERT_MSG_EQ (latency.size (), NodeList::GetNNodes (), "One row per node");
+  NS_TEST_EXPECT_MSG_EQ (latency[a->GetId ()][a->GetId ()], 0, "Node to itself");
+  NS_TEST_EXPECT_MSG_EQ (latency[a->GetId ()][b->GetId ()], MilliSeconds (2).GetTimeStep (), "Direct link");
+  NS_TEST_EXPECT_MSG_EQ (latency[c->GetId ()][b->GetId ()], MilliSeconds (3).GetTimeStep (), "Links are symmetric");
+  NS_TEST_EXPECT_MSG_EQ (latency[a->GetId ()][c->GetId ()], MilliSeconds (5).GetTimeStep (), "Shortest path through b");
+  NS_TEST_EXPECT_MSG_EQ (latency[d->GetId ()][a->GetId ()],
+                         Simulator::GetMaximumSimulationTime ().GetTimeStep (), "Isolated node");
+
+  // the simulator gets the matrix on demand, with the links added after
+  // the nodes
+  NS_TEST_EXPECT_MSG_EQ ((Simulator::GetTopologyImpactLatency () == latency), true,
+                         "The simulator sees the matrix of the complete topology");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test of a point-to-point chain with the multithreaded simulator
+ *
+ * Packets are relayed along a chain of four nodes. The times and sizes
+ * of the packets received by each node must be the same with the
+ * MultithreadedSimulatorImpl and with the global event list of the
+ * DefaultSimulatorImpl.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultithreadedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Build the chain and run it
+   *
+   * \param impl the simulator implementation
+   * \param threads number of node threads of the multithreaded simulator
+   * \return the times and sizes of the packets received by each node
+   */
+  std::vector<std::vector<uint64_t> > RunChain (std::string impl, uint32_t threads);
+  /**
+   * \brief Send a packet from the first device of a node
+   *
+   * \param node the sending node
+   * \param size the packet size
+   */
+  void SendPacket (Ptr<Node> node, uint32_t size);
+  /**
+   * \brief Record a packet and relay it to the other device of the node
+   *
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  /** Received packets of each node, their time followed by their size. */
+  std::vector<std::vector<uint64_t> > m_trace;
+  /** Id of the first node of the chain. */
+  uint32_t m_first;
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint chain with the multithreaded simulator"),
+    m_first (0)
+{
+}
+
+void
+PointToPointMultithreadedTest::SendPacket (Ptr<Node> node, uint32_t size)
+{
+  Ptr<NetDevice> device = node->GetDevice (0);
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                        const Address &from)
+{
+  Ptr<Node> node = device->GetNode ();
+  // each node only touches its own trace
+  m_trace[node->GetId () - m_first].push_back (Simulator::Now ().GetTimeStep ());
+  m_trace[node->GetId () - m_first].push_back (p->GetSize ());
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      if (node->GetDevice (i) != device)
+        {
+          node->GetDevice (i)->Send (p->Copy (), node->GetDevice (i)->GetBroadcast (), protocol);
+        }
+    }
+  return true;
+}
+
+std::vector<std::vector<uint64_t> >
+PointToPointMultithreadedTest::RunChain (std::string impl, uint32_t threads)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (impl));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Threads", UintegerValue (threads));
+  if (impl == "ns3::DefaultSimulatorImpl")
+    {
+      // the reference runs the events in the order of the global list
+      Simulator::SetImplementations (std::vector<bool> (10, false));
+    }
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i + 1 < nodes.size (); i++)
+    {
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2 + i)));
+      for (uint32_t j = i; j <= i + 1; j++)
+        {
+          Ptr<PointToPointNetDevice> device = CreateObject<PointToPointNetDevice> ();
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetDataRate (DataRate ("1Mbps"));
+          device->SetQueue (CreateObject<DropTailQueue> ());
+          device->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+          nodes[j]->AddDevice (device);
+          device->Attach (channel);
+          device->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+        }
+    }
+  m_trace.assign (nodes.size (), std::vector<uint64_t> ());
+  m_first = nodes[0]->GetId ();
+
+  // the end nodes send at the same times, the middle ones in between
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      for (uint32_t j = 0; j < nodes.size (); j++)
+        {
+          Time at = MilliSeconds (i) + (j == 0 || j == 3 ? Time (0) : MicroSeconds (500));
+          Simulator::ScheduleWithContext (nodes[j]->GetId (), at, &PointToPointMultithreadedTest::SendPacket,
+                                          this, nodes[j], 100 + 10 * j + i);
+        }
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Threads", UintegerValue (0));
+  return m_trace;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  std::vector<std::vector<uint64_t> > reference = RunChain ("ns3::DefaultSimulatorImpl", 1);
+  NS_TEST_ASSERT_MSG_EQ (reference.size (), 4, "One trace per node");
+  // a middle node gets the packets of the three other nodes
+  NS_TEST_EXPECT_MSG_EQ (reference[1].size (), 2 * 3 * 20, "Packets lost");
+
+#ifdef NS3_NODE_THREADS
+  uint32_t threads = 2;
+#else
+  uint32_t threads = 1;
+#endif
+  std::vector<std::vector<uint64_t> > trace = RunChain ("ns3::MultithreadedSimulatorImpl", threads);
+  NS_TEST_ASSERT_MSG_EQ (trace.size (), reference.size (), "Different nodes");
+  for (uint32_t i = 0; i < reference.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((trace[i] == reference[i]), true,
+                             "Node " << i << " got different packets with " << threads << " threads");
+    }
+}
+// <M>
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -113,6 +361,10 @@ public:
 PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
+  // <M>
+  AddTestCase (new PointToPointImpactLatencyTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
+  // <M>
   AddTestCase (new PointToPointTest, TestCase::QUICK);
 }
 
@@ -26,12 +26,14 @@
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
+// <M>
+#include "ns3/abort.h"
+#include "ns3/multithreaded-simulator-impl.h"
+// <M>
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 
-#include "ns3/list-scheduler.h"
-
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
@@ -53,6 +55,12 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("InjectionPolicy",
+                   "The policy selecting the symbolic packets, "
+                   "SymbolicInjectionPolicy::GetDefault () if null.",
+                   PointerValue (),
+                   MakePointerAccessor (&YansWifiChannel::m_injectionPolicy),
+                   MakePointerChecker<SymbolicInjectionPolicy> ())
   ;
   return tid;
 }
@@ -83,8 +91,19 @@ void
 YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
                        WifiTxVector txVector, WifiPreamble preamble, enum mpduType mpdutype, Time duration) const
 {
+  // <M>
+  // the propagation models and their random variables are shared by the
+  // nodes of the channel, which may run on different threads
+  NS_ABORT_MSG_IF (MultithreadedSimulatorImpl::IsRunningThreads (),
+                   "The Yans Wi-Fi channel is not supported by several node threads");
+  // <M>
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
+  Ptr<SymbolicInjectionPolicy> policy = m_injectionPolicy;
+  if (policy == 0)
+    {
+      policy = SymbolicInjectionPolicy::GetDefault ();
+    }
   uint32_t j = 0;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
     {
@@ -121,12 +140,15 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
           parameters.preamble = preamble;
           
           // <M>
-          ListScheduler::SetTransmitEvent (true);
-          ListScheduler::SetPacketSize (packet->GetSize ());
+          if (!policy->Inject (sender->GetDevice ()->GetNode ()->GetId (), dstNode, delay.GetTimeStep ()))
+            {
+              continue;
+            }
+          EventImpl *event = MakeEvent (&YansWifiChannel::Receive, this, j, copy, parameters);
+          event->SetTransmit (packet->GetSize ());
 
-          Simulator::ScheduleWithContext (sender->getDevice ()->GetNode ()->GetId (), dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
+          Simulator::ScheduleWithContext (sender->GetDevice ()->GetNode ()->GetId (), dstNode,
+                                          delay, event);
         }
     }
 }
@@ -30,6 +30,7 @@
 #include "wifi-tx-vector.h"
 #include "yans-wifi-phy.h"
 #include "ns3/nstime.h"
+#include "ns3/symbolic-injection-policy.h"
 
 namespace ns3 {
 
@@ -137,6 +138,7 @@ private:
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  Ptr<SymbolicInjectionPolicy> m_injectionPolicy; //!< Symbolic packet selection
 };
 
 } //namespace ns3
@@ -4,7 +4,9 @@ S2E="./build/qemu-release/i386-s2e-softmmu/qemu-system-i386"
 IMAGE="ubuntu14-32bit-ns3-5techs.raw.s2e"
 CONFIG="simple.lua"
 OPTION="-s2e-verbose -curses"
-OUTPUT="s2e-last/messages.txt"
+OUTPUT="s2e-last"
+NS3="../ns-3"
+READER="$NS3/build/utils/ns3.25-read-symbolic-trace-debug"
 
 SCRIPT="tcp"
 TECHS="all"
@@ -19,7 +21,7 @@ do
     do
       SNAPSHOT=$SCRIPT"-"$TECH"-"$PACKET"-"$INTERVAL
       time $S2E -net none $IMAGE -loadvm $SNAPSHOT -s2e-config-file $CONFIG $OPTION
-      cat $OUTPUT | grep "End of Simulation" | wc -l
+      $READER $(readlink -f $OUTPUT)
     done
   done
 done
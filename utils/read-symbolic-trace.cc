@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Aggregate the symbolic traces written by the TestCaseGenerator plugin.
+ *
+ *   read-symbolic-trace [--paths] s2e-out-0 s2e-out-1 ...
+ *
+ * Each argument is an S2E output directory, holding symbolic-trace.dat
+ * and symbolic-trace.idx, typically one per symbolic interval. For each
+ * of them, the paths are counted by outcome, the symbolic records by
+ * kind, and the solved ranges of the values of each kind are merged.
+ * With --paths, every path is printed as well.
+ */
+
+#include "ns3/symbolic-trace.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <limits>
+#include <string.h>
+
+using namespace ns3;
+
+namespace {
+
+/** Totals of one kind of record in a trace. */
+struct KindStats
+{
+  KindStats ()
+    : records (0),
+      symbolic (0),
+      lo (std::numeric_limits<uint64_t>::max ()),
+      hi (0)
+  {}
+  uint64_t records;   //!< Number of records.
+  uint64_t symbolic;  //!< Records with a symbolic expression.
+  uint64_t lo;        //!< Smallest solved value.
+  uint64_t hi;        //!< Largest solved value.
+};
+
+const char *
+KindName (uint32_t kind)
+{
+  switch (kind)
+    {
+    case SymbolicTrace::SYMBOLIC_DELAY:
+      return "symbolic delay";
+    case SymbolicTrace::SYMBOLIC_DROP:
+      return "symbolic drop";
+    case SymbolicTrace::ROUTES_UPDATED:
+      return "routes updated";
+    case SymbolicTrace::OUTCOME:
+      return "outcome";
+    }
+  return "unknown";
+}
+
+const char *
+OutcomeName (uint32_t outcome)
+{
+  switch (outcome)
+    {
+    case SymbolicTrace::UNFINISHED:
+      return "unfinished";
+    case SymbolicTrace::END_OF_SIMULATION:
+      return "end of simulation";
+    }
+  return "unknown";
+}
+
+bool
+ReadHeader (std::ifstream &is, const char *magic, const std::string &name)
+{
+  SymbolicTrace::FileHeader header;
+  if (!is.read ((char *) &header, sizeof (header))
+      || memcmp (header.magic, magic, sizeof (header.magic)) != 0)
+    {
+      std::cerr << name << ": not a symbolic trace" << std::endl;
+      return false;
+    }
+  if (header.version != SymbolicTrace::VERSION
+      || header.size != sizeof (SymbolicTrace::Record))
+    {
+      std::cerr << name << ": version " << header.version << " not supported" << std::endl;
+      return false;
+    }
+  return true;
+}
+
+/**
+ * Read the trace of an S2E output directory and print its summary.
+ * \returns \c false if the trace could not be read.
+ */
+bool
+ReadTrace (const std::string &dir, bool printPaths)
+{
+  std::string dataName = dir + "/symbolic-trace.dat";
+  std::string indexName = dir + "/symbolic-trace.idx";
+  std::ifstream data (dataName.c_str (), std::ios::binary);
+  std::ifstream index (indexName.c_str (), std::ios::binary);
+  if (!data || !index)
+    {
+      std::cerr << dir << ": no symbolic trace" << std::endl;
+      return false;
+    }
+  if (!ReadHeader (data, "NS3SYMTR", dataName) || !ReadHeader (index, "NS3SYMIX", indexName))
+    {
+      return false;
+    }
+
+  std::map<uint32_t, uint64_t> outcomes;
+  std::map<uint32_t, KindStats> kinds;
+  uint64_t paths = 0;
+  SymbolicTrace::IndexEntry entry;
+  std::vector<SymbolicTrace::Record> records;
+  std::vector<SymbolicTrace::Range> ranges;
+  while (index.read ((char *) &entry, sizeof (entry)))
+    {
+      SymbolicTrace::PathHeader path;
+      data.seekg (entry.offset);
+      if (!data.read ((char *) &path, sizeof (path)) || path.state != entry.state)
+        {
+          std::cerr << dataName << ": bad path of state " << entry.state << std::endl;
+          return false;
+        }
+      records.resize (path.records);
+      ranges.resize (path.ranges);
+      if ((path.records && !data.read ((char *) &records[0], path.records * sizeof (records[0])))
+          || (path.ranges && !data.read ((char *) &ranges[0], path.ranges * sizeof (ranges[0]))))
+        {
+          std::cerr << dataName << ": truncated path of state " << entry.state << std::endl;
+          return false;
+        }
+
+      paths++;
+      outcomes[path.outcome]++;
+      if (printPaths)
+        {
+          std::cout << "  state " << path.state << ": " << OutcomeName (path.outcome) << std::endl;
+        }
+      for (uint32_t i = 0; i < path.records; i++)
+        {
+          const SymbolicTrace::Record &r = records[i];
+          if (r.kind == SymbolicTrace::OUTCOME)
+            {
+              continue;
+            }
+          KindStats &stats = kinds[r.kind];
+          stats.records++;
+          if (r.flags & SymbolicTrace::SYMBOLIC)
+            {
+              stats.symbolic++;
+            }
+          bool solved = r.constraint < path.ranges;
+          if (solved)
+            {
+              stats.lo = std::min (stats.lo, ranges[r.constraint].lo);
+              stats.hi = std::max (stats.hi, ranges[r.constraint].hi);
+            }
+          if (printPaths)
+            {
+              std::cout << "    " << KindName (r.kind) << ", node " << r.node
+                        << ", event " << r.uid << ", value " << r.value;
+              if (solved)
+                {
+                  std::cout << ", range [" << ranges[r.constraint].lo
+                            << ", " << ranges[r.constraint].hi << "]";
+                }
+              std::cout << std::endl;
+            }
+        }
+    }
+
+  std::cout << dir << ": " << paths << " paths";
+  for (std::map<uint32_t, uint64_t>::const_iterator i = outcomes.begin (); i != outcomes.end (); i++)
+    {
+      std::cout << ", " << i->second << " " << OutcomeName (i->first);
+    }
+  std::cout << std::endl;
+  for (std::map<uint32_t, KindStats>::const_iterator i = kinds.begin (); i != kinds.end (); i++)
+    {
+      const KindStats &stats = i->second;
+      std::cout << "  " << std::left << std::setw (16) << KindName (i->first) << std::right
+                << stats.records << " records, " << stats.symbolic << " symbolic";
+      if (stats.lo <= stats.hi)
+        {
+          std::cout << ", range [" << stats.lo << ", " << stats.hi << "]";
+        }
+      std::cout << std::endl;
+    }
+  return true;
+}
+
+} // unnamed namespace
+
+int
+main (int argc, char *argv[])
+{
+  bool printPaths = false;
+  std::vector<std::string> dirs;
+  for (int i = 1; i < argc; i++)
+    {
+      if (strcmp (argv[i], "--paths") == 0)
+        {
+          printPaths = true;
+        }
+      else
+        {
+          dirs.push_back (argv[i]);
+        }
+    }
+  if (dirs.empty ())
+    {
+      std::cerr << "Usage: " << argv[0] << " [--paths] s2e-output-directory..." << std::endl;
+      return 1;
+    }
+
+  int status = 0;
+  for (std::vector<std::string>::const_iterator i = dirs.begin (); i != dirs.end (); i++)
+    {
+      if (!ReadTrace (*i, printPaths))
+        {
+          status = 1;
+        }
+    }
+  return status;
+}